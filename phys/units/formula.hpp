@@ -0,0 +1,913 @@
+/**
+ * \file formula.hpp
+ *
+ * \brief   Dimension-checked formulas, compiled once and evaluated over columns.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/**
+\class rt::phys::units::formula_compiler
+\verbatim
+
+Syntax (EBNF)
+
+     expression = term { ("+"|"-") term } .
+
+           term = unary { ("*"|"/") unary } .
+
+          unary = ["-"|"+"] factor .
+
+         factor = primary ["^" signed-integral-number] .
+
+        primary = floating-point-number
+                | "[" quantity "]"                               See note 1
+                | name                                           See note 2
+                | ("sqrt"|"abs") "(" expression ")"
+                | "(" expression ")" .
+
+           name = (letter|"_") { letter|digit|"_" } .
+
+Note 1: quantity as read by quantity_parser, e.g. [9.81 m/s2]; its magnitude
+        in SI base units is used.
+Note 2: a column, declared with formula_compiler::column().
+
+Examples
+  0.5 * m * v^2, [9.81 m/s2] * h, sqrt(x^2 + y^2), (T - [273.15 K]) / dt
+
+\endverbatim
+*/
+
+/*
+ * Compiling checks the dimensions of all operations once and determines the
+ * dimension of the result. The formula is kept as a program for a stack
+ * machine, with operations on constants folded. Evaluation runs the program
+ * per chunk of 256 rows: each instruction is one loop over the chunk, over
+ * the magnitudes of the columns, which compilers can vectorize.
+ */
+
+#ifndef PHYS_UNITS_FORMULA_HPP_INCLUDED
+#define PHYS_UNITS_FORMULA_HPP_INCLUDED
+
+#include "phys/units/io_input.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * formula compilation error.
+ */
+class formula_error : public quantity_parser_error
+{
+public:
+    formula_error( error_info const & info, std::string const text )
+    : quantity_parser_error( info, text ) {}
+
+    // correct for g++ error: looser throw specifier:
+    ~formula_error() throw() {}
+};
+
+/**
+ * formula program operation.
+ */
+struct formula_op
+{
+    enum type
+    {
+        column,                         ///< push column arg
+        constant,                       ///< push value
+        add,                            ///< replace top two by their sum
+        subtract,                       ///< replace top two by their difference
+        multiply,                       ///< replace top two by their product
+        divide,                         ///< replace top two by their quotient
+        negate,                         ///< negate top
+        power,                          ///< raise top to integral power arg
+        sqrt,                           ///< square root of top
+        abs                             ///< absolute value of top
+    };
+};
+
+/**
+ * formula program instruction.
+ */
+struct formula_instruction
+{
+    formula_op::type op;                ///< operation
+    int arg;                            ///< column index or power
+    Rep value;                          ///< constant
+};
+
+namespace detail {
+
+enum
+{
+    formula_chunk = 256                 ///< rows evaluated per instruction
+};
+
+/**
+ * message for formula error e in (stripped) formula text.
+ */
+inline std::string render_formula_error( error_info const & e, std::string const & input )
+{
+    std::string const pos = to_string( e.position );
+
+    std::string msg;
+
+    switch ( e.code )
+    {
+        case errc::parse_garbage:
+            msg = "garbage at position " + pos + ": '" + char_str_at( input, e.position ) + "'";
+            break;
+        case errc::parse_expecting_character:
+            msg = "expecting '" + to_string( e.expected ) + "' at position " + pos + ", got: '" + char_str_at( input, e.position ) + "'";
+            break;
+        case errc::parse_expecting_operand:
+            msg = "expecting number, quantity, name or '(' at position " + pos + ", got: '" + char_str_at( input, e.position ) + "'";
+            break;
+        case errc::undefined_name:
+            msg = "undefined name '" + input.substr( e.position - 1, e.extent ) + "' at position " + pos;
+            break;
+        case errc::incompatible_dimension:
+            msg = "incompatible dimension in " + std::string( e.text ) + " at position " + pos +
+                ": lhs:" + to_string( from_raw( e.lhs ) ) + ", rhs:" + to_string( from_raw( e.rhs ) );
+            break;
+        case errc::uneven_dimension:
+            msg = "square root of dimension " + to_string( from_raw( e.lhs ) ) + " at position " + pos + ": should be even multiple";
+            break;
+        case errc::exponent_out_of_range:
+            msg = "power " + input.substr( e.position - 1, e.extent ) + " of dimension " + to_string( from_raw( e.lhs ) ) + " at position " + pos + ": exponent out of range";
+            break;
+        default:
+            msg = render_error_code( e, input ) + " in quantity at position " + pos;
+            break;
+    }
+
+    return "quantity: formula '" + input + "': " + msg;
+}
+
+} // namespace detail
+
+/**
+ * compiled formula: the dimension of its result and a program that computes
+ * its magnitudes from those of the columns.
+ */
+class formula
+{
+public:
+    typedef std::vector<formula_instruction> program_type;  //< the program type.
+    typedef std::vector<dimensions> dimensions_type;        //< the column dimensions type.
+
+    /**
+     * default constructor: dimensionless zero without columns.
+     */
+    formula()
+    : m_dim( )
+    , m_columns( )
+    , m_program( 1, make_constant( 0 ) )
+    , m_depth( 1 )
+    {
+    }
+
+    /**
+     * constructor from compiled program.
+     */
+    formula( dimensions const & dim, dimensions_type const & columns, program_type const & program, int depth )
+    : m_dim( dim )
+    , m_columns( columns )
+    , m_program( program )
+    , m_depth( depth )
+    {
+    }
+
+    /**
+     * the dimension of the result.
+     */
+    dimensions const & dimension() const
+    {
+        return m_dim;
+    }
+
+    /**
+     * the dimensions of the columns, in declaration order.
+     */
+    dimensions_type const & column_dimensions() const
+    {
+        return m_columns;
+    }
+
+    /**
+     * the program.
+     */
+    program_type const & program() const
+    {
+        return m_program;
+    }
+
+    /**
+     * the deepest stack the program uses.
+     */
+    int depth() const
+    {
+        return m_depth;
+    }
+
+    /**
+     * compute rows [0, n) into result; columns holds a pointer to the
+     * magnitudes of each column, in declaration order, in SI base units.
+     */
+    void evaluate( Rep const * const * columns, std::size_t const n, Rep * result ) const
+    {
+        std::vector<Rep> buffers( m_depth * detail::formula_chunk );
+        std::vector<Rep const *> top( m_depth );
+
+        for ( std::size_t first = 0; first < n; first += detail::formula_chunk )
+        {
+            std::size_t const count = first + detail::formula_chunk < n ? std::size_t( detail::formula_chunk ) : n - first;
+
+            int sp = 0;
+
+            for ( program_type::const_iterator pos = m_program.begin(); pos != m_program.end(); ++pos )
+            {
+                switch ( pos->op )
+                {
+                    case formula_op::column:
+                        top[ sp++ ] = columns[ pos->arg ] + first;
+                        break;
+
+                    case formula_op::constant:
+                    {
+                        Rep * const out = buffer( buffers, sp );
+                        std::fill( out, out + count, pos->value );
+                        top[ sp++ ] = out;
+                        break;
+                    }
+
+                    case formula_op::add:
+                    case formula_op::subtract:
+                    case formula_op::multiply:
+                    case formula_op::divide:
+                    {
+                        Rep * const out = buffer( buffers, sp - 2 );
+                        binary( pos->op, top[ sp - 2 ], top[ sp - 1 ], out, count );
+                        top[ --sp - 1 ] = out;
+                        break;
+                    }
+
+                    default:
+                    {
+                        Rep * const out = buffer( buffers, sp - 1 );
+                        unary( pos->op, pos->arg, top[ sp - 1 ], out, count );
+                        top[ sp - 1 ] = out;
+                        break;
+                    }
+                }
+            }
+
+            std::copy( top[0], top[0] + count, result + first );
+        }
+    }
+
+    /**
+     * compute all rows of the columns, given in declaration order; throws
+     * array_size_error for a wrong number of columns or columns of different
+     * length and incompatible_dimension_error for a column of other dimension
+     * than declared.
+     */
+    quantity_array evaluate( std::vector<quantity_array> const & columns ) const
+    {
+        if ( columns.size() != m_columns.size() )
+        {
+            PHYS_UNITS_THROW( array_size_error( "quantity: formula column count differs from declared" ) );
+        }
+
+        std::size_t const n = columns.empty() ? 0 : columns[0].size();
+
+        std::vector<Rep const *> data( columns.size() );
+
+        for ( std::size_t i = 0; i < columns.size(); ++i )
+        {
+            detail::require_dimension( m_columns[i], columns[i].dimension(), "formula" );
+
+            if ( columns[i].size() != n )
+            {
+                PHYS_UNITS_THROW( array_size_error( "quantity: incompatible array sizes in formula" ) );
+            }
+
+            data[i] = columns[i].data();
+        }
+
+        quantity_array result( m_dim, n );
+
+        evaluate( data.empty() ? 0 : &data[0], n, result.data() );
+
+        return result;
+    }
+
+    /**
+     * instruction to push a constant.
+     */
+    static formula_instruction make_constant( Rep const value )
+    {
+        formula_instruction const i = { formula_op::constant, 0, value };
+        return i;
+    }
+
+private:
+    /*
+     * the buffer of stack slot i.
+     */
+    static Rep * buffer( std::vector<Rep> & buffers, int const i )
+    {
+        return &buffers[ i * detail::formula_chunk ];
+    }
+
+    /*
+     * out[i] = a[i] op b[i], for i in [0, n).
+     */
+    static void binary( formula_op::type op, Rep const * a, Rep const * b, Rep * out, std::size_t const n )
+    {
+        switch ( op )
+        {
+            case formula_op::add:      for ( std::size_t i = 0; i < n; ++i ) out[i] = a[i] + b[i]; break;
+            case formula_op::subtract: for ( std::size_t i = 0; i < n; ++i ) out[i] = a[i] - b[i]; break;
+            case formula_op::multiply: for ( std::size_t i = 0; i < n; ++i ) out[i] = a[i] * b[i]; break;
+            case formula_op::divide:   for ( std::size_t i = 0; i < n; ++i ) out[i] = a[i] / b[i]; break;
+            default: break;
+        }
+    }
+
+    /*
+     * out[i] = op( a[i] ), for i in [0, n); arg is the power.
+     */
+    static void unary( formula_op::type op, int const arg, Rep const * a, Rep * out, std::size_t const n )
+    {
+        switch ( op )
+        {
+            case formula_op::negate: for ( std::size_t i = 0; i < n; ++i ) out[i] = -a[i]; break;
+            case formula_op::power:  detail::int_power( a, out, n, arg ); break;
+            case formula_op::sqrt:   for ( std::size_t i = 0; i < n; ++i ) out[i] = std::sqrt( a[i] ); break;
+            case formula_op::abs:    for ( std::size_t i = 0; i < n; ++i ) out[i] = std::fabs( a[i] ); break;
+            default: break;
+        }
+    }
+
+    dimensions m_dim;           ///< dimension of the result
+    dimensions_type m_columns;  ///< dimension per column
+    program_type m_program;     ///< stack machine program
+    int m_depth;                ///< deepest stack of the program
+};
+
+/**
+ * compile a formula over named columns of given dimension, such as
+ * "0.5 * m * v^2", into a formula; see the syntax above.
+ */
+class formula_compiler
+{
+public:
+    /**
+     * constructor.
+     */
+    formula_compiler()
+    : m_names( )
+    , m_dims( )
+    , m_text( )
+    , m_pos( 0 )
+    , m_program( )
+    , m_depth( 0 )
+    , m_max_depth( 0 )
+    , m_error( detail::make_error( errc::ok ) )
+    {
+    }
+
+    /**
+     * declare the next column, with its name and dimension.
+     */
+    formula_compiler & column( std::string const & name, dimensions const & dim )
+    {
+        m_names.push_back( name );
+        m_dims.push_back( dim );
+        return *this;
+    }
+
+    /**
+     * compile text; throws formula_error on failure.
+     */
+    formula compile( std::string const & text )
+    {
+        m_text  = detail::strip( text );
+        m_pos   = 0;
+        m_depth = m_max_depth = 0;
+        m_program.clear();
+        m_error = detail::make_error( errc::ok );
+
+        dimensions const dim( parseExpression() );
+
+        if ( ! failed() && ! at_end() )
+        {
+            fail( errc::parse_garbage );
+        }
+
+        if ( failed() )
+        {
+            PHYS_UNITS_THROW( formula_error( m_error, m_text ) );
+        }
+
+        return formula( dim, m_dims, m_program, m_max_depth );
+    }
+
+private:
+    /*
+     * expression = term { ("+"|"-") term } .
+     */
+    dimensions parseExpression()
+    {
+        dimensions lhs( parseTerm() );
+
+        while ( ! failed() && ( '+' == current() || '-' == current() ) )
+        {
+            int const position = m_pos + 1;
+            bool const plus = '+' == current();
+
+            advance();
+
+            dimensions const rhs( parseTerm() );
+
+            if ( failed() )
+            {
+                break;
+            }
+
+            if ( lhs != rhs )
+            {
+                fail_dimension( plus ? "operator+" : "operator-", position, lhs, rhs );
+                break;
+            }
+
+            emit_binary( plus ? formula_op::add : formula_op::subtract );
+        }
+        return lhs;
+    }
+
+    /*
+     * term = unary { ("*"|"/") unary } .
+     */
+    dimensions parseTerm()
+    {
+        dimensions lhs( parseUnary() );
+
+        while ( ! failed() && ( '*' == current() || '/' == current() ) )
+        {
+            bool const times = '*' == current();
+
+            advance();
+
+            dimensions const rhs( parseUnary() );
+
+            if ( times )
+            {
+                lhs *= rhs;
+            }
+            else
+            {
+                lhs /= rhs;
+            }
+
+            emit_binary( times ? formula_op::multiply : formula_op::divide );
+        }
+        return lhs;
+    }
+
+    /*
+     * unary = ["-"|"+"] factor .
+     */
+    dimensions parseUnary()
+    {
+        if ( accept( '-' ) )
+        {
+            dimensions const dim( parseFactor() );
+            emit_unary( formula_op::negate );
+            return dim;
+        }
+
+        accept( '+' );
+
+        return parseFactor();
+    }
+
+    /*
+     * factor = primary ["^" signed-integral-number] .
+     */
+    dimensions parseFactor()
+    {
+        dimensions const dim( parsePrimary() );
+
+        if ( failed() || '^' != current() )
+        {
+            return dim;
+        }
+
+        advance();
+
+        int sign = 1;
+
+        if ( accept( '-' ) )
+        {
+            sign = -1;
+        }
+        else
+        {
+            accept( '+' );
+        }
+
+        if ( ! isdigit( current() ) )
+        {
+            fail( errc::parse_expecting_operand );
+            return dim;
+        }
+
+        int const limit = std::numeric_limits<dimensions::value_type>::max();
+        int const position = m_pos + 1;
+        int n = 0;
+
+        while ( isdigit( current() ) )
+        {
+            if ( n <= limit )
+            {
+                n = 10 * n + ( current() - '0' );
+            }
+            ++m_pos;
+        }
+
+        if ( ! in_range( dim, n, limit ) )
+        {
+            fail_at( errc::exponent_out_of_range, position, m_pos + 1 - position );
+            detail::to_raw( dim, m_error.lhs );
+            return dim;
+        }
+
+        skip_whitespace();
+
+        emit_unary( formula_op::power, sign * n );
+
+        return power( dim, sign * n );
+    }
+
+    /*
+     * true if the exponents of dim times n stay within limit.
+     */
+    static bool in_range( dimensions const & dim, int const n, int const limit )
+    {
+        if ( n > limit )
+        {
+            return false;
+        }
+
+        for ( std::size_t i = 0; i < dim.d.size(); ++i )
+        {
+            if ( std::abs( dim.d[i] * n ) > limit )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * primary = number | "[" quantity "]" | name | function "(" expression ")" | "(" expression ")" .
+     */
+    dimensions parsePrimary()
+    {
+        char const c = current();
+
+        if ( isdigit( c ) || ( '.' == c && isdigit( char_at( 1 ) ) ) )
+        {
+            char const * const first = m_text.c_str() + m_pos;
+            Rep value = 0;
+
+            char const * const last = detail::scan_number( first, m_text.c_str() + m_text.size(), value );
+
+            emit_constant( value );
+
+            m_pos += static_cast<int>( last - first );
+            skip_whitespace();
+
+            return dimensions();
+        }
+
+        if ( '[' == c )
+        {
+            return parseQuantity();
+        }
+
+        if ( isalpha( c ) || '_' == c )
+        {
+            return parseName();
+        }
+
+        if ( accept( '(' ) )
+        {
+            dimensions const dim( parseExpression() );
+            expect( ')' );
+            return dim;
+        }
+
+        fail( errc::parse_expecting_operand );
+        return dimensions();
+    }
+
+    /*
+     * "[" quantity "]", read by quantity_parser.
+     */
+    dimensions parseQuantity()
+    {
+        int const position = m_pos + 1;
+        std::string::size_type const close = m_text.find( ']', m_pos );
+
+        if ( std::string::npos == close )
+        {
+            m_pos = static_cast<int>( m_text.size() );
+            fail( errc::parse_expecting_character, 0, ']' );
+            return dimensions();
+        }
+
+        quantity_parser parser;
+        quantity_result const q( parser.try_parse( m_text.substr( m_pos + 1, close - m_pos - 1 ) ) );
+
+        if ( ! q.ok() )
+        {
+            fail_at( q.code(), position, static_cast<int>( close ) + 2 - position );
+            return dimensions();
+        }
+
+        m_pos = static_cast<int>( close ) + 1;
+        skip_whitespace();
+
+        emit_constant( q.value().value() );
+
+        return q.value().dimension();
+    }
+
+    /*
+     * name | function "(" expression ")" .
+     */
+    dimensions parseName()
+    {
+        int const first = m_pos;
+
+        while ( isalnum( current() ) || '_' == current() )
+        {
+            ++m_pos;
+        }
+
+        std::string const name( m_text, first, m_pos - first );
+
+        skip_whitespace();
+
+        if ( ( "sqrt" == name || "abs" == name ) && accept( '(' ) )
+        {
+            int const position = m_pos + 1;
+            dimensions const dim( parseExpression() );
+
+            if ( ! expect( ')' ) )
+            {
+                return dim;
+            }
+
+            if ( "abs" == name )
+            {
+                emit_unary( formula_op::abs );
+                return dim;
+            }
+
+            if ( ! dim.is_all_even_multiples( 2 ) )
+            {
+                fail_at( errc::uneven_dimension, position );
+                detail::to_raw( dim, m_error.lhs );
+                return dim;
+            }
+
+            emit_unary( formula_op::sqrt );
+            return root( dim, 2 );
+        }
+
+        for ( std::size_t i = 0; i < m_names.size(); ++i )
+        {
+            if ( m_names[i] == name )
+            {
+                formula_instruction const instruction = { formula_op::column, static_cast<int>( i ), 0 };
+                m_program.push_back( instruction );
+                push();
+                return m_dims[i];
+            }
+        }
+
+        fail_at( errc::undefined_name, first + 1, static_cast<int>( name.size() ) );
+        return dimensions();
+    }
+
+    void emit_constant( Rep const value )
+    {
+        m_program.push_back( formula::make_constant( value ) );
+        push();
+    }
+
+    /*
+     * emit a unary operation, folded if its operand is constant.
+     */
+    void emit_unary( formula_op::type op, int arg = 0 )
+    {
+        if ( failed() )
+        {
+            return;
+        }
+
+        formula_instruction & top = m_program.back();
+
+        if ( formula_op::constant == top.op )
+        {
+            switch ( op )
+            {
+                case formula_op::negate: top.value = -top.value; return;
+                case formula_op::power:  top.value = detail::int_power( top.value, arg ); return;
+                case formula_op::sqrt:   top.value = std::sqrt( top.value ); return;
+                case formula_op::abs:    top.value = std::fabs( top.value ); return;
+                default: break;
+            }
+        }
+
+        formula_instruction const instruction = { op, arg, 0 };
+        m_program.push_back( instruction );
+    }
+
+    /*
+     * emit a binary operation, folded if both operands are constant.
+     */
+    void emit_binary( formula_op::type op )
+    {
+        if ( failed() )
+        {
+            return;
+        }
+
+        std::size_t const n = m_program.size();
+
+        if ( formula_op::constant == m_program[ n - 2 ].op && formula_op::constant == m_program[ n - 1 ].op )
+        {
+            Rep & lhs = m_program[ n - 2 ].value;
+            Rep const rhs = m_program[ n - 1 ].value;
+
+            switch ( op )
+            {
+                case formula_op::add:      lhs += rhs; break;
+                case formula_op::subtract: lhs -= rhs; break;
+                case formula_op::multiply: lhs *= rhs; break;
+                case formula_op::divide:   lhs /= rhs; break;
+                default: break;
+            }
+
+            m_program.pop_back();
+        }
+        else
+        {
+            formula_instruction const instruction = { op, 0, 0 };
+            m_program.push_back( instruction );
+        }
+        --m_depth;
+    }
+
+    void push()
+    {
+        if ( ++m_depth > m_max_depth )
+        {
+            m_max_depth = m_depth;
+        }
+    }
+
+    bool at_end() const
+    {
+        return m_pos >= static_cast<int>( m_text.size() );
+    }
+
+    char char_at( int const offset ) const
+    {
+        return m_pos + offset < static_cast<int>( m_text.size() ) ? m_text[ m_pos + offset ] : '\0';
+    }
+
+    char current() const
+    {
+        return char_at( 0 );
+    }
+
+    void skip_whitespace()
+    {
+        while ( isspace( current() ) )
+        {
+            ++m_pos;
+        }
+    }
+
+    void advance()
+    {
+        ++m_pos;
+        skip_whitespace();
+    }
+
+    bool accept( char chr )
+    {
+        if ( chr != current() )
+        {
+            return false;
+        }
+        advance();
+        return true;
+    }
+
+    bool expect( char chr )
+    {
+        if ( ! accept( chr ) )
+        {
+            fail( errc::parse_expecting_character, 0, chr );
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * true if an error occurred.
+     */
+    bool failed() const
+    {
+        return errc::ok != m_error.code;
+    }
+
+    /*
+     * record the first error at the current position.
+     */
+    void fail( errc::type code, int extent = 0, char expected = '\0' )
+    {
+        fail_at( code, m_pos + 1, extent, expected );
+    }
+
+    /*
+     * record the first error at given 1-based position.
+     */
+    void fail_at( errc::type code, int position, int extent = 0, char expected = '\0' )
+    {
+        if ( ! failed() )
+        {
+            m_error = detail::make_error( code, position, extent, expected );
+            m_error.render = detail::render_formula_error;
+        }
+    }
+
+    /*
+     * record incompatible dimensions in operation text at position.
+     */
+    void fail_dimension( char const * text, int position, dimensions const & lhs, dimensions const & rhs )
+    {
+        detail::trace( trace_op::dimension_mismatch, text, lhs, rhs );
+
+        if ( ! failed() )
+        {
+            m_error = detail::make_dimension_error( text, lhs, rhs );
+            m_error.position = position;
+            m_error.render = detail::render_formula_error;
+        }
+    }
+
+private:
+    std::vector<std::string> m_names;       //< column names
+    formula::dimensions_type m_dims;        //< column dimensions
+    std::string m_text;                     //< stripped formula text
+    int m_pos;                              //< 0-based scanner position
+    formula::program_type m_program;        //< program under construction
+    int m_depth;                            //< stack depth after the program so far
+    int m_max_depth;                        //< deepest stack so far
+    error_info m_error;                     //< first error of last compile
+};
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_FORMULA_HPP_INCLUDED
+
+/*
+ * end of file
+ */
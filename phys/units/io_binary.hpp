@@ -0,0 +1,593 @@
+/**
+ * \file io_binary.hpp
+ *
+ * \brief   Compact binary encoding of quantities and quantity arrays.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Encoding, version 1:
+ *
+ *   stream     := 'P' 'U' 'Q' 'B' version record*
+ *   record     := dictionary | array | quantity
+ *   dictionary := varint(0) varint(n) zigzag-varint(exponent){n}
+ *   array      := varint(1) varint(id) varint(count) double{count}
+ *   quantity   := varint(id + 2) double
+ *
+ * A dictionary record interns a dimension: it receives the next id, starting
+ * at 0. Trailing zero exponents are omitted. Magnitudes are IEEE 754 doubles,
+ * little-endian. A quantity of a dimension seen before costs one byte plus its
+ * magnitude for the first 126 dimensions.
+ */
+
+#ifndef PHYS_UNITS_IO_BINARY_HPP_INCLUDED
+#define PHYS_UNITS_IO_BINARY_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * binary format error, for example for truncated input or invalid exponents.
+ */
+struct binary_format_error : public quantity_error
+{
+    binary_format_error( std::string const text )
+    : quantity_error( text )
+    {
+    }
+};
+
+namespace detail {
+
+/**
+ * binary encoding constants.
+ */
+struct binary_format
+{
+    enum
+    {
+        version = 1,            ///< encoding version
+        header_size = 5,        ///< magic and version
+        dictionary_tag = 0,     ///< dictionary record
+        array_tag = 1,          ///< array record
+        quantity_tag = 2        ///< first quantity record, id 0
+    };
+
+    /**
+     * magic bytes at start of stream.
+     */
+    static char const * magic()
+    {
+        return "PUQB";
+    }
+};
+
+/**
+ * true if doubles are stored little-endian on this platform.
+ */
+inline bool is_little_endian()
+{
+    double const one = 1.0;
+    unsigned char bytes[ sizeof one ];
+    std::memcpy( bytes, &one, sizeof one );
+    return 0 == bytes[0];
+}
+
+/**
+ * copy count doubles between host and little-endian byte order.
+ */
+inline void copy_le( void * dst, void const * src, std::size_t count )
+{
+    if ( is_little_endian() )
+    {
+        std::memcpy( dst, src, count * sizeof( double ) );
+        return;
+    }
+
+    unsigned char * d = static_cast<unsigned char *>( dst );
+    unsigned char const * s = static_cast<unsigned char const *>( src );
+
+    for ( std::size_t i = 0; i < count; ++i, d += sizeof( double ), s += sizeof( double ) )
+    {
+        std::reverse_copy( s, s + sizeof( double ), d );
+    }
+}
+
+/**
+ * zigzag encoding of signed value: 0, -1, 1, -2, ... as 0, 1, 2, 3, ...
+ */
+inline unsigned long zigzag( long const value )
+{
+    return value < 0 ? 2 * static_cast<unsigned long>( -( value + 1 ) ) + 1 : 2 * static_cast<unsigned long>( value );
+}
+
+/**
+ * signed value of zigzag encoded value.
+ */
+inline long unzigzag( unsigned long const value )
+{
+    return value & 1 ? -static_cast<long>( value / 2 ) - 1 : static_cast<long>( value / 2 );
+}
+
+} // namespace detail
+
+/**
+ * encode quantities and quantity arrays into a growing byte buffer.
+ */
+class binary_writer
+{
+public:
+    typedef std::vector<unsigned char> buffer_type;     //< the buffer type.
+
+    /**
+     * default constructor; writes the stream header.
+     */
+    binary_writer()
+    : m_buffer( )
+    , m_ids( )
+    , m_last_dim( )
+    , m_last_id( 0 )
+    {
+        m_buffer.insert( m_buffer.end(), detail::binary_format::magic(), detail::binary_format::magic() + 4 );
+        m_buffer.push_back( detail::binary_format::version );
+    }
+
+    /**
+     * append quantity.
+     */
+    void write( quantity const & q )
+    {
+        Rep const value = q.value();
+
+        put_varint( id( q.dimension() ) + detail::binary_format::quantity_tag );
+        put_doubles( &value, 1 );
+    }
+
+    /**
+     * append all elements of array with one dimension and a bulk copy of magnitudes.
+     */
+    void write( quantity_array const & a )
+    {
+        unsigned long const dim_id = id( a.dimension() );
+
+        put_varint( detail::binary_format::array_tag );
+        put_varint( dim_id );
+        put_varint( a.size() );
+        put_doubles( a.data(), a.size() );
+    }
+
+    /**
+     * append quantities in range [first, last).
+     */
+    template <typename InputIt>
+    void write( InputIt first, InputIt last )
+    {
+        for ( ; first != last; ++first )
+        {
+            write( *first );
+        }
+    }
+
+    /**
+     * the encoded bytes.
+     */
+    buffer_type const & buffer() const
+    {
+        return m_buffer;
+    }
+
+    /**
+     * pointer to the encoded bytes.
+     */
+    unsigned char const * data() const
+    {
+        return &m_buffer[0];
+    }
+
+    /**
+     * number of encoded bytes.
+     */
+    std::size_t size() const
+    {
+        return m_buffer.size();
+    }
+
+private:
+    typedef std::map<dimensions, unsigned long> id_map;
+
+    /**
+     * id of dimension, writing a dictionary record for a new dimension.
+     */
+    unsigned long id( dimensions const & d )
+    {
+        if ( !m_ids.empty() && m_last_dim == d )
+        {
+            return m_last_id;
+        }
+
+        id_map::iterator pos = m_ids.find( d );
+
+        if ( pos == m_ids.end() )
+        {
+            pos = m_ids.insert( std::make_pair( d, static_cast<unsigned long>( m_ids.size() ) ) ).first;
+
+            int n = static_cast<int>( d.d.size() );
+            while ( n > 0 && 0 == d.d[ n - 1 ] )
+            {
+                --n;
+            }
+
+            put_varint( detail::binary_format::dictionary_tag );
+            put_varint( n );
+
+            for ( int i = 0; i < n; ++i )
+            {
+                put_varint( detail::zigzag( d.d[i] ) );
+            }
+        }
+
+        m_last_dim = pos->first;
+        m_last_id  = pos->second;
+        return m_last_id;
+    }
+
+    /**
+     * append unsigned value in 7-bit groups, low group first.
+     */
+    void put_varint( unsigned long value )
+    {
+        while ( value >= 0x80 )
+        {
+            m_buffer.push_back( static_cast<unsigned char>( value | 0x80 ) );
+            value >>= 7;
+        }
+        m_buffer.push_back( static_cast<unsigned char>( value ) );
+    }
+
+    /**
+     * append count magnitudes, little-endian.
+     */
+    void put_doubles( Rep const * values, std::size_t const count )
+    {
+        if ( 0 == count )
+        {
+            return;
+        }
+
+        std::size_t const offset = m_buffer.size();
+        m_buffer.resize( offset + count * sizeof( double ) );
+
+        if ( sizeof( Rep ) == sizeof( double ) )
+        {
+            detail::copy_le( &m_buffer[ offset ], values, count );
+            return;
+        }
+
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            double const value = static_cast<double>( values[i] );
+            detail::copy_le( &m_buffer[ offset + i * sizeof( double ) ], &value, 1 );
+        }
+    }
+
+    buffer_type m_buffer;           ///< encoded bytes
+    id_map m_ids;                   ///< dimension ids
+    dimensions m_last_dim;          ///< last used dimension
+    unsigned long m_last_id;        ///< id of last used dimension
+};
+
+/**
+ * magnitudes of an array record, referring into the reader's buffer.
+ */
+class binary_array_view
+{
+public:
+    /**
+     * constructor.
+     */
+    binary_array_view( dimensions const & dim, unsigned char const * data, std::size_t count )
+    : m_dim( &dim )
+    , m_data( data )
+    , m_size( count )
+    {
+    }
+
+    /**
+     * the dimension of all elements.
+     */
+    dimensions const & dimension() const
+    {
+        return *m_dim;
+    }
+
+    /**
+     * number of elements.
+     */
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * magnitude of element i.
+     */
+    Rep value( std::size_t const i ) const
+    {
+        double value = 0;
+        detail::copy_le( &value, m_data + i * sizeof( double ), 1 );
+        return value;
+    }
+
+    /**
+     * element i as quantity.
+     */
+    quantity at( std::size_t const i ) const
+    {
+        return quantity( *m_dim, value( i ) );
+    }
+
+    /**
+     * copy elements to array, replacing its contents and dimension.
+     */
+    void copy_to( quantity_array & a ) const
+    {
+        quantity_array result( *m_dim, m_size );
+
+        if ( 0 == m_size )
+        {
+            // nothing to copy
+        }
+        else if ( sizeof( Rep ) == sizeof( double ) )
+        {
+            detail::copy_le( result.data(), m_data, m_size );
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < m_size; ++i )
+            {
+                result.value( i ) = value( i );
+            }
+        }
+        result.swap( a );
+    }
+
+private:
+    dimensions const * m_dim;       ///< dimension, owned by reader
+    unsigned char const * m_data;   ///< first magnitude
+    std::size_t m_size;             ///< number of elements
+};
+
+/**
+ * decode quantities and quantity arrays from a byte buffer without copying it;
+ * throws binary_format_error for malformed input.
+ */
+class binary_reader
+{
+public:
+    /**
+     * kind of record.
+     */
+    enum record_kind
+    {
+        end_of_data,        ///< no more records
+        quantity_record,    ///< single quantity
+        array_record        ///< quantity array
+    };
+
+    /**
+     * constructor; the buffer must outlive the reader and the views it returns.
+     */
+    binary_reader( unsigned char const * data, std::size_t const size )
+    : m_pos( data )
+    , m_end( data + size )
+    , m_dims( )
+    {
+        if ( size < detail::binary_format::header_size || 0 != std::memcmp( data, detail::binary_format::magic(), 4 ) )
+        {
+            fail( "missing header" );
+        }
+
+        if ( detail::binary_format::version != data[4] )
+        {
+            fail( "unsupported version" );
+        }
+
+        m_pos += detail::binary_format::header_size;
+    }
+
+    /**
+     * kind of the next record; reads dictionary records on the way.
+     */
+    record_kind peek()
+    {
+        while ( m_pos != m_end && detail::binary_format::dictionary_tag == *m_pos )
+        {
+            ++m_pos;
+            read_dictionary();
+        }
+
+        if ( m_pos == m_end )
+        {
+            return end_of_data;
+        }
+
+        return detail::binary_format::array_tag == *m_pos ? array_record : quantity_record;
+    }
+
+    /**
+     * read next quantity into q, replacing its dimension; false at end of data.
+     */
+    bool read( quantity & q )
+    {
+        record_kind const kind = peek();
+
+        if ( end_of_data == kind )
+        {
+            return false;
+        }
+
+        if ( quantity_record != kind )
+        {
+            fail( "expecting quantity" );
+        }
+
+        dimensions const & d = dimension( get_varint() - detail::binary_format::quantity_tag );
+
+        quantity( d, get_double() ).swap( q );
+        return true;
+    }
+
+    /**
+     * read next array record.
+     */
+    binary_array_view read_array()
+    {
+        if ( array_record != peek() )
+        {
+            fail( "expecting array" );
+        }
+
+        get_varint();
+
+        dimensions const & d = dimension( get_varint() );
+        unsigned long const count = get_varint();
+
+        if ( count > static_cast<std::size_t>( m_end - m_pos ) / sizeof( double ) )
+        {
+            fail( "truncated array" );
+        }
+
+        binary_array_view const view( d, m_pos, count );
+        m_pos += count * sizeof( double );
+        return view;
+    }
+
+    /**
+     * true if all data has been read.
+     */
+    bool at_end()
+    {
+        return end_of_data == peek();
+    }
+
+private:
+    /**
+     * throw binary_format_error.
+     */
+    PHYS_UNITS_NORETURN static void fail( char const * const text )
+    {
+        PHYS_UNITS_THROW( binary_format_error( std::string( "quantity: binary format: " ) + text ) );
+    }
+
+    /**
+     * read dictionary record, validating exponents against dimensions::value_type.
+     */
+    void read_dictionary()
+    {
+        dimensions d;
+
+        unsigned long const n = get_varint();
+
+        if ( n > d.d.size() )
+        {
+            fail( "too many exponents" );
+        }
+
+        for ( unsigned long i = 0; i < n; ++i )
+        {
+            long const exponent = detail::unzigzag( get_varint() );
+
+            if ( exponent < std::numeric_limits<dimensions::value_type>::min() ||
+                 exponent > std::numeric_limits<dimensions::value_type>::max() )
+            {
+                fail( "exponent out of range" );
+            }
+            d.d[i] = static_cast<dimensions::value_type>( exponent );
+        }
+
+        m_dims.push_back( d );
+    }
+
+    /**
+     * interned dimension with given id.
+     */
+    dimensions const & dimension( unsigned long const id ) const
+    {
+        if ( id >= m_dims.size() )
+        {
+            fail( "undefined dimension id" );
+        }
+        return m_dims[ id ];
+    }
+
+    /**
+     * read unsigned value in 7-bit groups, low group first.
+     */
+    unsigned long get_varint()
+    {
+        unsigned long value = 0;
+
+        for ( unsigned shift = 0; shift < 8 * sizeof value; shift += 7 )
+        {
+            if ( m_pos == m_end )
+            {
+                fail( "truncated varint" );
+            }
+
+            unsigned char const byte = *m_pos++;
+            value |= static_cast<unsigned long>( byte & 0x7f ) << shift;
+
+            if ( 0 == ( byte & 0x80 ) )
+            {
+                return value;
+            }
+        }
+        fail( "varint too long" );
+    }
+
+    /**
+     * read little-endian magnitude.
+     */
+    double get_double()
+    {
+        if ( static_cast<std::size_t>( m_end - m_pos ) < sizeof( double ) )
+        {
+            fail( "truncated magnitude" );
+        }
+
+        double value = 0;
+        detail::copy_le( &value, m_pos, 1 );
+        m_pos += sizeof( double );
+        return value;
+    }
+
+    unsigned char const * m_pos;        ///< read position
+    unsigned char const * m_end;        ///< end of data
+    std::deque<dimensions> m_dims;      ///< interned dimensions, stable references
+};
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_IO_BINARY_HPP_INCLUDED
+
+/*
+ * end of file
+ */
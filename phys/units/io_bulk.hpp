@@ -0,0 +1,343 @@
+/**
+ * \file io_bulk.hpp
+ *
+ * \brief   Parallel parsing of newline-delimited quantity texts.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * The input is split at line boundaries into chunks that are parsed on all
+ * cores when compiled with OpenMP (e.g. -fopenmp, /openmp), and sequentially
+ * otherwise. Each thread uses its own quantity_parser. Lines are counted
+ * first, so every chunk writes its magnitudes directly into the result array.
+ */
+
+#ifndef PHYS_UNITS_IO_BULK_HPP_INCLUDED
+#define PHYS_UNITS_IO_BULK_HPP_INCLUDED
+
+#include "phys/units/io_input.hpp"
+#include "phys/units/mapped_file.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * a line that could not be parsed, or of which the dimension differs from
+ * the first parsed line; line numbers start at 1.
+ */
+struct line_error
+{
+    line_error( std::size_t line_, error_info const & info_, std::string const & input_ = std::string() )
+    : line( line_ )
+    , info( info_ )
+    , input( input_ )
+    {
+    }
+
+    /**
+     * the error message, rendered now.
+     */
+    std::string message() const
+    {
+        return info.render( info, input );
+    }
+
+    std::size_t line;           ///< line number
+    error_info info;            ///< error code, position and dimensions
+    std::string input;          ///< line text for parse errors
+};
+
+namespace detail {
+
+/**
+ * a range of whole lines and the results of parsing it.
+ */
+struct bulk_chunk
+{
+    typedef std::pair<std::size_t, dimensions> line_dimension;
+
+    bulk_chunk( char const * first_, char const * last_ )
+    : first( first_ ), last( last_ ), line( 0 ), lines( 0 ), has_dim( false ), dim(), other(), errors() {}
+
+    char const * first;                 ///< start of first line
+    char const * last;                  ///< end of last line
+    std::size_t line;                   ///< index of first line in input
+    std::size_t lines;                  ///< number of lines
+    bool has_dim;                       ///< a line parsed
+    dimensions dim;                     ///< dimension of first parsed line
+    std::vector<line_dimension> other;  ///< lines with another dimension
+    std::vector<line_error> errors;     ///< lines that failed to parse
+};
+
+/// true if error a is on an earlier line than b.
+inline bool line_error_less( line_error const & a, line_error const & b )
+{
+    return a.line < b.line;
+}
+
+/**
+ * split [first, last) into at most n chunks of whole lines.
+ */
+inline std::vector<bulk_chunk> split_lines( char const * first, char const * last, std::size_t n )
+{
+    std::vector<bulk_chunk> chunks;
+    std::size_t const size = static_cast<std::size_t>( last - first );
+
+    for ( char const * start = first; start != last; )
+    {
+        std::size_t const i = chunks.size() + 1;
+        char const * end = i >= n ? last : first + size / n * i;
+
+        if ( end < start )
+        {
+            end = start;
+        }
+
+        char const * const nl = static_cast<char const *>( std::memchr( end, '\n', static_cast<std::size_t>( last - end ) ) );
+
+        end = nl ? nl + 1 : last;
+
+        chunks.push_back( bulk_chunk( start, end ) );
+        start = end;
+    }
+    return chunks;
+}
+
+/**
+ * the number of lines in [first, last); a last line needs no newline.
+ */
+inline std::size_t count_lines( char const * first, char const * last )
+{
+    std::size_t n = static_cast<std::size_t>( std::count( first, last, '\n' ) );
+
+    return first != last && '\n' != last[-1] ? n + 1 : n;
+}
+
+/**
+ * parse the lines of chunk; store magnitudes at values, NaN for errors.
+ */
+inline void parse_chunk( quantity_parser & parser, bulk_chunk & chunk, Rep * values )
+{
+    std::string text;
+    std::size_t i = 0;
+
+    for ( char const * p = chunk.first; p != chunk.last; ++i )
+    {
+        char const * const nl = static_cast<char const *>( std::memchr( p, '\n', static_cast<std::size_t>( chunk.last - p ) ) );
+        char const * end = nl ? nl : chunk.last;
+
+        if ( end != p && '\r' == end[-1] )
+        {
+            --end;
+        }
+
+        text.assign( p, end );
+
+        quantity_result const r( parser.try_parse( text ) );
+
+        if ( ! r.ok() )
+        {
+            values[i] = std::numeric_limits<Rep>::quiet_NaN();
+            chunk.errors.push_back( line_error( chunk.line + i + 1, r.error(), text ) );
+        }
+        else
+        {
+            if ( ! chunk.has_dim )
+            {
+                chunk.dim     = r.value().dimension();
+                chunk.has_dim = true;
+            }
+            else if ( chunk.dim != r.value().dimension() )
+            {
+                chunk.other.push_back( bulk_chunk::line_dimension( i, r.value().dimension() ) );
+            }
+
+            values[i] = r.value().value();
+        }
+
+        p = nl ? nl + 1 : chunk.last;
+    }
+}
+
+/**
+ * report lines of chunk with a dimension other than dim as errors.
+ */
+inline void check_chunk_dimension( bulk_chunk const & chunk, dimensions const & dim, Rep * values, std::vector<line_error> & errors )
+{
+    std::vector<line_error>::const_iterator err = chunk.errors.begin();
+    std::vector<bulk_chunk::line_dimension>::const_iterator oth = chunk.other.begin();
+
+    bool const same = chunk.dim == dim;
+
+    for ( std::size_t i = 0; i < chunk.lines; ++i )
+    {
+        if ( chunk.errors.end() != err && err->line == chunk.line + i + 1 )
+        {
+            ++err;
+            continue;
+        }
+
+        dimensions const * d = &chunk.dim;
+
+        if ( chunk.other.end() != oth && oth->first == i )
+        {
+            d = &oth->second;
+            ++oth;
+        }
+        else if ( same )
+        {
+            continue;
+        }
+
+        if ( *d != dim )
+        {
+            detail::trace( trace_op::dimension_mismatch, "parse_lines()", dim, *d );
+
+            errors.push_back( line_error( chunk.line + i + 1, make_dimension_error( "parse_lines()", dim, *d ) ) );
+
+            values[i] = std::numeric_limits<Rep>::quiet_NaN();
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * parse each line of [data, data + size) as a quantity into values, with the
+ * dimension of the first line that parses. Lines that fail to parse or have
+ * another dimension hold NaN and are reported in errors, in line order.
+ * Uses threads threads, or all when 0 (only when compiled with OpenMP).
+ * Returns the number of lines. Unit extension is not available here, as it
+ * would modify the unit table from several threads.
+ */
+inline std::size_t
+parse_lines( char const * data, std::size_t size, quantity_array & values, std::vector<line_error> & errors,
+    int threads = 0, dimensionless dimless = non_dimensionless() )
+{
+    // create the unit tables before the threads use them:
+    detail::get_umap();
+    detail::get_unit_table();
+    detail::get_unit_scanner();
+    detail::get_xmap();
+
+#ifdef _OPENMP
+    int const nthreads = threads > 0 ? threads : omp_get_max_threads();
+#else
+    int const nthreads = 1;
+    (void) threads;
+#endif
+
+    // several chunks per thread balance lines of different length:
+    std::size_t const min_chunk = 64 * 1024;
+    std::size_t const n = std::max( std::size_t( 1 ), std::min( size / min_chunk, std::size_t( 8 * nthreads ) ) );
+
+    std::vector<detail::bulk_chunk> chunks( detail::split_lines( data, data + size, n ) );
+
+    int const nchunks = static_cast<int>( chunks.size() );
+
+#ifdef _OPENMP
+# pragma omp parallel for num_threads( nthreads ) schedule( static )
+#endif
+    for ( int i = 0; i < nchunks; ++i )
+    {
+        chunks[i].lines = detail::count_lines( chunks[i].first, chunks[i].last );
+    }
+
+    std::size_t lines = 0;
+
+    for ( int i = 0; i < nchunks; ++i )
+    {
+        chunks[i].line = lines;
+        lines += chunks[i].lines;
+    }
+
+    quantity_array result( dimensionless_d, lines );
+
+#ifdef _OPENMP
+# pragma omp parallel num_threads( nthreads )
+#endif
+    {
+        quantity_parser parser;
+        parser.dimensionless( !!dimless );
+
+#ifdef _OPENMP
+# pragma omp for schedule( dynamic, 1 )
+#endif
+        for ( int i = 0; i < nchunks; ++i )
+        {
+            detail::parse_chunk( parser, chunks[i], result.data() + chunks[i].line );
+        }
+    }
+
+    errors.clear();
+
+    int ref = 0;
+
+    while ( ref < nchunks && ! chunks[ref].has_dim )
+    {
+        ++ref;
+    }
+
+    if ( ref < nchunks )
+    {
+        result.dimension() = chunks[ref].dim;
+    }
+
+    for ( int i = 0; i < nchunks; ++i )
+    {
+        errors.insert( errors.end(), chunks[i].errors.begin(), chunks[i].errors.end() );
+
+        if ( chunks[i].has_dim )
+        {
+            detail::check_chunk_dimension( chunks[i], result.dimension(), result.data() + chunks[i].line, errors );
+        }
+    }
+
+    std::stable_sort( errors.begin(), errors.end(), detail::line_error_less );
+
+    result.swap( values );
+
+    return lines;
+}
+
+/**
+ * parse each line of the file at path as a quantity; see parse_lines().
+ * The file is mapped into memory; throws file_error if it cannot be mapped.
+ */
+inline std::size_t
+parse_file( std::string const & path, quantity_array & values, std::vector<line_error> & errors,
+    int threads = 0, dimensionless dimless = non_dimensionless() )
+{
+    mapped_file const file( path );
+
+    return parse_lines( reinterpret_cast<char const *>( file.data() ), file.size(), values, errors, threads, dimless );
+}
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_IO_BULK_HPP_INCLUDED
+
+/*
+ * end of file
+ */
@@ -0,0 +1,706 @@
+/**
+ * \file io_columnar.hpp
+ *
+ * \brief   Memory-mapped columnar file format for tables of quantities.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * File layout, version 1; integers and doubles in little-endian order:
+ *
+ *   header    64 bytes: "PUQC", u32 version, u32 column count, u32 rows per block
+ *   columns   64 bytes per column: name (39 characters and null), 17 exponents
+ *   blocks    per block, per column: rows x double
+ *   footer    per block: u64 offset, u64 rows, per column: double min, double max
+ *   trailer   u64 block count, u64 footer offset, "PUQC", u32 version
+ *
+ * All offsets are multiples of 8, so the magnitudes of a mapped file can be
+ * used in place as arrays of double.
+ */
+
+#ifndef PHYS_UNITS_IO_COLUMNAR_HPP_INCLUDED
+#define PHYS_UNITS_IO_COLUMNAR_HPP_INCLUDED
+
+#include "phys/units/mapped_file.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * columnar format error, for example for a truncated file or an unknown version.
+ */
+struct columnar_format_error : public quantity_error
+{
+    columnar_format_error( std::string const text )
+    : quantity_error( text )
+    {
+    }
+};
+
+/**
+ * name and dimension of a column.
+ */
+struct column_spec
+{
+    column_spec( std::string const & name, dimensions const & dim )
+    : name( name )
+    , dimension( dim )
+    {
+    }
+
+    std::string name;           ///< column name, at most 39 characters
+    dimensions dimension;       ///< dimension of all values in the column
+};
+
+namespace detail {
+
+/**
+ * unsigned 64-bit type for file offsets.
+ */
+#if defined( PHYS_UNITS_COMPILER_IS_MSVC )
+typedef unsigned __int64 file_offset;
+#elif defined( __UINT64_TYPE__ )
+typedef __UINT64_TYPE__ file_offset;
+#else
+typedef unsigned long long file_offset;
+#endif
+
+/**
+ * columnar file constants.
+ */
+struct columnar_format
+{
+    enum
+    {
+        version = 1,            ///< format version
+        header_size = 64,       ///< file header size
+        column_size = 64,       ///< column header size
+        name_size = 40,         ///< column name field size
+        trailer_size = 24       ///< file trailer size
+    };
+
+    /**
+     * magic bytes at start and end of file.
+     */
+    static char const * magic()
+    {
+        return "PUQC";
+    }
+};
+
+/**
+ * store value as n little-endian bytes.
+ */
+template <typename T>
+inline void put_le( unsigned char * p, T value, int const n )
+{
+    for ( int i = 0; i < n; ++i, value >>= 8 )
+    {
+        p[i] = static_cast<unsigned char>( value & 0xff );
+    }
+}
+
+/**
+ * value of n little-endian bytes.
+ */
+template <typename T>
+inline T get_le( unsigned char const * p, int const n )
+{
+    T value = 0;
+    for ( int i = n - 1; i >= 0; --i )
+    {
+        value = static_cast<T>( ( value << 8 ) | p[i] );
+    }
+    return value;
+}
+
+/**
+ * true if doubles are stored little-endian on this platform.
+ */
+inline bool is_host_little_endian()
+{
+    double const one = 1.0;
+    unsigned char bytes[ sizeof one ];
+    std::memcpy( bytes, &one, sizeof one );
+    return 0 == bytes[0];
+}
+
+} // namespace detail
+
+/**
+ * write a columnar file: append rows or arrays, flushed per block of rows;
+ * close() writes the block statistics footer.
+ */
+class columnar_writer
+{
+public:
+    /**
+     * create file at path for given columns; throws file_error if it cannot be created.
+     */
+    columnar_writer( std::string const & path, std::vector<column_spec> const & columns, std::size_t const rows_per_block = 65536 )
+    : m_file( std::fopen( path.c_str(), "wb" ) )
+    , m_columns( columns )
+    , m_block_rows( rows_per_block > 0 ? rows_per_block : 1 )
+    , m_rows( 0 )
+    , m_offset( 0 )
+    , m_block( columns.size() * m_block_rows )
+    , m_layout( )
+    , m_stats( )
+    {
+        if ( 0 == m_file )
+        {
+            PHYS_UNITS_THROW( file_error( "quantity: cannot create file '" + path + "'" ) );
+        }
+
+        if ( ! detail::is_host_little_endian() )
+        {
+            std::fclose( m_file );
+            m_file = 0;
+            PHYS_UNITS_THROW( columnar_format_error( "quantity: columnar format: big-endian platform not supported" ) );
+        }
+
+        write_header();
+    }
+
+    /**
+     * close file if not closed yet.
+     */
+    ~columnar_writer()
+    {
+        finish();
+    }
+
+    /**
+     * number of columns.
+     */
+    std::size_t column_count() const
+    {
+        return m_columns.size();
+    }
+
+    /**
+     * append row of magnitudes, one per column, in the column's dimension.
+     */
+    void append_values( Rep const * const row )
+    {
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            m_block[ c * m_block_rows + m_rows ] = static_cast<double>( row[c] );
+        }
+
+        if ( ++m_rows == m_block_rows )
+        {
+            flush_block();
+        }
+    }
+
+    /**
+     * append row of quantities, one per column;
+     * throws incompatible_dimension_error if a dimension differs from its column.
+     */
+    void append( quantity const * const row )
+    {
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            detail::require_dimension( m_columns[c].dimension, row[c].dimension(), "append" );
+        }
+
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            m_block[ c * m_block_rows + m_rows ] = static_cast<double>( row[c].value() );
+        }
+
+        if ( ++m_rows == m_block_rows )
+        {
+            flush_block();
+        }
+    }
+
+    /**
+     * append arrays of equal size, one per column, with one dimension check per column;
+     * throws incompatible_dimension_error or array_size_error.
+     */
+    void append( quantity_array const * const columns )
+    {
+        std::size_t const n = m_columns.empty() ? 0 : columns[0].size();
+
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            detail::require_dimension( m_columns[c].dimension, columns[c].dimension(), "append" );
+
+            if ( columns[c].size() != n )
+            {
+                PHYS_UNITS_THROW( array_size_error( "quantity: columns of different size in append" ) );
+            }
+        }
+
+        for ( std::size_t i = 0; i < n; )
+        {
+            std::size_t const count = std::min( n - i, m_block_rows - m_rows );
+
+            for ( std::size_t c = 0; c < m_columns.size(); ++c )
+            {
+                std::copy( columns[c].data() + i, columns[c].data() + i + count, &m_block[ c * m_block_rows + m_rows ] );
+            }
+
+            i      += count;
+            m_rows += count;
+
+            if ( m_rows == m_block_rows )
+            {
+                flush_block();
+            }
+        }
+    }
+
+    /**
+     * write pending rows and footer and close file; throws file_error on write failure.
+     */
+    void close()
+    {
+        if ( ! finish() )
+        {
+            PHYS_UNITS_THROW( file_error( "quantity: cannot write columnar file" ) );
+        }
+    }
+
+private:
+    // non-copyable:
+    columnar_writer( columnar_writer const & );
+    columnar_writer & operator=( columnar_writer const & );
+
+    typedef detail::file_offset offset_type;
+
+    /**
+     * write bytes, tracking the file offset.
+     */
+    void write( void const * data, std::size_t const size )
+    {
+        if ( m_file && size != std::fwrite( data, 1, size, m_file ) )
+        {
+            std::fclose( m_file );
+            m_file = 0;
+        }
+        m_offset += size;
+    }
+
+    /**
+     * write file header and column headers.
+     */
+    void write_header()
+    {
+        unsigned char header[ detail::columnar_format::header_size ] = { 0 };
+
+        std::memcpy( header, detail::columnar_format::magic(), 4 );
+        detail::put_le( header +  4, unsigned( detail::columnar_format::version ), 4 );
+        detail::put_le( header +  8, static_cast<unsigned long>( m_columns.size() ), 4 );
+        detail::put_le( header + 12, static_cast<unsigned long>( m_block_rows ), 4 );
+
+        write( header, sizeof header );
+
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            unsigned char column[ detail::columnar_format::column_size ] = { 0 };
+
+            std::string const & name = m_columns[c].name;
+            std::memcpy( column, name.data(), std::min( name.size(), std::size_t( detail::columnar_format::name_size - 1 ) ) );
+            detail::to_raw( m_columns[c].dimension, reinterpret_cast<dimensions::value_type *>( column + detail::columnar_format::name_size ) );
+
+            write( column, sizeof column );
+        }
+    }
+
+    /**
+     * write pending rows as a block and record its statistics.
+     */
+    void flush_block()
+    {
+        if ( 0 == m_rows )
+        {
+            return;
+        }
+
+        m_layout.push_back( m_offset );
+        m_layout.push_back( m_rows );
+
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            double const * const first = &m_block[ c * m_block_rows ];
+
+            double lo =  std::numeric_limits<double>::infinity();
+            double hi = -std::numeric_limits<double>::infinity();
+
+            for ( double const * p = first; p != first + m_rows; ++p )
+            {
+                if ( *p < lo ) lo = *p;
+                if ( *p > hi ) hi = *p;
+            }
+
+            m_stats.push_back( lo );
+            m_stats.push_back( hi );
+
+            write( first, m_rows * sizeof( double ) );
+        }
+
+        m_rows = 0;
+    }
+
+    /**
+     * write pending rows, footer and trailer and close file; false on failure.
+     */
+    bool finish()
+    {
+        if ( 0 == m_file )
+        {
+            return false;
+        }
+
+        flush_block();
+
+        offset_type const footer_offset = m_offset;
+        std::size_t const blocks = m_layout.size() / 2;
+        std::size_t const stats = 2 * m_columns.size();
+
+        for ( std::size_t b = 0; b < blocks; ++b )
+        {
+            unsigned char field[16];
+
+            detail::put_le( field + 0, m_layout[ 2 * b     ], 8 );
+            detail::put_le( field + 8, m_layout[ 2 * b + 1 ], 8 );
+
+            write( field, sizeof field );
+
+            if ( stats > 0 )
+            {
+                write( &m_stats[ b * stats ], stats * sizeof( double ) );
+            }
+        }
+
+        unsigned char trailer[ detail::columnar_format::trailer_size ] = { 0 };
+
+        detail::put_le( trailer +  0, static_cast<offset_type>( blocks ), 8 );
+        detail::put_le( trailer +  8, footer_offset, 8 );
+        std::memcpy( trailer + 16, detail::columnar_format::magic(), 4 );
+        detail::put_le( trailer + 20, unsigned( detail::columnar_format::version ), 4 );
+
+        write( trailer, sizeof trailer );
+
+        bool const ok = 0 != m_file && 0 == std::fclose( m_file );
+        m_file = 0;
+        return ok;
+    }
+
+    std::FILE * m_file;                     ///< output file, 0 when closed
+    std::vector<column_spec> m_columns;     ///< column names and dimensions
+    std::size_t m_block_rows;               ///< rows per block
+    std::size_t m_rows;                     ///< rows in pending block
+    offset_type m_offset;                   ///< file offset
+    std::vector<double> m_block;            ///< pending block, column by column
+    std::vector<offset_type> m_layout;      ///< per block: offset, rows
+    std::vector<double> m_stats;            ///< per block, per column: min, max
+};
+
+/**
+ * magnitudes of one column in one block, in place in the mapped file.
+ */
+class column_view
+{
+public:
+    typedef double const * const_iterator;  //< magnitude iterator.
+
+    column_view( dimensions const & dim, double const * data, std::size_t const size )
+    : m_dim( &dim )
+    , m_data( data )
+    , m_size( size )
+    {
+    }
+
+    dimensions const & dimension() const { return *m_dim; }     ///< dimension of all elements.
+    std::size_t size() const { return m_size; }                 ///< number of elements.
+    double const * data() const { return m_data; }              ///< the magnitudes.
+
+    const_iterator begin() const { return m_data; }             ///< begin of magnitudes.
+    const_iterator end()   const { return m_data + m_size; }    ///< end of magnitudes.
+
+    /**
+     * magnitude of element i.
+     */
+    Rep value( std::size_t const i ) const
+    {
+        return m_data[i];
+    }
+
+    /**
+     * element i as quantity.
+     */
+    quantity at( std::size_t const i ) const
+    {
+        return quantity( *m_dim, m_data[i] );
+    }
+
+    /**
+     * copy elements to array, replacing its contents and dimension.
+     */
+    void copy_to( quantity_array & a ) const
+    {
+        quantity_array( *m_dim, m_data, m_data + m_size ).swap( a );
+    }
+
+private:
+    dimensions const * m_dim;       ///< dimension, owned by reader
+    double const * m_data;          ///< first magnitude
+    std::size_t m_size;             ///< number of elements
+};
+
+/**
+ * read a memory-mapped columnar file without copying or parsing values;
+ * throws columnar_format_error for malformed files.
+ */
+class columnar_reader
+{
+public:
+    /**
+     * map file at path and read its header and footer.
+     */
+    explicit columnar_reader( std::string const & path )
+    : m_file( path )
+    , m_names( )
+    , m_dims( )
+    , m_block_rows( 0 )
+    , m_blocks( 0 )
+    , m_footer( 0 )
+    {
+        read_layout();
+    }
+
+    std::size_t column_count() const { return m_dims.size(); }      ///< number of columns.
+    std::size_t block_count() const { return m_blocks; }            ///< number of blocks.
+    std::size_t rows_per_block() const { return m_block_rows; }     ///< rows per full block.
+
+    std::string const & column_name( std::size_t const c ) const { return m_names.at( c ); }        ///< name of column c.
+    dimensions const & column_dimension( std::size_t const c ) const { return m_dims.at( c ); }     ///< dimension of column c.
+
+    /**
+     * index of column with given name; column_count() if not found.
+     */
+    std::size_t column_index( std::string const & name ) const
+    {
+        return std::find( m_names.begin(), m_names.end(), name ) - m_names.begin();
+    }
+
+    /**
+     * number of rows in block b.
+     */
+    std::size_t block_rows( std::size_t const b ) const
+    {
+        return static_cast<std::size_t>( footer_field( b, 1 ) );
+    }
+
+    /**
+     * total number of rows.
+     */
+    std::size_t row_count() const
+    {
+        std::size_t rows = 0;
+        for ( std::size_t b = 0; b < m_blocks; ++b )
+        {
+            rows += block_rows( b );
+        }
+        return rows;
+    }
+
+    /**
+     * smallest magnitude of column c in block b.
+     */
+    double block_min( std::size_t const b, std::size_t const c ) const
+    {
+        return footer_double( b, 2 + 2 * c );
+    }
+
+    /**
+     * largest magnitude of column c in block b.
+     */
+    double block_max( std::size_t const b, std::size_t const c ) const
+    {
+        return footer_double( b, 3 + 2 * c );
+    }
+
+    /**
+     * true if block b may contain values of column c in [lo, hi]; false if it can be skipped.
+     */
+    bool block_may_contain( std::size_t const b, std::size_t const c, double const lo, double const hi ) const
+    {
+        return lo <= block_max( b, c ) && block_min( b, c ) <= hi;
+    }
+
+    /**
+     * magnitudes of column c in block b, in place.
+     */
+    column_view column( std::size_t const b, std::size_t const c ) const
+    {
+        std::size_t const rows = block_rows( b );
+        std::size_t const offset = static_cast<std::size_t>( footer_field( b, 0 ) ) + c * rows * sizeof( double );
+
+        return column_view( m_dims.at( c ), reinterpret_cast<double const *>( m_file.data() + offset ), rows );
+    }
+
+    /**
+     * all magnitudes of column c, copied into an array.
+     */
+    quantity_array read_column( std::size_t const c ) const
+    {
+        quantity_array a( m_dims.at( c ) );
+        a.reserve( row_count() );
+
+        for ( std::size_t b = 0; b < m_blocks; ++b )
+        {
+            column_view const view( column( b, c ) );
+
+            for ( column_view::const_iterator pos = view.begin(); pos != view.end(); ++pos )
+            {
+                a.push_back_value( *pos );
+            }
+        }
+        return a;
+    }
+
+private:
+    // non-copyable:
+    columnar_reader( columnar_reader const & );
+    columnar_reader & operator=( columnar_reader const & );
+
+    typedef detail::file_offset offset_type;
+
+    /**
+     * throw columnar_format_error.
+     */
+    PHYS_UNITS_NORETURN static void fail( char const * const text )
+    {
+        PHYS_UNITS_THROW( columnar_format_error( std::string( "quantity: columnar format: " ) + text ) );
+    }
+
+    /**
+     * validate header, column headers, trailer and footer.
+     */
+    void read_layout()
+    {
+        typedef detail::columnar_format format;
+
+        unsigned char const * const data = m_file.data();
+        std::size_t const size = m_file.size();
+
+        if ( ! detail::is_host_little_endian() )
+        {
+            fail( "big-endian platform not supported" );
+        }
+
+        if ( size < format::header_size + format::trailer_size || 0 != std::memcmp( data, format::magic(), 4 ) )
+        {
+            fail( "missing header" );
+        }
+
+        if ( format::version != detail::get_le<unsigned>( data + 4, 4 ) )
+        {
+            fail( "unsupported version" );
+        }
+
+        std::size_t const columns = detail::get_le<std::size_t>( data + 8, 4 );
+        m_block_rows = detail::get_le<std::size_t>( data + 12, 4 );
+
+        if ( columns > ( size - format::header_size ) / format::column_size )
+        {
+            fail( "truncated column headers" );
+        }
+
+        for ( std::size_t c = 0; c < columns; ++c )
+        {
+            unsigned char const * const column = data + format::header_size + c * format::column_size;
+            char const * const name = reinterpret_cast<char const *>( column );
+
+            m_names.push_back( std::string( name, std::find( name, name + format::name_size, '\0' ) ) );
+            m_dims.push_back( detail::from_raw( reinterpret_cast<dimensions::value_type const *>( column + format::name_size ) ) );
+        }
+
+        unsigned char const * const trailer = data + size - format::trailer_size;
+
+        if ( 0 != std::memcmp( trailer + 16, format::magic(), 4 ) )
+        {
+            fail( "missing trailer" );
+        }
+
+        offset_type const blocks = detail::get_le<offset_type>( trailer, 8 );
+        offset_type const footer = detail::get_le<offset_type>( trailer + 8, 8 );
+
+        if ( footer % 8 || footer > size - format::trailer_size ||
+             blocks != ( size - format::trailer_size - footer ) / ( ( 2 + 2 * columns ) * 8 ) ||
+             ( size - format::trailer_size - footer ) % ( ( 2 + 2 * columns ) * 8 ) )
+        {
+            fail( "invalid footer" );
+        }
+
+        m_blocks = static_cast<std::size_t>( blocks );
+
+        m_footer = data + footer;
+
+        for ( std::size_t b = 0; b < m_blocks; ++b )
+        {
+            offset_type const offset = footer_field( b, 0 );
+            offset_type const rows   = footer_field( b, 1 );
+
+            if ( offset % 8 || rows > m_block_rows || offset > footer || rows * columns * 8 > footer - offset )
+            {
+                fail( "invalid block" );
+            }
+        }
+    }
+
+    /**
+     * integer field i of footer entry of block b.
+     */
+    offset_type footer_field( std::size_t const b, std::size_t const i ) const
+    {
+        return detail::get_le<offset_type>( m_footer + ( b * ( 2 + 2 * m_dims.size() ) + i ) * 8, 8 );
+    }
+
+    /**
+     * double field i of footer entry of block b.
+     */
+    double footer_double( std::size_t const b, std::size_t const i ) const
+    {
+        double value = 0;
+        std::memcpy( &value, m_footer + ( b * ( 2 + 2 * m_dims.size() ) + i ) * 8, 8 );
+        return value;
+    }
+
+    mapped_file m_file;                     ///< the mapped file
+    std::vector<std::string> m_names;       ///< column names
+    std::vector<dimensions> m_dims;         ///< column dimensions
+    std::size_t m_block_rows;               ///< rows per full block
+    std::size_t m_blocks;                   ///< number of blocks
+    unsigned char const * m_footer;         ///< first footer entry
+};
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_IO_COLUMNAR_HPP_INCLUDED
+
+/*
+ * end of file
+ */
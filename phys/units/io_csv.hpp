@@ -0,0 +1,557 @@
+/**
+ * \file io_csv.hpp
+ *
+ * \brief   Streaming unit-aware CSV reader.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Input, for example:
+ *
+ *   time [s], speed [km/h], height
+ *   0,        12.5,         3 m
+ *   1.5,      3.5 m/s,      310 cm
+ *   3,        ,             3.2 m
+ *
+ * A header field is a name, optionally followed by a unit in brackets. A cell
+ * is a number, optionally followed by a unit. A bare number is in the unit of
+ * the column; a number with a unit must match the dimension of the column. A
+ * column without a unit in its header takes its dimension from its first cell.
+ * Empty cells are read as NaN. Fields may be double-quoted, with "" for ".
+ */
+
+#ifndef PHYS_UNITS_IO_CSV_HPP_INCLUDED
+#define PHYS_UNITS_IO_CSV_HPP_INCLUDED
+
+#include "phys/units/io_input.hpp"
+#include "phys/units/mapped_file.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * CSV error, for example for a row with a wrong number of fields.
+ */
+struct csv_error : public quantity_error
+{
+    csv_error( std::string const text )
+    : quantity_error( text )
+    {
+    }
+};
+
+/**
+ * read a CSV table with units into quantity arrays with magnitudes in SI base
+ * units. Reads from a stream in chunks, or from memory such as a mapped file;
+ * read() delivers a bounded number of rows at a time.
+ */
+class csv_reader
+{
+public:
+    /**
+     * the representation type.
+     */
+    typedef quantity::value_type value_type;
+
+    /**
+     * read from stream in chunks of chunk_size bytes; reads the header.
+     */
+    explicit csv_reader( std::istream & is, char separator = ',', std::size_t chunk_size = 65536 )
+    : m_stream( &is )
+    , m_buffer( chunk_size > 0 ? chunk_size : 1 )
+    , m_pos( 0 )
+    , m_end( 0 )
+    , m_separator( separator )
+    , m_line( 0 )
+    {
+        read_header();
+    }
+
+    /**
+     * read from memory; reads the header.
+     */
+    csv_reader( char const * data, std::size_t size, char separator = ',' )
+    : m_stream( 0 )
+    , m_buffer( )
+    , m_pos( data )
+    , m_end( data + size )
+    , m_separator( separator )
+    , m_line( 0 )
+    {
+        read_header();
+    }
+
+    /**
+     * read from mapped file; the file must outlive the reader. Reads the header.
+     */
+    explicit csv_reader( mapped_file const & file, char separator = ',' )
+    : m_stream( 0 )
+    , m_buffer( )
+    , m_pos( reinterpret_cast<char const *>( file.data() ) )
+    , m_end( m_pos + file.size() )
+    , m_separator( separator )
+    , m_line( 0 )
+    {
+        read_header();
+    }
+
+    /**
+     * the number of columns.
+     */
+    std::size_t column_count() const
+    {
+        return m_columns.size();
+    }
+
+    /**
+     * the name of column c.
+     */
+    std::string const & column_name( std::size_t c ) const
+    {
+        return m_columns.at( c ).name;
+    }
+
+    /**
+     * the unit text of column c, empty if the header gives none.
+     */
+    std::string const & column_unit( std::size_t c ) const
+    {
+        return m_columns.at( c ).unit_text;
+    }
+
+    /**
+     * the dimension of column c; dimensionless until known.
+     */
+    dimensions const & column_dimension( std::size_t c ) const
+    {
+        return m_columns.at( c ).dim;
+    }
+
+    /**
+     * the index of the column with given name; throws csv_error if absent.
+     */
+    std::size_t column_index( std::string const & name ) const
+    {
+        for ( std::size_t c = 0; c < m_columns.size(); ++c )
+        {
+            if ( name == m_columns[c].name )
+            {
+                return c;
+            }
+        }
+        PHYS_UNITS_THROW( csv_error( "quantity: csv: no column '" + name + "'" ) );
+    }
+
+    /**
+     * the number of lines read, including the header.
+     */
+    std::size_t line() const
+    {
+        return m_line;
+    }
+
+    /**
+     * the units parsed so far.
+     */
+    unit_cache const & units() const
+    {
+        return m_units;
+    }
+
+    /**
+     * read up to max_rows rows into one array per column; false if there
+     * were no more rows. Throws csv_error or quantity_parser_error for
+     * invalid input.
+     */
+    bool read( std::vector<quantity_array> & columns, std::size_t max_rows = 65536 )
+    {
+        std::size_t const n = m_columns.size();
+
+        columns.resize( n );
+
+        for ( std::size_t c = 0; c < n; ++c )
+        {
+            columns[c].clear();
+            columns[c].reserve( max_rows < 4096 ? max_rows : 4096 );
+        }
+
+        std::size_t rows = 0;
+        char const * first;
+        char const * last;
+
+        while ( rows < max_rows && next_line( first, last ) )
+        {
+            if ( is_blank( first, last ) )
+            {
+                continue;
+            }
+
+            std::size_t c = 0;
+
+            for ( ; ; ++c )
+            {
+                char const * field_first;
+                char const * field_last;
+
+                first = next_field( first, last, field_first, field_last );
+
+                if ( c < n )
+                {
+                    columns[c].push_back_value( cell_value( m_columns[c], field_first, field_last ) );
+                }
+
+                if ( first == last )
+                {
+                    break;
+                }
+                ++first;
+            }
+
+            if ( c + 1 != n )
+            {
+                PHYS_UNITS_THROW( csv_error( error_text( "expected ", n, " fields" ) ) );
+            }
+
+            ++rows;
+        }
+
+        for ( std::size_t c = 0; c < n; ++c )
+        {
+            columns[c].dimension() = m_columns[c].dim;
+        }
+
+        return rows > 0;
+    }
+
+    /**
+     * read all remaining rows.
+     */
+    std::vector<quantity_array> read_all()
+    {
+        std::vector<quantity_array> result;
+        std::vector<quantity_array> chunk;
+
+        read( result, 0 );
+
+        while ( read( chunk ) )
+        {
+            for ( std::size_t c = 0; c < chunk.size(); ++c )
+            {
+                quantity_array & a = result[c];
+                a.dimension() = chunk[c].dimension();
+
+                for ( std::size_t i = 0; i < chunk[c].size(); ++i )
+                {
+                    a.push_back_value( chunk[c].value( i ) );
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    /*
+     * per column: name, header unit and the last unit seen in a cell.
+     */
+    struct column_state
+    {
+        column_state()
+        : name(), unit_text(), dim(), scale( 1 ), has_dim( false ), last_text(), last_scale( 1 ) {}
+
+        std::string name;       ///< column name
+        std::string unit_text;  ///< unit text in header
+        dimensions dim;         ///< column dimension
+        value_type scale;       ///< factor from header unit to SI base units
+        bool has_dim;           ///< dimension known
+        std::string last_text;  ///< unit text of last cell with a unit
+        value_type last_scale;  ///< factor for last_text
+    };
+
+    // non-copyable:
+    csv_reader( csv_reader const & );
+    csv_reader & operator=( csv_reader const & );
+
+    /*
+     * read header line into column names and units.
+     */
+    void read_header()
+    {
+        char const * first;
+        char const * last;
+
+        do
+        {
+            if ( ! next_line( first, last ) )
+            {
+                PHYS_UNITS_THROW( csv_error( "quantity: csv: missing header" ) );
+            }
+        }
+        while ( is_blank( first, last ) );
+
+        for ( ; ; ++first )
+        {
+            char const * field_first;
+            char const * field_last;
+
+            first = next_field( first, last, field_first, field_last );
+
+            m_columns.push_back( column_state() );
+            column_state & col = m_columns.back();
+
+            char const * const open  = std::find( field_first, field_last, '[' );
+            char const * const close = std::find( open, field_last, ']' );
+
+            col.name.assign( field_first, detail::skip_blanks_rear( field_first, open ) );
+
+            if ( close != field_last )
+            {
+                char const * const unit_first = detail::skip_blanks( open + 1, close );
+                char const * const unit_last  = detail::skip_blanks_rear( unit_first, close );
+
+                if ( unit_first != unit_last )
+                {
+                    quantity const & u = m_units.unit( unit_first, unit_last );
+
+                    col.unit_text.assign( unit_first, unit_last );
+                    col.dim     = u.dimension();
+                    col.scale   = u.value();
+                    col.has_dim = true;
+                }
+            }
+
+            if ( first == last )
+            {
+                break;
+            }
+        }
+    }
+
+    /*
+     * magnitude in SI base units for the cell text in [first, last).
+     */
+    value_type cell_value( column_state & col, char const * first, char const * last )
+    {
+        if ( first == last )
+        {
+            return std::numeric_limits<value_type>::quiet_NaN();
+        }
+
+        value_type value = 1;
+        char const * const p = detail::skip_blanks( detail::scan_number( first, last, value ), last );
+
+        if ( p == last )
+        {
+            if ( ! col.has_dim )
+            {
+                col.dim     = dimensionless_d;
+                col.has_dim = true;
+            }
+            else if ( ! col.unit_text.empty() )
+            {
+                return value * col.scale;
+            }
+            else if ( dimensionless_d != col.dim )
+            {
+                PHYS_UNITS_THROW( csv_error( error_text( "number without unit in column '", col.name, "'" ) ) );
+            }
+            return value;
+        }
+
+        std::size_t const len = static_cast<std::size_t>( last - p );
+
+        if ( len != col.last_text.size() || 0 != std::memcmp( p, col.last_text.data(), len ) )
+        {
+            quantity const & u = m_units.unit( p, last );
+
+            if ( ! col.has_dim )
+            {
+                col.dim     = u.dimension();
+                col.has_dim = true;
+            }
+            else if ( u.dimension() != col.dim )
+            {
+                PHYS_UNITS_THROW( csv_error( error_text( "unit '" + std::string( p, last ) + "' incompatible with column '", col.name, "'" ) ) );
+            }
+
+            col.last_text.assign( p, last );
+            col.last_scale = u.value();
+        }
+
+        return value * col.last_scale;
+    }
+
+    /*
+     * split off the field at first; return the end of the field, which is
+     * last or the separator. [field_first, field_last) is the stripped text.
+     */
+    char const * next_field( char const * first, char const * last, char const * & field_first, char const * & field_last )
+    {
+        first = detail::skip_blanks( first, last );
+
+        if ( first == last || '"' != *first )
+        {
+            char const * end = static_cast<char const *>( std::memchr( first, m_separator, static_cast<std::size_t>( last - first ) ) );
+
+            if ( 0 == end )
+            {
+                end = last;
+            }
+
+            field_first = first;
+            field_last  = detail::skip_blanks_rear( first, end );
+
+            return end;
+        }
+
+        m_field.clear();
+
+        for ( ++first; first != last; ++first )
+        {
+            if ( '"' == *first )
+            {
+                if ( first + 1 == last || '"' != first[1] )
+                {
+                    ++first;
+                    break;
+                }
+                ++first;
+            }
+            m_field += *first;
+        }
+
+        char const * end = static_cast<char const *>( std::memchr( first, m_separator, static_cast<std::size_t>( last - first ) ) );
+
+        if ( 0 == end )
+        {
+            end = last;
+        }
+
+        field_first = detail::skip_blanks( m_field.data(), m_field.data() + m_field.size() );
+        field_last  = detail::skip_blanks_rear( field_first, m_field.data() + m_field.size() );
+
+        return end;
+    }
+
+    /*
+     * the next line without its line end; false at end of input.
+     */
+    bool next_line( char const * & first, char const * & last )
+    {
+        for ( ; ; )
+        {
+            char const * const nl = m_pos == m_end ? 0 :
+                static_cast<char const *>( std::memchr( m_pos, '\n', static_cast<std::size_t>( m_end - m_pos ) ) );
+
+            if ( 0 != nl )
+            {
+                first = m_pos;
+                last  = nl;
+                m_pos = nl + 1;
+                ++m_line;
+                return true;
+            }
+
+            if ( ! fill() )
+            {
+                if ( m_pos == m_end )
+                {
+                    return false;
+                }
+
+                first = m_pos;
+                last  = m_end;
+                m_pos = m_end;
+                ++m_line;
+                return true;
+            }
+        }
+    }
+
+    /*
+     * keep the unread part of the buffer and append the next chunk from the
+     * stream; the buffer grows only for a line longer than the buffer.
+     */
+    bool fill()
+    {
+        if ( 0 == m_stream || ! *m_stream )
+        {
+            return false;
+        }
+
+        std::size_t const rest = static_cast<std::size_t>( m_end - m_pos );
+
+        if ( rest > 0 && m_pos != &m_buffer[0] )
+        {
+            std::memmove( &m_buffer[0], m_pos, rest );
+        }
+
+        if ( rest == m_buffer.size() )
+        {
+            m_buffer.resize( 2 * m_buffer.size() );
+        }
+
+        m_stream->read( &m_buffer[0] + rest, static_cast<std::streamsize>( m_buffer.size() - rest ) );
+
+        std::size_t const got = static_cast<std::size_t>( m_stream->gcount() );
+
+        m_pos = &m_buffer[0];
+        m_end = m_pos + rest + got;
+
+        return got > 0;
+    }
+
+    /*
+     * true if line contains only blanks.
+     */
+    static bool is_blank( char const * first, char const * last )
+    {
+        return detail::skip_blanks( first, last ) == detail::skip_blanks_rear( first, last );
+    }
+
+    /*
+     * error message with line number.
+     */
+    template <typename T>
+    std::string error_text( std::string const & pre, T const & x, std::string const & post ) const
+    {
+        std::ostringstream os;
+        os << "quantity: csv line " << m_line << ": " << pre << x << post;
+        return os.str();
+    }
+
+    std::istream * m_stream;                ///< input stream, 0 for memory
+    std::vector<char> m_buffer;             ///< stream chunk buffer
+    char const * m_pos;                     ///< start of unread input
+    char const * m_end;                     ///< end of available input
+    char m_separator;                       ///< field separator
+    std::size_t m_line;                     ///< lines read
+    std::vector<column_state> m_columns;    ///< per column state
+    unit_cache m_units;                     ///< parsed units
+    std::string m_field;                    ///< unquoted field text
+};
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_IO_CSV_HPP_INCLUDED
+
+/*
+ * end of file
+ */
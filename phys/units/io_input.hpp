@@ -63,7 +63,11 @@ For more information on SI units, see:
 #include "phys/units/quantity.hpp"
 #include "phys/units/io_output.hpp"
 
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <map>
 
 namespace rt { namespace phys { namespace units {
 
@@ -78,6 +82,14 @@ public:
     , text( text )
     , position( position ) {}
 
+    /**
+     * constructor for lazily rendered message from error information and input text.
+     */
+    quantity_parser_error( error_info const & info, std::string const text )
+    : quantity_error( info, text )
+    , text( text )
+    , position( info.position ) {}
+
     // corect for  g++ error: looser throw specifier:
     ~quantity_parser_error() throw() {}
 
@@ -116,6 +128,63 @@ inline std::string to_string( int const x )
     return to_string( static_cast<long>(x) );
 }
 
+/// character at 1-based position in text, or end_char beyond text.
+inline char char_at( std::string const & text, int const position, char const end_char = '#' )
+{
+    return 0 < position && position <= static_cast<int>( text.size() ) ? text[ position - 1 ] : end_char;
+}
+
+/// character at 1-based position in text as string, "[nothing]" beyond text.
+inline std::string char_str_at( std::string const & text, int const position )
+{
+    return 0 < position && position <= static_cast<int>( text.size() ) ? to_string( text[ position - 1 ] ) : "[nothing]";
+}
+
+/**
+ * message for parse error e in (stripped) input text.
+ */
+inline std::string render_parse_error( error_info const & e, std::string const & input )
+{
+    std::string const pos  = to_string( e.position );
+    std::string const name = input.substr( std::max( 0, e.position - 1 - e.extent ), e.extent );
+
+    std::string msg;
+
+    switch ( e.code )
+    {
+        case errc::parse_garbage:
+            msg = "garbage at position " + pos + ": '" + to_string( char_at( input, e.position ) ) + "'";
+            break;
+        case errc::parse_consecutive_operators:
+            msg = "consecutive operators at position " + pos + ": '" +
+                to_string( char_at( input, e.position ) ) + "' and '" + to_string( char_at( input, e.position + 1 ) ) + "'";
+            break;
+        case errc::parse_repeated_solidus:
+            msg = "repetition of solidus at position " + pos + ": use parenthesis to avoid ambiguity";
+            break;
+        case errc::parse_expecting_reciprocal:
+            msg = "expecting 1/u construct at position " + pos + ", got: '1" + char_str_at( input, e.position + 1 ) + "'";
+            break;
+        case errc::parse_expecting_unit:
+            msg = "expecting unit at position " + pos + ", got: '" + char_str_at( input, e.position ) + "'";
+            break;
+        case errc::parse_expecting_character:
+            msg = "quantity: expecting '" + to_string( e.expected ) + "'";
+            break;
+        case errc::undefined_unit:
+            msg = "quantity: undefined unit '" + name + "'";
+            break;
+        case errc::extension_table_full:
+            msg = "quantity: dimension extension table full, while trying to add '" + name + "'";
+            break;
+        default:
+            msg = render_error_code( e, input );
+            break;
+    }
+
+    return "quantity: parsing unit '" + input + "': " + msg;
+}
+
 /// default strip set for strip(), strip_left(), strip_right().
 inline char const* const default_strip_set()
 {
@@ -168,7 +237,9 @@ public:
     , current_pos( 0 )
     , num_value( value_type(1) )
     , pfx_factor( value_type(1) )
+    , error_state( detail::make_error( errc::ok ) )
     {
+        debug( false );
     }
 
     /**
@@ -183,20 +254,34 @@ public:
     }
 
     /**
-     * convert given string to quantity.
+     * convert given string to quantity; throws quantity_parser_error on failure.
      */
     quantity parse( std::string text )
     {
-        try
+        quantity const q( parseInput( text ) );
+
+        if ( failed() )
         {
-            return parseInput( text );
+            PHYS_UNITS_THROW( quantity_parser_error( error_state, input_text() ) );
         }
-        catch ( quantity_error const & e )
+
+        return q;
+    }
+
+    /**
+     * convert given string to quantity without throwing; on failure the result
+     * holds the error code and position, and renders the message on request.
+     */
+    quantity_result try_parse( std::string const & text )
+    {
+        quantity const q( parseInput( text ) );
+
+        if ( failed() )
         {
-            throw quantity_parser_error(
-                "quantity: parsing unit '" + text + "': " + e.what(),
-                    input_text(), input_position() );
+            return quantity_result( q, error_state, input_text() );
         }
+
+        return quantity_result( q );
     }
 
     /**
@@ -244,7 +329,10 @@ public:
      */
     quantity_parser & debug( bool on )
     {
+        // a bad debug stream skips formatting, so a reused parser
+        // does not collect the trace of every parse:
         debug_flag = on;
+        oss.clear( on ? std::ios::goodbit : std::ios::badbit );
         return *this;
     }
 
@@ -282,6 +370,9 @@ private:
      */
     quantity parseInput( std::string const text_ )
     {
+        PHYS_UNITS_LATENCY_SCOPE( parse );
+        PHYS_UNITS_STATS_ADD( parses, 1 );
+
         oss << "parse(): '" << text_ << "'" << std::endl;
 
         initialize( text_ );
@@ -290,12 +381,14 @@ private:
 
         quantity const q( parseNumValueExpression() );
 
+        if ( failed() )
+        {
+            return q;
+        }
+
         if ( ! accept( end_char ) )
         {
-            throw quantity_parser_error(
-                std::string() + "garbage at position " +
-                    detail::to_string( current_pos ) + ": '" + currentStr() + "'",
-                        input_text(), input_position() );
+            return fail( errc::parse_garbage );
         }
 
         pfx_factor = (q / numerical_value() ).value();
@@ -361,14 +454,11 @@ private:
 
         int solidus_count = 0;
 
-        while ( isOperator( current() ) )
+        while ( ! failed() && isOperator( current() ) )
         {
             if ( isOperator( ahead() ) )
             {
-                throw quantity_parser_error(
-                    std::string() + "consecutive operators at position " +
-                        detail::to_string( input_position() ) + ": '" + currentStr() + "' and '" + aheadStr() + "'",
-                            input_text(), input_position() );
+                return fail( errc::parse_consecutive_operators );
             }
 
             switch( current() )
@@ -384,10 +474,7 @@ private:
                     oss << "parseTerm(): '" << current() << "'" << std::endl;
                     if ( ++solidus_count > 1 )
                     {
-                        throw quantity_parser_error(
-                            std::string() + "repetition of solidus at position " +
-                                detail::to_string( current_pos ) + ": use parenthesis to avoid ambiguity",
-                                    input_text(), input_position() );
+                        return fail( errc::parse_repeated_solidus );
                     }
                     advance();
                     lhs /= parseFactor();
@@ -410,7 +497,10 @@ private:
         {
             quantity const q( parseExpression() );
 
-            expect( ')' );
+            if ( failed() || ! expect( ')' ) )
+            {
+                return quantity();
+            }
 
             return parsePower( q );
         }
@@ -422,120 +512,118 @@ private:
             return number();
         }
 
-        // Note order: keep as separate statements:
+        quantity const unit( parsePrefixedUnit() );
 
-        value_type const prefix = parsePrefix();
+        if ( failed() )
+        {
+            return unit;
+        }
 
-        return parsePower( prefix * parseUnit() );
+        return parsePower( unit );
     }
 
     /*
-     * prefix variations:
+     * prefixed unit, scanned in one pass:
      * m - no prefix
-     * km - normal prefix
-     * kfoo - normal prefix
+     * km, mmol, daN - prefix and predefined unit
+     * cd, kg, min - predefined unit rather than prefix and unit
+     * kfoo - prefix and extension unit, if foo is no extension unit
      * !foo - escape: skip prefix, interpret as unit
      * k!foo - allow redundant escape
+     * 1 - if followed by "/"
      */
-    value_type parsePrefix()
+    quantity parsePrefixedUnit()
     {
-        using namespace phys::units;
-
-        oss << "parsePrefix(): current: '" << current() << "'" << std::endl;
-        oss << "parsePrefix(): ahead: '" << ahead() << "'" << std::endl;
+        oss << "parsePrefixedUnit(): '" << current() << "'" << std::endl;
 
-        std::string pfx = currentStr();
-
-        if ( isEscape( current() ) )
-        {
-            // !foo
-            return 1.0;
-        }
-        else if ( ! isUnit( ahead() ) )
-        {
-            // V#
-            return 1.0;
-        }
-        else if ( current() == 'c' && 'd' == ahead() )
-        {
-            // cd
-            return 1.0;
-        }
-        else if ( current() == 'k' && 'g' == ahead() )
+        /*
+         * special case: 1/{unit}
+         */
+        if ( current() == '1' )
         {
-            // kg
-            return 1.0;
+            if ( ahead() != '/' )
+            {
+                return fail( errc::parse_expecting_reciprocal );
+            }
+
+            accept( '1' );
+            return number();
         }
-        else if ( current() == 'm' && 'o' == ahead() )
+
+        if ( ! isUnit( current(), ahead() ) )
         {
-            // mol?
-            return 1.0;
+            return fail( errc::parse_expecting_unit );
         }
-        else if ( current() == 'm' && 'i' == ahead() )
+
+        if ( isEscape( current() ) )
         {
-            // min?
-            return 1.0;
+            return parseUnit( scanUnit() );
         }
-        else if ( current() == 'P' && 'a' == ahead() )
+
+        detail::unit_scanner::cursor cursor( detail::get_unit_scanner() );
+
+        unit_text.clear();
+
+        while ( cursor.step( current() ) )
         {
-            // Pa
-            return 1.0;
+            unit_text.append( 1, current() );
+            advance();
         }
-        else if ( current() == 'G' && 'y' == ahead() )
+
+        oss << "parsePrefixedUnit(): '" << unit_text << "'" << std::endl;
+
+        if ( isEscape( current() ) && cursor.prefix_size() == cursor.size() )
         {
-            // Gy
-            return 1.0;
+            return cursor.prefix_factor() * parseUnit( scanUnit() );
         }
-        else if ( current() == 'd' && 'a' == ahead() )
+
+        if ( detail::unit_slot const * const e = cursor.unit() )
         {
-            // deka?
-            advance();
-            pfx += currentStr();
+            PHYS_UNITS_STATS_ADD( lookups, 1 );
+
+            return cursor.factor() * e->unit;
         }
-        else if ( ! has_prefix( currentStr() ) )
+
+        // a bare prefix, such as k in "1 k", is a unit name of its own:
+
+        if ( 0 < cursor.prefix_size() && cursor.prefix_size() < static_cast<int>( unit_text.size() ) &&
+             0 == detail::find_unit_function( unit_text ) )
         {
-            // not a prefix
-            return 1.0;
+            return cursor.prefix_factor() * parseUnit( unit_text.substr( cursor.prefix_size() ) );
         }
 
-        advance();
-
-        return prefix( pfx );
+        return parseUnit( unit_text );
     }
 
     /*
-     * [unit], e.g. "m", "1" if followed by "/", {escape}{unit}.
+     * unit with given name, predefined or extension; defined as extension
+     * unit if unit extending is enabled.
      */
-    quantity parseUnit()
+    quantity parseUnit( std::string const & name )
     {
-        oss << "parseUnit(): '" << current() << "'" << std::endl;
+        if ( detail::unit_slot const * const e = detail::find_predefined_unit( name ) )
+        {
+            PHYS_UNITS_STATS_ADD( lookups, 1 );
 
-        /*
-         * special case: 1/{unit}
-         */
-        if ( current() == '1' )
+            return e->unit;
+        }
+
+        detail::unit_function_t f = detail::find_unit_function( name );
+
+        if ( 0 == f && ext_units )
         {
-            if ( ahead() != '/' )
+            if ( 0 == ( f = detail::try_define_unit( detail::get_xmap(), name ) ) )
             {
-                throw quantity_parser_error(
-                    std::string() + "expecting 1/u construct at position " +
-                        detail::to_string( current_pos ) + ", got: '1" + (end_char==ahead() ? "[nothing]" : aheadStr()) + "'",
-                            input_text(), input_position() );
+                return fail( errc::extension_table_full, static_cast<int>( name.size() ) );
             }
-
-            accept( '1' );
-            return number();
         }
 
-        if ( ! isUnit( current(), ahead() ) )
+        if ( 0 == f )
         {
-            throw quantity_parser_error(
-                std::string() + "expecting unit at position " +
-                    detail::to_string( current_pos ) + ", got: '" + (end_char==current() ? "[nothing]" : currentStr()) + "'",
-                        input_text(), input_position() );
+            return fail( errc::undefined_unit, static_cast<int>( name.size() ) );
         }
 
-        return unit( scanUnit(), rt::phys::units::extend( ext_units ) );
+        return f();
     }
 
     /*
@@ -615,6 +703,7 @@ private:
     {
         current_pos = 0;
         current_char = ' ';
+        error_state = detail::make_error( errc::ok );
 
         text = detail::strip( text_ ) + detail::to_string( end_char );
 
@@ -697,11 +786,6 @@ private:
         return detail::to_string( current() );
     }
 
-    std::string aheadStr()
-    {
-        return detail::to_string( ahead() );
-    }
-
     char current() const
     {
         return current_char;
@@ -738,15 +822,36 @@ private:
         return current();
     }
 
-    void expect( char chr )
+    bool expect( char chr )
     {
         if ( chr != current() )
         {
-            throw quantity_parser_error(
-                "quantity: expecting '" + std::string(1,static_cast<char>(chr)) + "'",
-                    input_text(), input_position() );
+            fail( errc::parse_expecting_character, 0, chr );
+            return false;
         }
         advance();
+        return true;
+    }
+
+    /*
+     * true if an error occurred.
+     */
+    bool failed() const
+    {
+        return errc::ok != error_state.code;
+    }
+
+    /*
+     * record the first error at the current position, return a dummy quantity.
+     */
+    quantity fail( errc::type code, int extent = 0, char expected = '\0' )
+    {
+        if ( ! failed() )
+        {
+            error_state = detail::make_error( code, current_pos, extent, expected );
+            error_state.render = detail::render_parse_error;
+        }
+        return quantity();
     }
 
 private:
@@ -758,10 +863,12 @@ private:
     char current_char;          //< current scanner character
     int  current_pos;           //< current scanner character position
     std::string text;           //< input text
+    std::string unit_text;      //< scanned unit symbol
     std::istringstream iss;     //< input stream
     std::ostringstream oss;     //< debug output stream
     value_type num_value;       //< numerical value, e.g. the v in v km/h
     value_type pfx_factor;      //< prefix factor, e.g. the k in v km/h
+    error_info error_state;     //< first error of last parse
 };
 
 /** \name Quantity, create from text */
@@ -795,6 +902,32 @@ make_quantity( std::string text, extend extunits, dimensionless dimless )
 
 } // namespace detail {
 
+/**
+ * return result with quantity for given text, or with error code and position;
+ * optionally define not-yet-defined units (extunits),
+ * optionally accept dimensionless quantities (dimless).
+ */
+inline quantity_result
+try_to_quantity( std::string const & text, extend extunits, dimensionless dimless )
+{
+    quantity_parser parser;
+    parser.
+        extend( !!extunits ).
+        dimensionless( !!dimless );
+
+    return parser.try_parse( text );
+}
+
+/**
+ * return result with quantity for given text, or with error code and position;
+ * no unit extension, no dimensionless quantities.
+ */
+inline quantity_result
+try_to_quantity( std::string const & text )
+{
+    return try_to_quantity( text, no_extend(), non_dimensionless() );
+}
+
 /**
  * return quantity for given text;
  * optionally define not-yet-defined units (extunits),
@@ -952,6 +1085,270 @@ to_numerical_value( std::string text, dimensionless dimless, extend extunits )
 
 /// @}
 
+namespace detail {
+
+/**
+ * scan a floating-point number at the front of [first, last) into value;
+ * return the end of the number, or first if there is none.
+ */
+inline char const * scan_number( char const * first, char const * last, quantity::value_type & value )
+{
+    char const * p = first;
+
+    if ( p != last && ( '+' == *p || '-' == *p ) ) ++p;
+
+    char const * const digits = p;
+
+    while ( p != last && std::isdigit( static_cast<unsigned char>( *p ) ) ) ++p;
+
+    if ( p != last && '.' == *p )
+    {
+        ++p;
+        while ( p != last && std::isdigit( static_cast<unsigned char>( *p ) ) ) ++p;
+    }
+
+    if ( p == digits || ( p == digits + 1 && '.' == *digits ) )
+    {
+        return first;
+    }
+
+    if ( p != last && ( 'e' == *p || 'E' == *p ) )
+    {
+        char const * q = p + 1;
+
+        if ( q != last && ( '+' == *q || '-' == *q ) ) ++q;
+
+        if ( q != last && std::isdigit( static_cast<unsigned char>( *q ) ) )
+        {
+            p = q;
+            while ( p != last && std::isdigit( static_cast<unsigned char>( *p ) ) ) ++p;
+        }
+    }
+
+    char buf[64];
+    std::size_t const n = static_cast<std::size_t>( p - first );
+
+    if ( n >= sizeof buf )
+    {
+        value = std::strtod( std::string( first, p ).c_str(), 0 );
+    }
+    else
+    {
+        std::memcpy( buf, first, n );
+        buf[n] = '\0';
+        value = std::strtod( buf, 0 );
+    }
+
+    return p;
+}
+
+/// skip blanks at the front of [first, last).
+inline char const * skip_blanks( char const * first, char const * last )
+{
+    while ( first != last && ( ' ' == *first || '\t' == *first ) ) ++first;
+    return first;
+}
+
+/// skip blanks at the rear of [first, last); return the new end.
+inline char const * skip_blanks_rear( char const * first, char const * last )
+{
+    while ( first != last && ( ' ' == last[-1] || '\t' == last[-1] || '\r' == last[-1] ) ) --last;
+    return last;
+}
+
+} // namespace detail
+
+/**
+ * cache of unit texts, such as km/h, each parsed once into its unit in SI base
+ * units; later lookups of the same text only search the cache. Converting
+ * "12.5 km/h" then takes a strtod() and a lookup instead of a full parse.
+ */
+class unit_cache
+{
+public:
+    /**
+     * the representation type.
+     */
+    typedef quantity::value_type value_type;
+
+    /**
+     * constructor; optionally define not-yet-defined units (extunits),
+     * optionally accept dimensionless units such as 1 (dimless); escape
+     * is the escape character for extension units.
+     */
+    explicit unit_cache( extend extunits = no_extend(), dimensionless dimless = dimensionless(), char escape = '!' )
+    : m_extend( !!extunits )
+    , m_dimless( !!dimless )
+    , m_escape( escape )
+    , m_hits( 0 )
+    , m_misses( 0 )
+    , m_error( detail::make_error( errc::ok ) )
+    {
+    }
+
+    /**
+     * the unit for given text, or 0 if the text is not a valid unit;
+     * the error of an invalid unit is available via error().
+     */
+    quantity const * find( std::string const & text )
+    {
+        map_type::const_iterator pos = m_units.find( text );
+
+        if ( m_units.end() != pos )
+        {
+            ++m_hits;
+            return &pos->second;
+        }
+
+        ++m_misses;
+
+        quantity_parser parser;
+        parser.
+            extend( m_extend ).
+            escape( m_escape ).
+            dimensionless( m_dimless );
+
+        quantity_result const r( parser.try_parse( text ) );
+
+        detail::trace( trace_op::cache_miss, text.c_str(), r.ok() ? r.value().dimension() : dimensions() );
+
+        if ( ! r.ok() )
+        {
+            m_error = r.error();
+            return 0;
+        }
+
+        // a unit has no number, except the 1 of 1/s or of the unit 1;
+        // text such as e3 or . reads as part of a number, not as a unit:
+
+        if ( 1 != parser.numerical_value() || starts_with_number( text ) )
+        {
+            m_error = detail::make_error( errc::parse_expecting_unit, 1 );
+            m_error.render = detail::render_parse_error;
+            return 0;
+        }
+
+        quantity const u( r.value() );
+
+        return &m_units.insert( map_type::value_type( text, u ) ).first->second;
+    }
+
+    /**
+     * true if text starts with a number other than the 1 of 1/s or of the unit 1.
+     */
+    static bool starts_with_number( std::string const & text )
+    {
+        char const * const first = detail::skip_blanks( text.data(), text.data() + text.size() );
+        char const * const last  = text.data() + text.size();
+
+        value_type value = 0;
+        char const * const p = detail::skip_blanks( detail::scan_number( first, last, value ), last );
+
+        return p != first && ( 1 != value || ( p != last && '/' != *p ) );
+    }
+
+    /**
+     * the unit for given text; throws quantity_parser_error for an invalid unit.
+     */
+    quantity const & unit( std::string const & text )
+    {
+        quantity const * const u = find( text );
+
+        if ( 0 == u )
+        {
+            PHYS_UNITS_THROW( quantity_parser_error( m_error, text ) );
+        }
+
+        return *u;
+    }
+
+    /**
+     * the error of the last invalid unit.
+     */
+    error_info const & error() const
+    {
+        return m_error;
+    }
+
+    /**
+     * the unit for the text in [first, last).
+     */
+    quantity const & unit( char const * first, char const * last )
+    {
+        m_key.assign( first, last );
+        return unit( m_key );
+    }
+
+    /**
+     * quantity for text such as 12.5 km/h; a bare number is dimensionless,
+     * a unit without a number counts once.
+     */
+    quantity to_quantity( std::string const & text )
+    {
+        char const * const first = text.data();
+        char const * const last  = first + text.size();
+
+        value_type value = 1;
+        char const * p = detail::scan_number( detail::skip_blanks( first, last ), last, value );
+        char const * const unit_end = detail::skip_blanks_rear( p, last );
+        p = detail::skip_blanks( p, unit_end );
+
+        if ( p == unit_end )
+        {
+            return quantity( dimensionless_d, value );
+        }
+
+        quantity const & u = unit( p, unit_end );
+
+        return quantity( u.dimension(), value * u.value() );
+    }
+
+    /**
+     * number of lookups found in the cache.
+     */
+    std::size_t hits() const
+    {
+        return m_hits;
+    }
+
+    /**
+     * number of lookups that parsed the unit.
+     */
+    std::size_t misses() const
+    {
+        return m_misses;
+    }
+
+    /**
+     * number of cached units.
+     */
+    std::size_t size() const
+    {
+        return m_units.size();
+    }
+
+    /**
+     * remove all units and reset the counters.
+     */
+    void clear()
+    {
+        m_units.clear();
+        m_hits = m_misses = 0;
+    }
+
+private:
+    typedef std::map<std::string, quantity> map_type;
+
+    bool m_extend;          ///< define unrecognized units
+    bool m_dimless;         ///< accept dimensionless units
+    char m_escape;          ///< unit escape character
+    std::size_t m_hits;     ///< lookups found in cache
+    std::size_t m_misses;   ///< lookups parsed
+    error_info m_error;     ///< error of last invalid unit
+    map_type m_units;       ///< unit per text
+    std::string m_key;      ///< reused lookup key
+};
+
 }}} // namespace rt { namespace phys { namespace units {
 
 #endif // PHYS_UNITS_IO_INPUT_HPP_INCLUDED
@@ -32,16 +32,28 @@
 #ifndef PHYS_UNITS_IO_OUTPUT_HPP_INCLUDED
 #define PHYS_UNITS_IO_OUTPUT_HPP_INCLUDED
 
+#include "phys/units/latency.hpp"
 #include "phys/units/quantity.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ios>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <string>
 #include <assert.h>
 
+#if __cplusplus >= 201103L
+# include <unordered_map>
+#endif
+
 namespace rt { namespace phys { namespace units {
 
 /**
@@ -109,16 +121,21 @@ namespace detail {
 typedef Rep (*prefix_function_t)();
 
 /**
- * return factor for given prefix.
+ * prefix and its factor delivering function.
  */
-inline prefix_function_t
-prefix_function( std::string const prefix )
+struct prefix_entry
 {
-    struct entry
-    {
-        char const * name; prefix_function_t func;
-    }
-    table[] =
+    char const * name;          ///< prefix, e.g. "k"
+    prefix_function_t func;     ///< factor delivering function
+};
+
+/**
+ * the prefixes, terminated by an entry without name.
+ */
+inline prefix_entry const *
+prefix_table()
+{
+    static prefix_entry const table[] =
     {
         { "m", milli },
         { "k", kilo  },
@@ -143,20 +160,17 @@ prefix_function( std::string const prefix )
         {  0 , 0     },
     };
 
-    entry * p = table;
-    for ( ; p->name; ++p )
-    {
-        if ( prefix == p->name )
-        {
-            return p->func;
-        }
-    }
-    return 0;
+    return table;
 }
 
 typedef quantity (*unit_function_t)();                  ///< unit quantity delivering function type
+#if __cplusplus >= 201103L
+typedef std::unordered_map<dimensions, std::string> unitnamemap;  ///< unit name map type, hashed
+typedef std::unordered_map<std::string, unit_function_t> unitmap; ///< unit delivering function map type, hashed
+#else
 typedef std::map<dimensions, std::string> unitnamemap;  ///< unit name map type
 typedef std::map<std::string, unit_function_t> unitmap; ///< unit delivering function map type
+#endif
 
 /**
  * create map with predefined unit names
@@ -320,6 +334,373 @@ get_xmap()
     return m;
 }
 
+/**
+ * hash of a unit symbol of n > 0 characters; distinct for all predefined
+ * symbols, so that the unit table needs no probing.
+ */
+inline std::size_t
+unit_hash( char const * s, std::size_t n )
+{
+    return ( 12u * static_cast<unsigned char>( s[0] ) + 7u * static_cast<unsigned char>( s[n - 1] ) + n ) & 63u;
+}
+
+/**
+ * predefined unit in the unit table.
+ */
+struct unit_slot
+{
+    std::string name;           ///< symbol, empty for an unused slot
+    unit_function_t func;       ///< unit delivering function
+    quantity unit;              ///< 1 [unit], precomputed
+};
+
+/**
+ * perfect hash table of the predefined units, with their quantities
+ * precomputed; see unit_hash().
+ */
+struct unit_table
+{
+    enum { size = 64 };
+
+    unit_slot slot[ size ];     ///< units by hash
+    std::size_t max_size;       ///< length of longest symbol
+    bool complete;              ///< all predefined units have a slot
+
+    /**
+     * fill the table from the predefined units.
+     */
+    unit_table()
+    : max_size( 0 )
+    , complete( true )
+    {
+        for ( unitmap::const_iterator pos = get_umap().begin(); pos != get_umap().end(); ++pos )
+        {
+            std::string const & name = pos->first;
+
+            if ( name.empty() )
+            {
+                continue;
+            }
+
+            unit_slot & e = slot[ unit_hash( name.data(), name.size() ) ];
+
+            if ( ! e.name.empty() )
+            {
+                complete = false;
+                continue;
+            }
+
+            e.name = name;
+            e.func = pos->second;
+            pos->second().swap( e.unit );
+
+            max_size = std::max( max_size, name.size() );
+        }
+    }
+};
+
+/**
+ * the unit table.
+ */
+inline unit_table const &
+get_unit_table()
+{
+    static unit_table const t;
+    return t;
+}
+
+/**
+ * the slot of the predefined unit for given symbol; 0 if not found in the unit table.
+ */
+inline unit_slot const *
+find_predefined_unit( std::string const & text )
+{
+    unit_table const & t = get_unit_table();
+    std::size_t const n = text.size();
+
+    if ( 0 == n || n > t.max_size )
+    {
+        return 0;
+    }
+
+    unit_slot const & e = t.slot[ unit_hash( text.data(), n ) ];
+
+    return e.name.size() == n && 0 == std::memcmp( e.name.data(), text.data(), n ) ? &e : 0;
+}
+
+/**
+ * one-pass scanner of unit symbols with an optional prefix, such as km, mmol
+ * and daN. It holds two tries over the unit symbol characters, one of the
+ * predefined units and one of the prefixes, as a transition table. While
+ * scanning, a cursor follows the unit trie from the start of the symbol and
+ * from the end of each prefix found. An unprefixed unit wins, then the one
+ * with the longest prefix, so that cd is candela, kg kilogram and dam
+ * decameter. Built once from the unit table, then read-only.
+ */
+class unit_scanner
+{
+public:
+    typedef unsigned short node_type;
+
+    enum
+    {
+        alphabet    = 53,       ///< A-Z, a-z and ' (as in 'C)
+        none        = 0xff,     ///< not a unit symbol character
+        dead        = 0,        ///< node without transitions
+        unit_root   = 1,        ///< root of the unit trie
+        prefix_root = 2,        ///< root of the prefix trie
+        max_cursors = 4         ///< prefixes that start a symbol, e.g. d, da
+    };
+
+    /**
+     * scan state of a symbol, character by character.
+     */
+    class cursor
+    {
+    public:
+        explicit cursor( unit_scanner const & scanner )
+        : m_scanner( scanner )
+        , m_unit( unit_root )
+        , m_prefix( prefix_root )
+        , m_count( 0 )
+        , m_size( 0 )
+        {
+        }
+
+        /**
+         * advance over character c; false if c is not a unit symbol character.
+         */
+        bool step( char const c )
+        {
+            unsigned const s = m_scanner.m_symbol[ static_cast<unsigned char>( c ) ];
+
+            if ( none == s )
+            {
+                return false;
+            }
+
+            m_unit   = m_scanner.next( m_unit, s );
+            m_prefix = m_scanner.next( m_prefix, s );
+
+            for ( int k = 0; k < m_count; ++k )
+            {
+                m_after[k] = m_scanner.next( m_after[k], s );
+            }
+
+            ++m_size;
+
+            if ( m_scanner.m_prefix[ m_prefix ] >= 0 && m_count < max_cursors )
+            {
+                m_after[ m_count ] = unit_root;
+                m_after_prefix[ m_count ] = m_scanner.m_prefix[ m_prefix ];
+                m_after_size[ m_count ] = m_size;
+                ++m_count;
+            }
+            return true;
+        }
+
+        /**
+         * the predefined unit of the symbol, 0 if none; see factor().
+         */
+        unit_slot const * unit() const
+        {
+            int const k = match();
+            return k > -2 ? &get_unit_table().slot[ m_scanner.m_unit[ k < 0 ? m_unit : m_after[k] ] ] : 0;
+        }
+
+        /**
+         * the prefix factor of the predefined unit, 1 if it has no prefix.
+         */
+        Rep factor() const
+        {
+            int const k = match();
+            return k >= 0 ? prefix_table()[ m_after_prefix[k] ].func() : Rep( 1 );
+        }
+
+        /**
+         * length of the longest prefix that starts the symbol, 0 if none.
+         */
+        int prefix_size() const
+        {
+            return m_count ? m_after_size[ m_count - 1 ] : 0;
+        }
+
+        /**
+         * factor of the longest prefix that starts the symbol, 1 if none.
+         */
+        Rep prefix_factor() const
+        {
+            return m_count ? prefix_table()[ m_after_prefix[ m_count - 1 ] ].func() : Rep( 1 );
+        }
+
+        /**
+         * the number of characters scanned.
+         */
+        int size() const
+        {
+            return m_size;
+        }
+
+    private:
+        /// -1 for an unprefixed unit, the cursor of the longest prefix, or -2 if no unit.
+        int match() const
+        {
+            if ( m_scanner.m_unit[ m_unit ] >= 0 )
+            {
+                return -1;
+            }
+
+            for ( int k = m_count - 1; k >= 0; --k )
+            {
+                if ( m_scanner.m_unit[ m_after[k] ] >= 0 )
+                {
+                    return k;
+                }
+            }
+            return -2;
+        }
+
+        unit_scanner const & m_scanner;         ///< the scanner
+        node_type m_unit;                       ///< unit trie node of unprefixed symbol
+        node_type m_prefix;                     ///< prefix trie node
+        node_type m_after[ max_cursors ];       ///< unit trie node after a prefix
+        signed char m_after_prefix[ max_cursors ];  ///< index of that prefix
+        int m_after_size[ max_cursors ];        ///< length of that prefix
+        int m_count;                            ///< number of prefixes found
+        int m_size;                             ///< characters scanned
+    };
+
+    /**
+     * build the tries from the unit table and the prefix table.
+     */
+    unit_scanner()
+    {
+        std::fill( m_symbol, m_symbol + PHYS_UNITS_DIMENSION_OF( m_symbol ), static_cast<unsigned char>( none ) );
+
+        for ( int c = 0; c < 26; ++c )
+        {
+            m_symbol[ 'A' + c ] = static_cast<unsigned char>( c );
+            m_symbol[ 'a' + c ] = static_cast<unsigned char>( 26 + c );
+        }
+        m_symbol[ static_cast<unsigned char>( '\'' ) ] = 52;
+
+        add_node();     // dead
+        add_node();     // unit_root
+        add_node();     // prefix_root
+
+        unit_table const & t = get_unit_table();
+
+        for ( int i = 0; i < unit_table::size; ++i )
+        {
+            if ( ! t.slot[i].name.empty() )
+            {
+                node_type const n = insert( unit_root, t.slot[i].name );
+
+                if ( dead != n )
+                {
+                    m_unit[n] = static_cast<signed char>( i );
+                }
+            }
+        }
+
+        for ( int i = 0; prefix_table()[i].name; ++i )
+        {
+            m_prefix[ insert( prefix_root, prefix_table()[i].name ) ] = static_cast<signed char>( i );
+        }
+    }
+
+    /**
+     * index of the given prefix in prefix_table(), -1 if it is no prefix.
+     */
+    int find_prefix( std::string const & text ) const
+    {
+        node_type n = prefix_root;
+
+        for ( std::string::size_type i = 0; i < text.size() && dead != n; ++i )
+        {
+            unsigned const s = m_symbol[ static_cast<unsigned char>( text[i] ) ];
+
+            n = none == s ? node_type( dead ) : next( n, s );
+        }
+        return text.empty() ? -1 : m_prefix[n];
+    }
+
+private:
+    node_type next( node_type const n, unsigned const s ) const
+    {
+        return m_next[ n * alphabet + s ];
+    }
+
+    node_type add_node()
+    {
+        m_next.resize( m_next.size() + alphabet, node_type( dead ) );
+        m_unit.push_back( -1 );
+        m_prefix.push_back( -1 );
+        return static_cast<node_type>( m_unit.size() - 1 );
+    }
+
+    /// the node of text below root, added if new; dead if text has other characters.
+    node_type insert( node_type n, std::string const & text )
+    {
+        for ( std::string::size_type i = 0; i < text.size(); ++i )
+        {
+            unsigned const s = m_symbol[ static_cast<unsigned char>( text[i] ) ];
+
+            if ( none == s )
+            {
+                return dead;
+            }
+
+            if ( dead == next( n, s ) )
+            {
+                node_type const added = add_node();
+                m_next[ n * alphabet + s ] = added;
+            }
+            n = next( n, s );
+        }
+        return n;
+    }
+
+    unsigned char m_symbol[ 256 ];          ///< symbol per character, none for others
+    std::vector<node_type> m_next;          ///< transition per node and symbol
+    std::vector<signed char> m_unit;        ///< unit table slot per node, -1 if none
+    std::vector<signed char> m_prefix;      ///< prefix table index per node, -1 if none
+};
+
+/**
+ * the unit scanner.
+ */
+inline unit_scanner const &
+get_unit_scanner()
+{
+    static unit_scanner const scanner;
+    return scanner;
+}
+
+/**
+ * return factor for given prefix.
+ */
+inline prefix_function_t
+prefix_function( std::string const prefix )
+{
+    PHYS_UNITS_STATS_ADD( lookups, 1 );
+
+    int const i = get_unit_scanner().find_prefix( prefix );
+
+    return i < 0 ? 0 : prefix_table()[i].func;
+}
+
+/**
+ * the unit name generation, incremented when a unit name is defined;
+ * cached unit symbols of an older generation are stale.
+ */
+inline unsigned long &
+unit_name_generation()
+{
+    static unsigned long generation = 1;
+    return generation;
+}
+
 /**
  * define a unit name for given dimension.
  */
@@ -327,6 +708,9 @@ inline void
 define_unit_name( dimensions const & d, std::string const name )
 {
     detail::get_nmap()[d] = name;
+    ++unit_name_generation();
+
+    detail::trace( trace_op::define_unit_name, name.c_str(), d );
 }
 
 /**
@@ -339,11 +723,11 @@ define_unit_name( quantity const & q, std::string const name )
 }
 
 /**
- * append the given unit name to the given map (used for extension units);
- * throws unit_error when table of 10 items is full.
+ * append the given unit name to the given map (used for extension units)
+ * and return its unit delivering function; 0 when table of 10 items is full.
  */
-inline quantity
-define_unit( unitmap & m, std::string const name )
+inline unit_function_t
+try_define_unit( unitmap & m, std::string const name )
 {
     unit_function_t table[] =
     {
@@ -365,14 +749,71 @@ define_unit( unitmap & m, std::string const name )
 
     if ( index >= PHYS_UNITS_DIMENSION_OF( table ) )
     {
-        throw unit_error( "quantity: dimension extension table full, while trying to add '" + name + "'" );
+        return 0;
     }
 
     m[name] = table[index];
 
+    detail::trace( trace_op::define_unit, name.c_str(), table[index]().dimension() );
+
     define_unit_name( table[index](), name );
 
-    return unit( name );
+    return table[index];
+}
+
+/**
+ * append the given unit name to the given map (used for extension units);
+ * throws unit_error when table of 10 items is full.
+ */
+inline quantity
+define_unit( unitmap & m, std::string const name )
+{
+    unit_function_t const f = try_define_unit( m, name );
+
+    if ( 0 == f )
+    {
+        PHYS_UNITS_THROW( unit_error( "quantity: dimension extension table full, while trying to add '" + name + "'" ) );
+    }
+
+    return f();
+}
+
+/**
+ * the unit delivering function for given unit, predefined or extension; 0 if not found.
+ */
+inline unit_function_t
+find_unit_function( std::string const & text )
+{
+    PHYS_UNITS_STATS_ADD( lookups, 1 );
+
+    // predefined:
+    if ( unit_slot const * e = find_predefined_unit( text ) )
+    {
+        return e->func;
+    }
+
+    // predefined without slot:
+    if ( ! get_unit_table().complete )
+    {
+        unitmap & umap = get_umap();
+        const unitmap::iterator pos = umap.find(text);
+
+        if ( pos != umap.end() )
+        {
+            return (*pos).second;
+        }
+    }
+    // extension:
+    {
+        unitmap & xmap = get_xmap();
+        const unitmap::iterator pos = xmap.find(text);
+
+        if ( pos != xmap.end() )
+        {
+            return (*pos).second;
+        }
+    }
+    return 0;
 }
 
 } // namespace detail {
@@ -397,12 +838,14 @@ prefix( std::string const prefix )
 {
     typedef quantity::value_type (*unit_function_t)();
 
-    if ( unit_function_t f = detail::prefix_function( prefix ) )
+    unit_function_t const f = detail::prefix_function( prefix );
+
+    if ( 0 == f )
     {
-        return f();
+        PHYS_UNITS_THROW( prefix_error( "quantity: unrecognized prefix '" + prefix + "'" ) );
     }
 
-    throw prefix_error( "quantity: unrecognized prefix '" + prefix + "'" );
+    return f();
 }
 
 /// @}
@@ -415,6 +858,8 @@ prefix( std::string const prefix )
 inline bool
 has_unit_name( dimensions const & d )
 {
+    PHYS_UNITS_STATS_ADD( lookups, 1 );
+
     return detail::get_nmap().end() != detail::get_nmap().find( d );
 }
 
@@ -435,34 +880,24 @@ has_unit_name( quantity const & q )
 inline quantity
 unit( std::string const text, extend extunits /* = no_extend() */ )
 {
-    detail::unitmap & xmap = detail::get_xmap();
-    detail::unitmap & umap = detail::get_umap();
-
-    // predefined:
+    if ( detail::unit_slot const * e = detail::find_predefined_unit( text ) )
     {
-        const detail::unitmap::iterator pos = umap.find(text);
+        PHYS_UNITS_STATS_ADD( lookups, 1 );
 
-        if ( pos != umap.end() )
-        {
-            return (*pos).second();
-        }
+        return e->unit;
     }
-    // extension:
-    {
-        const detail::unitmap::iterator pos = xmap.find(text);
 
-        if ( pos != xmap.end() )
-        {
-            return (*pos).second();
-        }
+    if ( detail::unit_function_t f = detail::find_unit_function( text ) )
+    {
+        return f();
     }
 
-    if ( extunits )
+    if ( ! extunits )
     {
-        return detail::define_unit( xmap, text );
+        PHYS_UNITS_THROW( unit_error( "quantity: undefined unit '" + text + "'" ) );
     }
 
-    throw unit_error( "quantity: undefined unit '" + text + "'" );
+    return detail::define_unit( detail::get_xmap(), text );
 }
 
 /// @}
@@ -475,7 +910,11 @@ namespace detail {
 inline std::string
 unit_name( dimensions const & d )
 {
-    return detail::get_nmap()[d];
+    PHYS_UNITS_STATS_ADD( lookups, 1 );
+
+    unitnamemap::const_iterator const pos = detail::get_nmap().find( d );
+
+    return detail::get_nmap().end() != pos ? pos->second : std::string();
 }
 
 /**
@@ -539,7 +978,7 @@ struct unit_info
             }
         }
 
-        for ( int i = base_cnt; i < PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT; ++i )
+        for ( int i = base_cnt; i < base_cnt + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT; ++i )
         {
             emit_dim( os, detail::unit_name( dimensions(i,1) ), m_dim.d[i], first );
         }
@@ -581,6 +1020,8 @@ struct unit_info
 inline std::string
 to_unit_name( dimensions const & d )
 {
+    PHYS_UNITS_STATS_ADD( formats, 1 );
+
     return detail::unit_info( d ).name();
 }
 
@@ -599,6 +1040,9 @@ to_unit_name( quantity const & q )
 inline std::string
 to_unit_symbol( dimensions const & d, name_symbol use = name_symbol() )
 {
+    PHYS_UNITS_LATENCY_SCOPE( unit_symbol );
+    PHYS_UNITS_STATS_ADD( formats, 1 );
+
     return detail::unit_info( d ).symbol( use );
 }
 
@@ -642,17 +1086,280 @@ to_string( long double const value )
 
 /// @}
 
+namespace detail {
+
+/**
+ * cached unit symbol of a dimension.
+ */
+struct symbol_cache_entry
+{
+    unsigned long generation;                                       //< unit name generation, 0: empty
+    bool use_name;                                                  //< symbol uses unit name
+    dimensions::value_type dim[ 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT ];  //< dimension exponents
+    unsigned char length;                                           //< symbol length
+    char symbol[ 63 ];                                              //< symbol text, not terminated
+};
+
+/**
+ * per-thread, two-way set-associative cache of unit symbols; two ways keep
+ * for example the named and the base-unit symbol of a dimension that map to
+ * the same set.
+ */
+struct symbol_cache
+{
+    enum { sets = 64, ways = 2 };
+
+    symbol_cache_entry entry[ sets ][ ways ];
+};
+
+/**
+ * the unit symbol cache of the current thread.
+ */
+inline symbol_cache &
+get_symbol_cache()
+{
+    static PHYS_UNITS_THREAD_LOCAL symbol_cache cache;
+    return cache;
+}
+
+/**
+ * true if entry holds the current symbol for given dimension and use.
+ */
+inline bool
+symbol_cache_hit( symbol_cache_entry const & e, dimensions const & d, name_symbol use )
+{
+    return e.generation == unit_name_generation() && e.use_name == bool( use ) &&
+        std::equal( d.d.begin(), d.d.end(), e.dim );
+}
+
+/**
+ * the unit symbol cache entry for given dimension; on a miss the most
+ * recently filled way of the set is kept and the other one is replaced.
+ * Return 0 if the symbol does not fit an entry.
+ */
+inline symbol_cache_entry const *
+cached_unit_symbol( dimensions const & d, name_symbol use )
+{
+    unsigned long hash = detail::fnv1a( static_cast<unsigned long>( hash_value( d ) ), use ? 1 : 0 );
+
+    hash = ( hash ^ ( hash >> 16 ) ) * 0x45d9f3bUL;
+    hash =   hash ^ ( hash >> 16 );
+
+    symbol_cache_entry * const set = get_symbol_cache().entry[ hash % symbol_cache::sets ];
+
+    if ( symbol_cache_hit( set[0], d, use ) )
+    {
+        return &set[0];
+    }
+
+    if ( symbol_cache_hit( set[1], d, use ) )
+    {
+        return &set[1];
+    }
+
+    std::string const symbol( unit_info( d ).symbol( use ) );
+
+    if ( symbol.size() > sizeof set[0].symbol )
+    {
+        return 0;
+    }
+
+    set[1] = set[0];
+
+    symbol_cache_entry & e = set[0];
+
+    e.generation = unit_name_generation();
+    e.use_name   = use;
+    e.length     = static_cast<unsigned char>( symbol.size() );
+
+    to_raw( d, e.dim );
+    std::memcpy( e.symbol, symbol.data(), symbol.size() );
+
+    return &e;
+}
+
+/**
+ * format value into buf (at least 32 characters) with given number of significant
+ * digits (at most 17), or with the fewest digits that read back exactly (precision 0);
+ * return length.
+ */
+inline int
+format_real( char * buf, double const value, int const precision )
+{
+    if ( precision > 0 )
+    {
+        return std::sprintf( buf, "%.*g", precision < 17 ? precision : 17, value );
+    }
+
+    int length = 0;
+
+    for ( int digits = 15; digits <= 17; ++digits )
+    {
+        length = std::sprintf( buf, "%.*g", digits, value );
+
+        if ( std::strtod( buf, 0 ) == value || value != value )
+        {
+            break;
+        }
+    }
+    return length;
+}
+
+/**
+ * output iterator that writes into a buffer of size n like snprintf():
+ * it keeps room for the terminating null and counts all characters.
+ */
+class bounded_output
+{
+public:
+    typedef std::output_iterator_tag iterator_category;
+    typedef void value_type;
+    typedef void difference_type;
+    typedef void pointer;
+    typedef void reference;
+
+    bounded_output( char * buf, std::size_t n )
+    : m_buf( buf )
+    , m_size( n )
+    , m_length( 0 )
+    {
+    }
+
+    bounded_output & operator*()     { return *this; }
+    bounded_output & operator++()    { return *this; }
+    bounded_output & operator++(int) { return *this; }
+
+    bounded_output & operator=( char const c )
+    {
+        if ( m_length + 1 < m_size )
+        {
+            m_buf[ m_length ] = c;
+        }
+        ++m_length;
+        return *this;
+    }
+
+    /**
+     * null-terminate the buffer; return the length of the complete text.
+     */
+    std::size_t terminate()
+    {
+        if ( m_size > 0 )
+        {
+            m_buf[ m_length < m_size ? m_length : m_size - 1 ] = '\0';
+        }
+        return m_length;
+    }
+
+private:
+    char * m_buf;           ///< buffer
+    std::size_t m_size;     ///< buffer size
+    std::size_t m_length;   ///< characters written, including those that did not fit
+};
+
+} // namespace detail {
+
 namespace io {
 
+/**
+ * options for format_to().
+ */
+struct format_options
+{
+    /**
+     * constructor; precision 0 selects the shortest text that reads back exactly.
+     */
+    format_options( int const precision = 0, name_symbol use = name_symbol() )
+    : precision( precision )
+    , use_name( use )
+    {
+    }
+
+    int precision;      ///< significant digits, 0: shortest round trip
+    bool use_name;      ///< use unit name, if available
+};
+
+/**
+ * write quantity as "{magnitude} ' ' {symbol}" to output iterator out,
+ * without allocating once the unit symbol is cached; return the iterator past
+ * the last character written.
+ */
+template <typename OutputIt>
+inline OutputIt
+format_to( OutputIt out, quantity const & q, format_options const & options = format_options() )
+{
+    PHYS_UNITS_STATS_ADD( formats, 1 );
+
+    char buf[ 40 ];
+
+    int const length = detail::format_real( buf, q.value(), options.precision );
+
+    out = std::copy( buf, buf + length, out );
+    *out++ = ' ';
+
+    if ( detail::symbol_cache_entry const * e = detail::cached_unit_symbol( q.dimension(), name_symbol( options.use_name ) ) )
+    {
+        return std::copy( e->symbol, e->symbol + e->length, out );
+    }
+
+    std::string const symbol( detail::unit_info( q.dimension() ).symbol( name_symbol( options.use_name ) ) );
+
+    return std::copy( symbol.begin(), symbol.end(), out );
+}
+
+/**
+ * write quantity as "{magnitude} ' ' {symbol}" to buffer buf of size n,
+ * truncated and null-terminated like snprintf(); return the length of the
+ * complete text, excluding the terminating null.
+ */
+inline std::size_t
+format_to( char * buf, std::size_t n, quantity const & q, format_options const & options = format_options() )
+{
+    return format_to( detail::bounded_output( buf, n ), q, options ).terminate();
+}
+
 /**
  * convert given quantity to string as "{magnitude} ' ' {symbol}".
  */
 inline std::string
 to_string( quantity const & q, name_symbol use = name_symbol() )
 {
-    std::ostringstream os;
-    os << q.value() << " " << to_unit_symbol( q, use );
-    return os.str();
+    PHYS_UNITS_LATENCY_SCOPE( to_string );
+
+    std::string result;
+    format_to( std::back_inserter( result ), q, format_options( 6, use ) );
+    return result;
+}
+
+/**
+ * stream storage index of the round-trip output flag.
+ */
+inline int
+roundtrip_index()
+{
+    static int const index = std::ios_base::xalloc();
+    return index;
+}
+
+/**
+ * stream manipulator: write quantities with the fewest digits that read back
+ * exactly via to_quantity(), regardless of the stream's precision.
+ */
+inline std::ostream &
+roundtrip( std::ostream & os )
+{
+    os.iword( roundtrip_index() ) = 1;
+    return os;
+}
+
+/**
+ * stream manipulator: write quantities with the stream's precision (default).
+ */
+inline std::ostream &
+noroundtrip( std::ostream & os )
+{
+    os.iword( roundtrip_index() ) = 0;
+    return os;
 }
 
 /**
@@ -661,6 +1368,20 @@ to_string( quantity const & q, name_symbol use = name_symbol() )
 inline std::ostream &
 operator<<( std::ostream & os, quantity const & q )
 {
+    if ( os.iword( roundtrip_index() ) )
+    {
+        char buf[ 128 ];
+
+        if ( format_to( buf, sizeof buf, q ) < sizeof buf )
+        {
+            return os << buf;
+        }
+
+        std::string text;
+        format_to( std::back_inserter( text ), q );
+        return os << text;
+    }
+
     return os << q.value() << " " << to_unit_symbol( q );
 }
 
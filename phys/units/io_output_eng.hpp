@@ -17,7 +17,11 @@
 #define PHYS_UNITS_IO_OUTPUT_ENG_HPP_INCLUDED
 
 #include "phys/units/io_output.hpp"
+#include "phys/units/quantity_array.hpp"
 
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <limits>
 
@@ -33,166 +37,249 @@ namespace rt { namespace phys { namespace units {
 namespace detail {
 
 /**
- * format quantity in engineering units.
- * code derived from http://www.cs.tut.fi/~jkorpela/c/eng.html, by Jukka Korpela.
+ * power of ten; from a table of correctly rounded values for exponents in [-22, 22].
  */
-class eng_format
+inline double
+pow10( int const n )
 {
-public:
-   typedef dimensions dimension_type;
-   typedef Rep value_type;
+   static double const positive[] =
+   {
+      1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 , 1e8 , 1e9 , 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+   };
 
-   eng_format( quantity const & q, int const digits = 6, bool const showpos = false )
-   : m_magnitude()
-   , m_unit()
-   , m_fixed( false )
-   , m_showpos( showpos )
+   static double const negative[] =
+   {
+      1e-0 , 1e-1 , 1e-2 , 1e-3 , 1e-4 , 1e-5 , 1e-6 , 1e-7 , 1e-8 , 1e-9 , 1e-10, 1e-11,
+      1e-12, 1e-13, 1e-14, 1e-15, 1e-16, 1e-17, 1e-18, 1e-19, 1e-20, 1e-21, 1e-22,
+   };
+
+   if ( 0 <= n && n < int( PHYS_UNITS_DIMENSION_OF( positive ) ) )
    {
-      construct( q, digits );
+      return positive[ n ];
    }
+   if ( n < 0 && -n < int( PHYS_UNITS_DIMENSION_OF( negative ) ) )
+   {
+      return negative[ -n ];
+   }
+   return std::pow( 10.0, n );
+}
 
-   std::string magnitude() const
+/**
+ * floor( log10( x ) ) for positive finite x, from the binary exponent of x;
+ * log10() is only evaluated for x within rounding distance of a power of ten.
+ */
+inline int
+decimal_exponent( double const x )
+{
+   int binexp = 0;
+   std::frexp( x, &binexp );
+
+   // x in [2^(binexp-1), 2^binexp), so the estimate is at most one too low:
+   int n = static_cast<int>( std::floor( ( binexp - 1 ) * 0.30102999566398120 ) );
+
+   if ( x >= pow10( n + 1 ) )
    {
-      return m_magnitude;
+      ++n;
    }
 
-   std::string unit() const
+   double const margin = 4 * std::numeric_limits<double>::epsilon();
+
+   if ( x <= pow10( n ) * ( 1 + margin ) || x >= pow10( n + 1 ) * ( 1 - margin ) )
    {
-      return m_unit;
+      return static_cast<int>( std::floor( std::log10( x ) ) );
    }
+   return n;
+}
 
-   std::string repr() const
+/**
+ * x rounded half up to an integral value, for non-negative x.
+ */
+inline double
+round_half_up( double const x )
+{
+   if ( x < 2147483647.0 )
    {
-      return magnitude() + " " + unit();
+      long const i = static_cast<long>( x );
+      return static_cast<double>( x - i >= 0.5 ? i + 1 : i );
    }
 
-private:
-   /*
-    * Note that here x is always positive, no need to round symmetrically:
-    */
-   static int lrint( value_type const x )
+   double display = 0.0;
+   double const fract = std::modf( x, &display );
+
+   return fract >= 0.5 ? display + 1.0 : display;
+}
+
+/**
+ * metric prefix for exponent of ten, a multiple of 3; 0 if out of range.
+ */
+inline char const *
+eng_prefix( int const expof10 )
+{
+   static char const * prefix[] =
+   {
+      "y", "z", "a", "f", "p", "n", PHYS_UNITS_MICRO_GLYPH, "m", "",
+      "k", "M", "G", "T", "P", "E", "Z", "Y"
+   };
+
+   // from "y" to "Y":
+   const int prefix_start = -24;
+   const int prefix_end   = prefix_start + 3 * ( PHYS_UNITS_DIMENSION_OF( prefix ) -1 );
+
+   if ( prefix_start <= expof10 && expof10 <= prefix_end )
    {
-      return static_cast<int>( x + std::numeric_limits<value_type>::epsilon() );
+      return prefix[ ( expof10 - prefix_start ) / 3 ];
+   }
+   return 0;
+}
+
+/**
+ * true if a metric prefix may be used with the dimension:
+ * single symbol, not being kg.
+ */
+inline bool
+allows_eng_prefix( dimensions const & d )
+{
+   return d != mass_d && has_unit_name( d );
+}
+
+/**
+ * format magnitude in engineering notation into buf (at least 40 characters),
+ * rounded to given number of digits and written with %g; set prefix to the
+ * metric prefix, or to 0 if the exponent is written instead. Return length.
+ *
+ * Algorithm derived from http://www.cs.tut.fi/~jkorpela/c/eng.html, by Jukka Korpela,
+ * with log10() and pow() replaced by the binary exponent and a power-of-ten table.
+ */
+inline int
+format_eng_magnitude( char * buf, double value, int const digits, bool const showpos, bool const use_prefix, char const * & prefix )
+{
+   char const * sign = "";
+
+   if ( value < 0.0 )
+   {
+      sign  = "-";
+      value = -value;
+   }
+   else if ( showpos )
+   {
+      sign = "+";
+   }
+
+   if ( 0 == value || value != value || value > std::numeric_limits<double>::max() )
+   {
+      prefix = "";
+      return std::sprintf( buf, "%s%g", sign, value );
    }
 
    /*
-    * single symbol, not being kg and prefix is within range:
+    * correctly round to desired number of digits
+    * (truncation after adding epsilon as in the original, see eng_format):
     */
-   static bool fits_eng_notation( quantity const & q, int const expof10, int const prefix_start, int const prefix_end )
+   int expof10 = static_cast<int>( decimal_exponent( value ) + std::numeric_limits<double>::epsilon() );
+
+   value *= pow10( digits - 1 - expof10 );
+   value  = round_half_up( value ) * pow10( expof10 - digits + 1 );
+
+   if ( expof10 > 0 )
    {
-      return q.dimension() != mass_d
-          && has_unit_name( q.dimension() )
-          && prefix_start <= expof10 && expof10 <= prefix_end;
+      expof10 = ( expof10 / 3 ) * 3;
    }
+   else
+   {
+      expof10 = ( ( -expof10 + 3 ) / 3 ) * (-3);
+   }
+
+   value *= pow10( -expof10 );
 
-   void construct( quantity const & q, int digits )
+   if ( value >= 1000.0 )
    {
-      static char const * prefix[] =
-      {
-         "y", "z", "a", "f", "p", "n", PHYS_UNITS_MICRO_GLYPH, "m", "",
-         "k", "M", "G", "T", "P", "E", "Z", "Y"
-      };
+      value   /= 1000.0;
+      expof10 += 3;
+   }
 
-      // from "y" to "Y":
-      const int prefix_start = -24;
-      const int prefix_end   = prefix_start + 3 * ( PHYS_UNITS_DIMENSION_OF( prefix ) -1 );
+   prefix = use_prefix ? eng_prefix( expof10 ) : 0;
 
-      const char * sign = "";
+   int const length = std::sprintf( buf, "%s%g", sign, value );
 
-      value_type value = q.value();
+   return prefix ? length : length + std::sprintf( buf + length, "e%d", expof10 );
+}
 
-//       assert( isnormal( value ) ); // could also return NULL
+/**
+ * write magnitude and unit "{magnitude} ' ' {prefix}{symbol}" to out.
+ */
+template <typename OutputIt>
+inline OutputIt
+format_eng_to( OutputIt out, double const value, symbol_cache_entry const * symbol, dimensions const & d, bool const use_prefix, int const digits, bool const showpos )
+{
+   char buf[ 40 ];
+   char const * prefix = 0;
 
-      if( value < 0.0 )
-      {
-         sign  = "-";
-         value = -value;
-      }
-      else if ( m_showpos )
-      {
-         sign = "+";
-      }
-      else
-      {
-         sign = "";
-      }
+   int const length = format_eng_magnitude( buf, value, digits, showpos, use_prefix, prefix );
 
-      /*
-       * correctly round to desired number of digits:
-       */
-      int expof10 = lrint( floor( log10( value ) ) );
-      value      *= pow( 10.0, digits - 1 - expof10 );
-
-      /*
-       * contrary to VC2010 documentation, it seems that
-       *   long double modf( long double, long double* )
-       * isn't available; same for GCC 4.5.2.
-       */
-      double display = 0.0;
-      value_type fract = modf( value, &display );
-
-      if ( fract >= 0.5 )
-      {
-         display += 1.0;
-      }
+   out = std::copy( buf, buf + length, out );
+   *out++ = ' ';
 
-      value = display * pow( 10.0, expof10 - digits + 1 );
+   if ( prefix )
+   {
+      out = std::copy( prefix, prefix + std::strlen( prefix ), out );
+   }
 
-      if ( expof10 > 0 )
-      {
-         expof10 = ( expof10 / 3 ) * 3;
-      }
-      else
-      {
-         expof10 = ( ( -expof10 + 3 ) / 3 ) * (-3);
-      }
+   if ( symbol )
+   {
+      return std::copy( symbol->symbol, symbol->symbol + symbol->length, out );
+   }
 
-      value *= pow( 10.0, -expof10 );
+   std::string const text( unit_info( d ).symbol() );
 
-      if (value >= 1000.0)
-      {
-         value   /= 1000.0;
-         expof10 += 3;
-      }
-      else if (value >= 100.0)
-      {
-         digits -= 2;
-      }
-      else if ( value >= 10.0 )
-      {
-         digits -= 1;
-      }
+   return std::copy( text.begin(), text.end(), out );
+}
 
-      if ( fits_eng_notation( q, expof10, prefix_start, prefix_end ) )
-      {
-         std::ostringstream os;
+/**
+ * format quantity in engineering units.
+ */
+class eng_format
+{
+public:
+   typedef dimensions dimension_type;
+   typedef Rep value_type;
+
+   eng_format( quantity const & q, int const digits = 6, bool const showpos = false )
+   : m_magnitude()
+   , m_unit()
+   {
+      construct( q, digits, showpos );
+   }
 
-         if ( m_fixed )
-         {
-            os << sign << std::fixed << std::setprecision(digits-1) << value;
-         }
-         else
-         {
-            os << sign << value;
-         }
+   std::string magnitude() const
+   {
+      return m_magnitude;
+   }
 
-         m_magnitude = os.str();
+   std::string unit() const
+   {
+      return m_unit;
+   }
 
-         m_unit = std::string( prefix[ ( expof10 - prefix_start ) / 3] );
-      }
-      else
+   std::string repr() const
+   {
+      return magnitude() + " " + unit();
+   }
+
+private:
+   void construct( quantity const & q, int const digits, bool const showpos )
+   {
+      char buf[ 40 ];
+      char const * prefix = 0;
+
+      int const length = format_eng_magnitude(
+         buf, q.value(), digits, showpos, allows_eng_prefix( q.dimension() ), prefix );
+
+      m_magnitude.assign( buf, length );
+
+      if ( prefix )
       {
-         std::ostringstream os;
-
-         if ( m_fixed )
-         {
-            os << sign << std::fixed << std::setprecision(digits-1) << value << "e" << expof10;
-         }
-         else
-         {
-            os << sign << value << "e" << expof10;
-         }
-         m_magnitude = os.str();
+         m_unit = prefix;
       }
 
       m_unit += to_unit_symbol( q );
@@ -201,8 +288,6 @@ private:
 private:
    std::string m_magnitude;
    std::string m_unit;
-   bool m_fixed;
-   bool m_showpos;
 };
 
 } // namespace detail {
@@ -228,19 +313,59 @@ to_eng_unit( quantity const & q )
    return detail::eng_format( q ).unit();
 }
 
+/// @}
+
+namespace io {
+namespace eng {
+
 /**
- * convert given quantity to string as "{magnitude} ' ' {prefix}{symbol}".
+ * write quantity as "{magnitude} ' ' {prefix}{symbol}" to output iterator out;
+ * return the iterator past the last character written.
  */
-inline std::string
-to_eng_string( quantity const & q, int const digits = 6, bool const showpos = false )
+template <typename OutputIt>
+inline OutputIt
+format_to( OutputIt out, quantity const & q, int const digits = 6, bool const showpos = false )
 {
-   return detail::eng_format( q, digits, showpos ).repr();
+   PHYS_UNITS_STATS_ADD( formats, 1 );
+
+   return detail::format_eng_to( out, q.value(),
+      detail::cached_unit_symbol( q.dimension(), name_symbol() ), q.dimension(),
+      detail::allows_eng_prefix( q.dimension() ), digits, showpos );
 }
 
-/// @}
+/**
+ * write quantity as "{magnitude} ' ' {prefix}{symbol}" to buffer buf of size n,
+ * truncated and null-terminated like snprintf(); return the length of the
+ * complete text, excluding the terminating null.
+ */
+inline std::size_t
+format_to( char * buf, std::size_t n, quantity const & q, int const digits = 6, bool const showpos = false )
+{
+   return format_to( detail::bounded_output( buf, n ), q, digits, showpos ).terminate();
+}
 
-namespace io {
-namespace eng {
+/**
+ * write all elements of array as "{magnitude} ' ' {prefix}{symbol}" to output
+ * iterator out, each followed by separator; the symbol and the use of a prefix
+ * are determined once for the array. Return the iterator past the last character written.
+ */
+template <typename OutputIt>
+inline OutputIt
+format_to( OutputIt out, quantity_array const & a, char const separator = '\n', int const digits = 6, bool const showpos = false )
+{
+   detail::symbol_cache_entry const * const symbol = detail::cached_unit_symbol( a.dimension(), name_symbol() );
+
+   bool const use_prefix = detail::allows_eng_prefix( a.dimension() );
+
+   PHYS_UNITS_STATS_ADD( formats, a.size() );
+
+   for ( quantity_array::const_iterator pos = a.begin(); pos != a.end(); ++pos )
+   {
+      out = detail::format_eng_to( out, *pos, symbol, a.dimension(), use_prefix, digits, showpos );
+      *out++ = separator;
+   }
+   return out;
+}
 
 /**
  * convert given quantity to string as "{magnitude} ' ' {prefix}{symbol}".
@@ -248,7 +373,11 @@ namespace eng {
 inline std::string
 to_string( quantity const & q, int const digits = 6, bool const showpos = false )
 {
-   return to_eng_string( q, digits, showpos );
+   PHYS_UNITS_LATENCY_SCOPE( to_eng_string );
+
+   std::string result;
+   format_to( std::back_inserter( result ), q, digits, showpos );
+   return result;
 }
 
 /**
@@ -262,6 +391,20 @@ inline std::ostream & operator<<( std::ostream & os, quantity const & q )
 } // namespace eng
 } // namespace io
 
+/** \name Quantity, convert quantity to text in engineering format */
+/// @{
+
+/**
+ * convert given quantity to string as "{magnitude} ' ' {prefix}{symbol}".
+ */
+inline std::string
+to_eng_string( quantity const & q, int const digits = 6, bool const showpos = false )
+{
+   return io::eng::to_string( q, digits, showpos );
+}
+
+/// @}
+
 }}} // namespace units { namespace phys { namespace rt {
 
 #endif // PHYS_UNITS_IO_OUTPUT_ENG_HPP_INCLUDED
@@ -0,0 +1,467 @@
+/**
+ * \file latency.hpp
+ *
+ * \brief   Optional latency histograms of parsing and formatting.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * When compiled with PHYS_UNITS_LATENCY defined, the durations of
+ * quantity_parser parsing, to_unit_symbol(), io::to_string() and
+ * to_eng_string() are recorded in a histogram per operation and thread.
+ * A thread only writes its own histograms, without locking; a snapshot sums
+ * those of all threads. Reset stores the current sums as the new origin, so
+ * it does not write to histograms of other threads either.
+ *
+ * The buckets are log-linear as in HdrHistogram: values below 32 ns have a
+ * bucket each, above that each power of two has 16 buckets, so that a
+ * reported value is within 6.25% of the measured one.
+ */
+
+#ifndef PHYS_UNITS_LATENCY_HPP_INCLUDED
+#define PHYS_UNITS_LATENCY_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+
+#include <cstdio>
+#include <string>
+
+#ifdef PHYS_UNITS_LATENCY
+# ifdef _WIN32
+#  ifndef NOMINMAX
+#   define NOMINMAX      // keep std::min() and std::max() usable
+#  endif
+#  include <windows.h>
+# else
+#  include <time.h>
+# endif
+#endif
+
+/**
+ * \def PHYS_UNITS_LATENCY
+ * define to record latency histograms of parsing and formatting, see
+ * latency_snapshot(); not defined by default.
+ */
+
+/**
+ * \def PHYS_UNITS_LATENCY_SCOPE
+ * record the duration of the enclosing scope for the given operation;
+ * nothing without PHYS_UNITS_LATENCY.
+ */
+#ifdef PHYS_UNITS_LATENCY
+# define PHYS_UNITS_LATENCY_SCOPE( op ) \
+    ::rt::phys::units::detail::latency_scope PHYS_UNITS_CONCATENATE( latency_scope_, __LINE__ )( ::rt::phys::units::latency_##op )
+#else
+# define PHYS_UNITS_LATENCY_SCOPE( op )
+#endif
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * the operations of which the latency is recorded.
+ */
+enum latency_operation
+{
+    latency_parse,                      ///< quantity_parser parse() and try_parse()
+    latency_unit_symbol,                ///< to_unit_symbol()
+    latency_to_string,                  ///< io::to_string()
+    latency_to_eng_string,              ///< to_eng_string(), io::eng::to_string()
+    latency_operation_count
+};
+
+/**
+ * the name of operation op, e.g. "parse".
+ */
+inline char const * to_string( latency_operation op )
+{
+    static char const * const names[] = { "parse", "unit_symbol", "to_string", "to_eng_string" };
+
+    return op < latency_operation_count ? names[op] : "unknown";
+}
+
+/**
+ * log-linear histogram of durations in nanoseconds.
+ */
+struct latency_histogram
+{
+    enum
+    {
+        sub_bits     = 4,                           ///< 16 buckets per power of two
+        sub_count    = 1 << sub_bits,
+        max_bits     = 32,                          ///< durations up to 4.29 s
+        bucket_count = ( max_bits - sub_bits + 1 ) * sub_count
+    };
+
+    unsigned long counts[ bucket_count ];           ///< number of durations per bucket
+    double total;                                   ///< sum of the durations [ns]
+
+    /**
+     * the bucket of a duration of ns nanoseconds.
+     */
+    static int bucket( double const ns )
+    {
+        if ( ns < 2 * sub_count )
+        {
+            return ns > 0 ? static_cast<int>( ns ) : 0;
+        }
+
+        if ( ns >= 4294967295.0 )
+        {
+            return bucket_count - 1;
+        }
+
+        unsigned long const v = static_cast<unsigned long>( ns );
+
+        int e = sub_bits + 1;
+        while ( e + 1 < max_bits && ( v >> ( e + 1 ) ) )
+        {
+            ++e;
+        }
+
+        return ( e - sub_bits + 1 ) * sub_count + static_cast<int>( ( v >> ( e - sub_bits ) ) & ( sub_count - 1 ) );
+    }
+
+    /**
+     * the smallest duration of bucket i [ns].
+     */
+    static double lowest( int const i )
+    {
+        if ( i < 2 * sub_count )
+        {
+            return i;
+        }
+
+        int const e = i / sub_count + sub_bits - 1;
+
+        return double( ( sub_count + i % sub_count ) ) * double( 1UL << ( e - sub_bits ) );
+    }
+
+    /**
+     * the largest duration of bucket i [ns].
+     */
+    static double highest( int const i )
+    {
+        return i + 1 < bucket_count ? lowest( i + 1 ) - 1 : lowest( i );
+    }
+
+    /**
+     * record a duration of ns nanoseconds.
+     */
+    void record( double const ns )
+    {
+        ++counts[ bucket( ns ) ];
+        total += ns;
+    }
+
+    /**
+     * the number of durations recorded.
+     */
+    unsigned long count() const
+    {
+        unsigned long n = 0;
+        for ( int i = 0; i < bucket_count; ++i )
+        {
+            n += counts[i];
+        }
+        return n;
+    }
+
+    /**
+     * the mean duration [ns], 0 if empty.
+     */
+    double mean() const
+    {
+        unsigned long const n = count();
+        return n ? total / n : 0;
+    }
+
+    /**
+     * the duration below which p percent of the durations lie [ns], as the
+     * largest duration of its bucket; 0 if empty.
+     */
+    double percentile( double const p ) const
+    {
+        unsigned long const n = count();
+
+        if ( 0 == n )
+        {
+            return 0;
+        }
+
+        double const rank = p / 100 * n;
+        unsigned long seen = 0;
+
+        for ( int i = 0; i < bucket_count; ++i )
+        {
+            seen += counts[i];
+
+            if ( counts[i] && seen >= rank )
+            {
+                return highest( i );
+            }
+        }
+        return max();
+    }
+
+    /**
+     * the largest duration, as the largest of its bucket [ns]; 0 if empty.
+     */
+    double max() const
+    {
+        for ( int i = bucket_count - 1; i >= 0; --i )
+        {
+            if ( counts[i] )
+            {
+                return highest( i );
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * add the counts of other.
+     */
+    latency_histogram & operator+=( latency_histogram const & other )
+    {
+        for ( int i = 0; i < bucket_count; ++i )
+        {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        return *this;
+    }
+
+    /**
+     * subtract the counts of other, e.g. of an earlier snapshot.
+     */
+    latency_histogram & operator-=( latency_histogram const & other )
+    {
+        for ( int i = 0; i < bucket_count; ++i )
+        {
+            counts[i] -= other.counts[i];
+        }
+        total -= other.total;
+        return *this;
+    }
+};
+
+namespace detail {
+
+#ifdef PHYS_UNITS_LATENCY
+
+/**
+ * the histograms of a thread, in the list of all threads' histograms.
+ */
+struct latency_block
+{
+    latency_histogram histograms[ latency_operation_count ];
+    latency_block * next;
+};
+
+/**
+ * head of the list of all threads' histograms.
+ */
+inline latency_block * volatile & latency_blocks()
+{
+    static latency_block * volatile head = 0;
+    return head;
+}
+
+/**
+ * the histograms of the current thread; created and listed on first use.
+ */
+inline latency_histogram * thread_histograms()
+{
+    static PHYS_UNITS_THREAD_LOCAL latency_block * block = 0;
+
+    if ( 0 == block )
+    {
+        latency_block * const b = new latency_block();
+        push_front( latency_blocks(), b );
+        block = b;
+    }
+    return block->histograms;
+}
+
+/**
+ * monotonic time [ns].
+ */
+inline double latency_now()
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return 1e9 * double( count.QuadPart ) / double( frequency.QuadPart );
+#else
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return 1e9 * ts.tv_sec + ts.tv_nsec;
+#endif
+}
+
+/**
+ * record the duration of its lifetime for an operation.
+ */
+class latency_scope
+{
+public:
+    explicit latency_scope( latency_operation op )
+    : m_op( op )
+    , m_start( latency_now() )
+    {
+    }
+
+    ~latency_scope()
+    {
+        thread_histograms()[ m_op ].record( latency_now() - m_start );
+    }
+
+private:
+    latency_scope( latency_scope const & );
+    latency_scope & operator=( latency_scope const & );
+
+    latency_operation m_op;
+    double m_start;
+};
+
+#endif // PHYS_UNITS_LATENCY
+
+/**
+ * the sums at the last reset, per operation.
+ */
+inline latency_histogram * latency_origin()
+{
+    static latency_histogram origin[ latency_operation_count ];
+    return origin;
+}
+
+/**
+ * the sum of the histograms of all threads for operation op.
+ */
+inline latency_histogram latency_sum( latency_operation op )
+{
+    latency_histogram sum = latency_histogram();
+#ifdef PHYS_UNITS_LATENCY
+    for ( latency_block const * b = latency_blocks(); b; b = b->next )
+    {
+        sum += b->histograms[ op ];
+    }
+#else
+    (void) op;
+#endif
+    return sum;
+}
+
+} // namespace detail
+
+/**
+ * true if compiled with PHYS_UNITS_LATENCY, so that latencies are recorded.
+ */
+inline bool latency_enabled()
+{
+#ifdef PHYS_UNITS_LATENCY
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * the histogram of operation op of all threads since the last reset; empty
+ * without PHYS_UNITS_LATENCY. Recordings of threads that run may lag slightly.
+ */
+inline latency_histogram latency_snapshot( latency_operation op )
+{
+    latency_histogram h = detail::latency_sum( op );
+    h -= detail::latency_origin()[ op ];
+    return h;
+}
+
+/**
+ * start new histograms for all operations; call from one thread at a time.
+ */
+inline void latency_reset()
+{
+    for ( int op = 0; op < latency_operation_count; ++op )
+    {
+        detail::latency_origin()[ op ] = detail::latency_sum( latency_operation( op ) );
+    }
+}
+
+/**
+ * a table of count, mean, percentiles and maximum per operation [ns].
+ */
+inline std::string latency_report()
+{
+    char line[ 160 ];
+
+    std::sprintf( line, "%-14s %10s %10s %10s %10s %10s %10s %10s\n",
+        "operation", "count", "mean", "p50", "p90", "p99", "p99.9", "max" );
+
+    std::string result( line );
+
+    for ( int op = 0; op < latency_operation_count; ++op )
+    {
+        latency_histogram const h = latency_snapshot( latency_operation( op ) );
+
+        std::sprintf( line, "%-14s %10lu %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f\n",
+            to_string( latency_operation( op ) ), h.count(), h.mean(),
+            h.percentile( 50 ), h.percentile( 90 ), h.percentile( 99 ), h.percentile( 99.9 ), h.max() );
+
+        result += line;
+    }
+    return result;
+}
+
+/**
+ * the histograms as JSON: per operation count, mean, percentiles and maximum
+ * [ns], and the non-empty buckets as [lowest, highest, count].
+ */
+inline std::string latency_report_json()
+{
+    char buf[ 200 ];
+    std::string result( "{" );
+
+    for ( int op = 0; op < latency_operation_count; ++op )
+    {
+        latency_histogram const h = latency_snapshot( latency_operation( op ) );
+
+        std::sprintf( buf, "%s\"%s\":{\"count\":%lu,\"mean_ns\":%.1f,\"p50_ns\":%.0f,\"p90_ns\":%.0f,\"p99_ns\":%.0f,\"p999_ns\":%.0f,\"max_ns\":%.0f,\"buckets\":[",
+            op ? "," : "", to_string( latency_operation( op ) ), h.count(), h.mean(),
+            h.percentile( 50 ), h.percentile( 90 ), h.percentile( 99 ), h.percentile( 99.9 ), h.max() );
+
+        result += buf;
+
+        bool first = true;
+
+        for ( int i = 0; i < latency_histogram::bucket_count; ++i )
+        {
+            if ( h.counts[i] )
+            {
+                std::sprintf( buf, "%s[%.0f,%.0f,%lu]", first ? "" : ",",
+                    latency_histogram::lowest( i ), latency_histogram::highest( i ), h.counts[i] );
+                result += buf;
+                first = false;
+            }
+        }
+        result += "]}";
+    }
+    return result + "}";
+}
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_LATENCY_HPP_INCLUDED
+
+/*
+ * end of file
+ */
@@ -0,0 +1,211 @@
+/**
+ * \file mapped_file.hpp
+ *
+ * \brief   Read-only memory mapping of a file.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef PHYS_UNITS_MAPPED_FILE_HPP_INCLUDED
+#define PHYS_UNITS_MAPPED_FILE_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX      // keep std::min() and std::max() usable
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * file error, for example when a file cannot be opened or mapped.
+ */
+struct file_error : public quantity_error
+{
+    file_error( std::string const text )
+    : quantity_error( text )
+    {
+    }
+};
+
+/**
+ * read-only mapping of a whole file into memory; the mapping is page aligned.
+ */
+class mapped_file
+{
+public:
+    /**
+     * map file at path; throws file_error on failure.
+     */
+    explicit mapped_file( std::string const & path )
+    : m_data( 0 )
+    , m_size( 0 )
+#ifdef _WIN32
+    , m_file( INVALID_HANDLE_VALUE )
+    , m_mapping( 0 )
+#endif
+    {
+        if ( ! open( path ) )
+        {
+            close();
+            PHYS_UNITS_THROW( file_error( "quantity: cannot map file '" + path + "'" ) );
+        }
+    }
+
+    /**
+     * unmap file.
+     */
+    ~mapped_file()
+    {
+        close();
+    }
+
+    /**
+     * the mapped bytes; 0 for an empty file.
+     */
+    unsigned char const * data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * the file size.
+     */
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    // non-copyable:
+    mapped_file( mapped_file const & );
+    mapped_file & operator=( mapped_file const & );
+
+#ifdef _WIN32
+    bool open( std::string const & path )
+    {
+        m_file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+
+        if ( INVALID_HANDLE_VALUE == m_file )
+        {
+            return false;
+        }
+
+        LARGE_INTEGER size;
+
+        if ( ! GetFileSizeEx( m_file, &size ) )
+        {
+            return false;
+        }
+
+        m_size = static_cast<std::size_t>( size.QuadPart );
+
+        if ( 0 == m_size )
+        {
+            return true;
+        }
+
+        m_mapping = CreateFileMappingA( m_file, 0, PAGE_READONLY, 0, 0, 0 );
+
+        if ( 0 == m_mapping )
+        {
+            return false;
+        }
+
+        m_data = static_cast<unsigned char const *>( MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+
+        return 0 != m_data;
+    }
+
+    void close()
+    {
+        if ( m_data    ) UnmapViewOfFile( m_data );
+        if ( m_mapping ) CloseHandle( m_mapping );
+        if ( INVALID_HANDLE_VALUE != m_file ) CloseHandle( m_file );
+
+        m_data    = 0;
+        m_mapping = 0;
+        m_file    = INVALID_HANDLE_VALUE;
+    }
+#else
+    bool open( std::string const & path )
+    {
+        int const fd = ::open( path.c_str(), O_RDONLY );
+
+        if ( fd < 0 )
+        {
+            return false;
+        }
+
+        struct stat st;
+
+        if ( 0 != ::fstat( fd, &st ) )
+        {
+            ::close( fd );
+            return false;
+        }
+
+        m_size = static_cast<std::size_t>( st.st_size );
+
+        if ( 0 == m_size )
+        {
+            ::close( fd );
+            return true;
+        }
+
+        void * const p = ::mmap( 0, m_size, PROT_READ, MAP_SHARED, fd, 0 );
+
+        ::close( fd );
+
+        if ( MAP_FAILED == p )
+        {
+            return false;
+        }
+
+        m_data = static_cast<unsigned char const *>( p );
+        return true;
+    }
+
+    void close()
+    {
+        if ( m_data )
+        {
+            ::munmap( const_cast<unsigned char *>( m_data ), m_size );
+        }
+        m_data = 0;
+    }
+#endif
+
+    unsigned char const * m_data;   ///< mapped bytes
+    std::size_t m_size;             ///< file size
+#ifdef _WIN32
+    HANDLE m_file;                  ///< file handle
+    HANDLE m_mapping;               ///< file mapping handle
+#endif
+};
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_MAPPED_FILE_HPP_INCLUDED
+
+/*
+ * end of file
+ */
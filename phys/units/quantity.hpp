@@ -33,14 +33,28 @@
 #define PHYS_UNITS_QUANTITY_HPP_INCLUDED
 
 #include <cmath>        // for pow()
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <typeinfo>
 #include <vector>
 
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX      // keep std::min() and std::max() usable
+# endif
+# include <windows.h>  // for QueryPerformanceCounter()
+#else
+# include <time.h>      // for clock_gettime()
+#endif
+
 /**
  * number of SI base dimensions (7).
  */
@@ -90,7 +104,87 @@
 # endif
 #endif
 
-#if defined( PHYS_UNITS_COMPILER_IS_MSVC ) || defined( PHYS_UNITS_COMPILER_IS_MWERKS )
+/**
+ * \def PHYS_UNITS_THREAD_LOCAL
+ * storage class specifier for per-thread variables of plain-old-data type.
+ */
+#ifndef PHYS_UNITS_THREAD_LOCAL
+# if defined( PHYS_UNITS_COMPILER_IS_MSVC )
+#  define PHYS_UNITS_THREAD_LOCAL __declspec( thread )
+# elif defined( PHYS_UNITS_COMPILER_IS_GNUC )
+#  define PHYS_UNITS_THREAD_LOCAL __thread
+# else
+#  define PHYS_UNITS_THREAD_LOCAL
+# endif
+#endif
+
+/**
+ * \def PHYS_UNITS_NORETURN
+ * mark function as not returning.
+ */
+#ifndef PHYS_UNITS_NORETURN
+# if defined( PHYS_UNITS_COMPILER_IS_GNUC )
+#  define PHYS_UNITS_NORETURN __attribute__(( noreturn ))
+# elif defined( PHYS_UNITS_COMPILER_IS_MSVC )
+#  define PHYS_UNITS_NORETURN __declspec( noreturn )
+# else
+#  define PHYS_UNITS_NORETURN
+# endif
+#endif
+
+/**
+ * \def PHYS_UNITS_NO_EXCEPTIONS
+ * defined if compiling without exception support, e.g. with -fno-exceptions.
+ */
+#ifndef PHYS_UNITS_NO_EXCEPTIONS
+# if defined( PHYS_UNITS_COMPILER_IS_GNUC ) && !defined( __EXCEPTIONS )
+#  define PHYS_UNITS_NO_EXCEPTIONS
+# elif defined( PHYS_UNITS_COMPILER_IS_MSVC ) && !defined( _CPPUNWIND )
+#  define PHYS_UNITS_NO_EXCEPTIONS
+# endif
+#endif
+
+/**
+ * \def PHYS_UNITS_THROW
+ * throw given error; without exceptions, report it to the error handler and abort.
+ */
+#ifdef PHYS_UNITS_NO_EXCEPTIONS
+# define PHYS_UNITS_THROW( x )  ::rt::phys::units::detail::throw_error( ::rt::phys::units::detail::traced_error( x ) )
+#else
+# define PHYS_UNITS_THROW( x )  throw ::rt::phys::units::detail::traced_error( x )
+#endif
+
+/**
+ * \def PHYS_UNITS_STATS
+ * define to count allocations, dimension checks, parses, registry lookups
+ * and formatting calls per thread, see stats(); not defined by default.
+ */
+
+/**
+ * \def PHYS_UNITS_STATS_ADD
+ * add n to the given counter of the current thread; nothing without PHYS_UNITS_STATS.
+ */
+#ifdef PHYS_UNITS_STATS
+# define PHYS_UNITS_STATS_ADD( counter, n )  ( ::rt::phys::units::detail::thread_counters().counter += ( n ) )
+#else
+# define PHYS_UNITS_STATS_ADD( counter, n )  ( (void) 0 )
+#endif
+
+#if defined( PHYS_UNITS_STATS ) || defined( PHYS_UNITS_LATENCY )
+# define PHYS_UNITS_PER_THREAD_BLOCKS
+# ifdef PHYS_UNITS_COMPILER_IS_MSVC
+#  include <intrin.h>
+# endif
+#endif
+
+/**
+ * \def PHYS_UNITS_STATS_NEW_DIMENSIONS
+ * count the construction of a dimensions object and its allocation.
+ */
+#define PHYS_UNITS_STATS_NEW_DIMENSIONS()  ( PHYS_UNITS_STATS_ADD( dimensions, 1 ), PHYS_UNITS_STATS_ADD( allocations, 1 ) )
+
+// <windows.h>, included for trace_now(), defines pascal also for MinGW:
+#if defined( PHYS_UNITS_COMPILER_IS_MSVC ) || defined( PHYS_UNITS_COMPILER_IS_MWERKS ) || defined( pascal )
 # define PHYS_UNITS_NO_PASCAL_IDENTIFIER
 #endif
 
@@ -147,17 +241,486 @@ namespace rt { namespace phys { namespace units {
     typedef double Rep;
 #endif
 
+/**
+ * operation and allocation counts; see stats().
+ */
+struct stats_counters
+{
+    unsigned long allocations;          ///< heap allocations of dimensions and quantity_array storage
+    unsigned long dimensions;           ///< dimensions objects constructed, each allocates
+    unsigned long dimension_checks;     ///< dimension checks performed
+    unsigned long dimension_mismatches; ///< dimension checks that failed
+    unsigned long parses;               ///< texts parsed
+    unsigned long lookups;              ///< unit, unit name and prefix registry lookups
+    unsigned long formats;              ///< quantities and unit symbols formatted
+};
+
+/**
+ * the counts of a minus those of b, e.g. of a code path: stats() after minus before.
+ */
+inline stats_counters operator-( stats_counters const & a, stats_counters const & b )
+{
+    stats_counters r = a;
+
+    r.allocations          -= b.allocations;
+    r.dimensions           -= b.dimensions;
+    r.dimension_checks     -= b.dimension_checks;
+    r.dimension_mismatches -= b.dimension_mismatches;
+    r.parses               -= b.parses;
+    r.lookups              -= b.lookups;
+    r.formats              -= b.formats;
+
+    return r;
+}
+
+/**
+ * add the counts of b to a.
+ */
+inline stats_counters & operator+=( stats_counters & a, stats_counters const & b )
+{
+    a.allocations          += b.allocations;
+    a.dimensions           += b.dimensions;
+    a.dimension_checks     += b.dimension_checks;
+    a.dimension_mismatches += b.dimension_mismatches;
+    a.parses               += b.parses;
+    a.lookups              += b.lookups;
+    a.formats              += b.formats;
+
+    return a;
+}
+
+/**
+ * format counts as "allocations: 2, dimensions: 2, ...".
+ */
+inline std::string to_string( stats_counters const & c )
+{
+    std::ostringstream os;
+    os <<
+        "allocations: "            << c.allocations <<
+        ", dimensions: "           << c.dimensions <<
+        ", dimension checks: "     << c.dimension_checks <<
+        ", dimension mismatches: " << c.dimension_mismatches <<
+        ", parses: "               << c.parses <<
+        ", lookups: "              << c.lookups <<
+        ", formats: "              << c.formats;
+    return os.str();
+}
+
+#ifdef PHYS_UNITS_PER_THREAD_BLOCKS
+
+namespace detail {
+
+/**
+ * add block in front of the list at head, atomically; used for lists of
+ * per-thread blocks, which are added, never removed.
+ */
+template <typename Block>
+inline void push_front( Block * volatile & head, Block * block )
+{
+    Block * expected = 0;
+
+    for ( ;; )
+    {
+        expected = head;
+        block->next = expected;
+
+#if defined( PHYS_UNITS_COMPILER_IS_GNUC )
+        if ( expected == __sync_val_compare_and_swap( &head, expected, block ) )
+#elif defined( PHYS_UNITS_COMPILER_IS_MSVC ) && !defined( PHYS_UNITS_COMPILER_IS_MSVC6 )
+        if ( expected == _InterlockedCompareExchangePointer(
+            reinterpret_cast<void * volatile *>( &head ), block, expected ) )
+#else
+        head = block;
+#endif
+        {
+            return;
+        }
+    }
+}
+
+} // namespace detail
+
+#endif // PHYS_UNITS_PER_THREAD_BLOCKS
+
+#ifdef PHYS_UNITS_STATS
+
+namespace detail {
+
+/**
+ * the counters of a thread, in the list of all threads' counters.
+ */
+struct stats_block
+{
+    stats_counters counters;
+    stats_block * next;
+};
+
+/**
+ * head of the list of all threads' counters.
+ */
+inline stats_block * volatile & stats_blocks()
+{
+    static stats_block * volatile head = 0;
+    return head;
+}
+
+/**
+ * the counters of the current thread; created and listed on first use.
+ * The counters of a thread outlive it, so that stats() includes its counts.
+ */
+inline stats_counters & thread_counters()
+{
+    static PHYS_UNITS_THREAD_LOCAL stats_block * block = 0;
+
+    if ( 0 == block )
+    {
+        stats_block * const b = new stats_block();
+        push_front( stats_blocks(), b );
+        block = b;
+    }
+    return block->counters;
+}
+
+} // namespace detail
+
+#endif // PHYS_UNITS_STATS
+
+/**
+ * true if compiled with PHYS_UNITS_STATS, so that operations are counted.
+ */
+inline bool stats_enabled()
+{
+#ifdef PHYS_UNITS_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * the counts of the current thread; all zero without PHYS_UNITS_STATS.
+ */
+inline stats_counters thread_stats()
+{
+#ifdef PHYS_UNITS_STATS
+    return detail::thread_counters();
+#else
+    return stats_counters();
+#endif
+}
+
+/**
+ * the counts of all threads, including those that ended; all zero without
+ * PHYS_UNITS_STATS. Counts of threads that run may lag slightly.
+ */
+inline stats_counters stats()
+{
+    stats_counters total = stats_counters();
+#ifdef PHYS_UNITS_STATS
+    for ( detail::stats_block const * b = detail::stats_blocks(); b; b = b->next )
+    {
+        total += b->counters;
+    }
+#endif
+    return total;
+}
+
+/**
+ * set the counts of the current thread to zero.
+ */
+inline void reset_thread_stats()
+{
+#ifdef PHYS_UNITS_STATS
+    detail::thread_counters() = stats_counters();
+#endif
+}
+
+/**
+ * error codes of the non-throwing interface (try_parse(), try_add(), ...).
+ */
+struct errc
+{
+    enum type
+    {
+        ok = 0,                         ///< no error
+        incompatible_dimension,         ///< operands with different dimensions
+        undefined_unit,                 ///< unit not found
+        extension_table_full,           ///< no extension dimension left for new unit
+        parse_garbage,                  ///< unexpected text after quantity
+        parse_consecutive_operators,    ///< two operators in a row
+        parse_repeated_solidus,         ///< a/b/c
+        parse_expecting_reciprocal,     ///< "1" not followed by "/"
+        parse_expecting_unit,           ///< missing unit
+        parse_expecting_character,      ///< missing character, e.g. ')'
+        parse_expecting_operand,        ///< missing operand in formula
+        undefined_name,                 ///< formula name that is no column
+        uneven_dimension,               ///< root of a dimension that is no even multiple
+        exponent_out_of_range           ///< dimension exponent beyond dimensions::value_type
+    };
+};
+
+/**
+ * compact description of an error: code, input position and, for dimension
+ * errors, the dimensions involved. The message is only rendered on request.
+ */
+struct error_info
+{
+    /**
+     * message rendering function type: error and input text, if any.
+     */
+    typedef std::string (*render_function)( error_info const & e, std::string const & input );
+
+    errc::type code;            //< error code
+    int position;               //< input position, 0 if not applicable
+    int extent;                 //< length of offending input, e.g. unit name
+    char expected;              //< expected character
+    char const * text;          //< operation, e.g. "operator+" (static storage)
+    render_function render;     //< message rendering function
+    signed char lhs[ 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT ];   //< lhs dimension exponents
+    signed char rhs[ 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT ];   //< rhs dimension exponents
+};
+
 /**
  * quantity error base class.
+ *
+ * An error constructed from an error_info renders its message on the first
+ * call of what(), so that code that catches and retries pays little per failure.
  */
 struct quantity_error : public std::runtime_error
 {
     quantity_error( std::string const text )
     : std::runtime_error( text )
+    , m_info( )
+    , m_input( )
+    , m_what( )
     {
     }
+
+    /**
+     * constructor for lazily rendered message; input is the text the error refers to, if any.
+     */
+    quantity_error( error_info const & info, std::string const & input = std::string() )
+    : std::runtime_error( std::string() )
+    , m_info( info )
+    , m_input( input )
+    , m_what( )
+    {
+    }
+
+    // corect for  g++ error: looser throw specifier:
+    ~quantity_error() throw() {}
+
+    /**
+     * the error message; rendered on first access for lazily constructed errors.
+     */
+    char const * what() const throw()
+    {
+        if ( errc::ok == m_info.code )
+        {
+            return std::runtime_error::what();
+        }
+
+        if ( m_what.empty() )
+        {
+#ifdef PHYS_UNITS_NO_EXCEPTIONS
+            m_what = m_info.render( m_info, m_input );
+#else
+            try
+            {
+                m_what = m_info.render( m_info, m_input );
+            }
+            catch ( ... )
+            {
+                return "quantity: error (no memory for message)";
+            }
+#endif
+        }
+        return m_what.c_str();
+    }
+
+    /**
+     * the error code; errc::ok for errors constructed from a message.
+     */
+    errc::type code() const
+    {
+        return m_info.code;
+    }
+
+    /**
+     * the error information; code is errc::ok for errors constructed from a message.
+     */
+    error_info const & info() const
+    {
+        return m_info;
+    }
+
+private:
+    error_info m_info;              ///< error information, if any
+    std::string m_input;            ///< text the error refers to
+    mutable std::string m_what;     ///< rendered message
 };
 
+#ifdef PHYS_UNITS_NO_EXCEPTIONS
+
+/**
+ * handler for errors when compiled without exceptions; it should not return.
+ */
+typedef void (*error_handler)( quantity_error const & e );
+
+namespace detail {
+
+/**
+ * the error handler for use without exceptions.
+ */
+inline error_handler & get_error_handler()
+{
+    static error_handler handler = 0;
+    return handler;
+}
+
+/**
+ * report error to the error handler, or to stderr, and abort.
+ */
+PHYS_UNITS_NORETURN inline void throw_error( quantity_error const & e )
+{
+    if ( error_handler handler = get_error_handler() )
+    {
+        handler( e );
+    }
+    std::fprintf( stderr, "%s\n", e.what() );
+    std::abort();
+}
+
+} // namespace detail
+
+/**
+ * set the error handler for use without exceptions, return the previous one.
+ */
+inline error_handler set_error_handler( error_handler handler )
+{
+    error_handler const previous = detail::get_error_handler();
+    detail::get_error_handler() = handler;
+    return previous;
+}
+
+#endif // PHYS_UNITS_NO_EXCEPTIONS
+
+/**
+ * traced operations, see set_trace_hook().
+ */
+struct trace_op
+{
+    enum type
+    {
+        dimension_mismatch,             ///< dimension check failed: text is the operation
+        define_unit,                    ///< extension unit defined: text is its name
+        define_unit_name,               ///< unit name defined: text is the name
+        cache_miss,                     ///< unit_cache parsed a unit: text is the unit text
+        error                           ///< error thrown: text is the operation or message
+    };
+};
+
+/**
+ * compact record of a traced event; text and error are valid during the call only.
+ */
+struct trace_event
+{
+    trace_op::type op;                  //< operation
+    char const * text;                  //< operation, unit name or unit text
+    signed char lhs[ 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT ];   //< dimension exponents, e.g. of defined unit
+    signed char rhs[ 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT ];   //< other dimension exponents of a mismatch
+    double timestamp;                   //< monotonic time [ns]
+    quantity_error const * error;       //< error thrown, 0 for other events
+};
+
+/**
+ * hook that receives trace events; it should not throw.
+ */
+typedef void (*trace_hook)( trace_event const & e );
+
+namespace detail {
+
+/**
+ * the trace hook, shared by all threads.
+ */
+inline trace_hook & get_trace_hook()
+{
+    static trace_hook hook = 0;
+    return hook;
+}
+
+/**
+ * monotonic time [ns], on the same clock as latency_now().
+ */
+inline double trace_now()
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return 1e9 * double( count.QuadPart ) / double( frequency.QuadPart );
+#else
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return 1e9 * ts.tv_sec + ts.tv_nsec;
+#endif
+}
+
+/**
+ * an event of given operation and text, without dimensions.
+ */
+inline trace_event make_trace_event( trace_op::type op, char const * text )
+{
+    trace_event e;
+
+    e.op        = op;
+    e.text      = text;
+    e.timestamp = trace_now();
+    e.error     = 0;
+
+    std::fill( e.lhs, e.lhs + PHYS_UNITS_DIMENSION_OF( e.lhs ), static_cast<signed char>( 0 ) );
+    std::fill( e.rhs, e.rhs + PHYS_UNITS_DIMENSION_OF( e.rhs ), static_cast<signed char>( 0 ) );
+
+    return e;
+}
+
+/**
+ * report error to the trace hook, if any, and return it for throwing.
+ */
+template <typename Error>
+inline Error const & traced_error( Error const & x )
+{
+    if ( trace_hook const hook = get_trace_hook() )
+    {
+        quantity_error const & error = x;
+        error_info const & info = error.info();
+
+        trace_event e = make_trace_event( trace_op::error, errc::ok == info.code ? error.what() : info.text );
+
+        std::copy( info.lhs, info.lhs + PHYS_UNITS_DIMENSION_OF( info.lhs ), e.lhs );
+        std::copy( info.rhs, info.rhs + PHYS_UNITS_DIMENSION_OF( info.rhs ), e.rhs );
+        e.error = &error;
+
+        hook( e );
+    }
+    return x;
+}
+
+} // namespace detail
+
+/**
+ * set the hook that receives trace events of dimension mismatches, unit
+ * definitions, unit_cache misses and thrown errors; 0 removes it. Returns the
+ * previous hook. The hook is called on the thread of the event; set it
+ * before other threads use the library.
+ */
+inline trace_hook set_trace_hook( trace_hook hook )
+{
+    trace_hook const previous = detail::get_trace_hook();
+    detail::get_trace_hook() = hook;
+    return previous;
+}
+
 /**
  * bad quantity cast error.
  */
@@ -178,6 +741,11 @@ struct dimension_error : public quantity_error
     : quantity_error( text )
     {
     }
+
+    dimension_error( error_info const & info, std::string const & input = std::string() )
+    : quantity_error( info, input )
+    {
+    }
 };
 
 /**
@@ -197,14 +765,55 @@ public:
     dimensions()
     : d( 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT )
     {
+        PHYS_UNITS_STATS_NEW_DIMENSIONS();
     }
 
+#ifdef PHYS_UNITS_STATS
+    /**
+     * copy constructor, counted.
+     */
+    dimensions( dimensions const & other )
+    : d( other.d )
+    {
+        PHYS_UNITS_STATS_NEW_DIMENSIONS();
+    }
+
+    /**
+     * assignment operator.
+     */
+    dimensions & operator=( dimensions const & other )
+    {
+        d = other.d;
+        return *this;
+    }
+
+# if __cplusplus >= 201103L
+    /**
+     * move constructor, does not allocate.
+     */
+    dimensions( dimensions && other )
+    : d( std::move( other.d ) )
+    {
+    }
+
+    /**
+     * move assignment operator.
+     */
+    dimensions & operator=( dimensions && other )
+    {
+        d.swap( other.d );
+        return *this;
+    }
+# endif
+#endif
+
     /**
      * constructor to set a specific unit.
      */
     explicit dimensions( int const n, int const v )
     : d( 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT )
     {
+        PHYS_UNITS_STATS_NEW_DIMENSIONS();
         d[n] = static_cast<value_type>( v );
     }
 
@@ -217,6 +826,8 @@ public:
     )
     : d( 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT )
     {
+        PHYS_UNITS_STATS_NEW_DIMENSIONS();
+
         d[ 0] = static_cast<value_type>( _1 );
         d[ 1] = static_cast<value_type>( _2 );
         d[ 2] = static_cast<value_type>( _3 );
@@ -233,6 +844,8 @@ public:
     dimensions( dimensions const & other, int const from, int const to )
     : d( 7 + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT )
     {
+        PHYS_UNITS_STATS_NEW_DIMENSIONS();
+
         for ( int i = from; i < to; ++i )
         {
             d[i] = other.d[i];
@@ -366,7 +979,7 @@ public:
     {
         if ( ! is_all_even_multiples( N ) )
         {
-            throw dimension_error( "quantity: dimension should be even multiple" );
+            PHYS_UNITS_THROW( dimension_error( "quantity: dimension should be even multiple" ) );
         }
 
         dimensions r( *this );
@@ -387,93 +1000,395 @@ public:
     }
 
     /**
-     * the dimension implementation type.
+     * the dimension implementation type.
+     */
+    std::vector<value_type> d;
+
+private:
+    static bool is_non_zero( value_type const v )
+    {
+        return value_type(0) != v;
+    }
+
+    static bool is_non_even_multiple( value_type /*const*/ v, int /*const*/ N )
+    {
+        return value_type(0) != v % N;
+    }
+};
+
+/** \name Dimension, operations */
+/// @{
+
+/**
+ * dimension product.
+ */
+inline dimensions product( dimensions const & lhs, dimensions const & rhs )
+{
+    return lhs.product( rhs );
+}
+
+/**
+ * dimension quotient.
+ */
+inline dimensions quotient( dimensions const & lhs, dimensions const & rhs )
+{
+    return lhs.quotient( rhs );
+}
+
+/**
+ * reciprocal of dimension.
+ */
+inline dimensions reciprocal( dimensions const & lhs )
+{
+    return lhs.reciprocal();
+}
+
+/**
+ * integral power of dimension.
+ */
+inline dimensions power( dimensions const & lhs, int const N )
+{
+    return lhs.power( N );
+}
+
+/**
+ * integral root of dimension.
+ */
+inline dimensions root( dimensions const & lhs, int const N )
+{
+    return lhs.root( N );
+}
+/// @}
+
+/** \name Dimension, hashing */
+/// @{
+
+namespace detail {
+
+/**
+ * hash h extended with byte b (32-bit FNV-1a).
+ */
+inline unsigned long fnv1a( unsigned long const h, unsigned char const b )
+{
+    return ( ( h ^ b ) * 16777619UL ) & 0xffffffffUL;
+}
+
+} // namespace detail
+
+/**
+ * hash of dimension, the same on every platform; for unordered containers.
+ */
+inline std::size_t hash_value( dimensions const & d )
+{
+    unsigned long h = 2166136261UL;
+
+    for ( std::vector<dimensions::value_type>::const_iterator pos = d.d.begin(); pos != d.d.end(); ++pos )
+    {
+        h = detail::fnv1a( h, static_cast<unsigned char>( *pos ) );
+    }
+    return static_cast<std::size_t>( h );
+}
+
+/**
+ * dimension hash function object.
+ */
+struct dimensions_hash
+{
+    std::size_t operator()( dimensions const & d ) const
+    {
+        return hash_value( d );
+    }
+};
+/// @}
+
+/** \name Dimension, conversion to text */
+/// @{
+
+/**
+ * format dimension as string, for example "1,0,0,0,-1,\~".
+ */
+inline std::string to_string( dimensions const & d )
+{
+    std::ostringstream os;
+    std::copy( d.d.begin(), d.d.end(), std::ostream_iterator<int>( os, ",") );
+    return os.str();
+}
+/// @}
+
+namespace detail {
+
+/**
+ * copy dimension to raw exponents.
+ */
+inline void to_raw( dimensions const & d, dimensions::value_type * raw )
+{
+    std::copy( d.d.begin(), d.d.end(), raw );
+}
+
+/**
+ * dimension from raw exponents.
+ */
+inline dimensions from_raw( dimensions::value_type const * raw )
+{
+    dimensions d;
+    std::copy( raw, raw + d.d.size(), d.d.begin() );
+    return d;
+}
+
+/**
+ * message for error codes that need no further information.
+ */
+inline std::string render_error_code( error_info const & e, std::string const & /*input*/ )
+{
+    switch ( e.code )
+    {
+        case errc::ok:                          return "quantity: no error";
+        case errc::incompatible_dimension:      return "quantity: incompatible dimension";
+        case errc::undefined_unit:              return "quantity: undefined unit";
+        case errc::extension_table_full:        return "quantity: dimension extension table full";
+        case errc::parse_garbage:               return "quantity: garbage after quantity";
+        case errc::parse_consecutive_operators: return "quantity: consecutive operators";
+        case errc::parse_repeated_solidus:      return "quantity: repetition of solidus";
+        case errc::parse_expecting_reciprocal:  return "quantity: expecting 1/u construct";
+        case errc::parse_expecting_unit:        return "quantity: expecting unit";
+        case errc::parse_expecting_character:   return "quantity: expecting character";
+        case errc::parse_expecting_operand:     return "quantity: expecting operand";
+        case errc::undefined_name:              return "quantity: undefined name";
+        case errc::uneven_dimension:            return "quantity: dimension should be even multiple";
+        case errc::exponent_out_of_range:       return "quantity: dimension exponent out of range";
+    }
+    return "quantity: unknown error";
+}
+
+/**
+ * message for incompatible dimensions; the operation is e.text, or input if e.text is empty.
+ */
+inline std::string render_dimension_error( error_info const & e, std::string const & input )
+{
+    return std::string( "quantity: incompatible dimension in " ) + ( *e.text ? std::string( e.text ) : input ) +
+        ": lhs:" + to_string( from_raw( e.lhs ) ) + ", rhs:" + to_string( from_raw( e.rhs ) );
+}
+
+/**
+ * error information with given code; position, extent and expected are optional.
+ */
+inline error_info make_error( errc::type code, int position = 0, int extent = 0, char expected = '\0' )
+{
+    error_info e;
+
+    e.code     = code;
+    e.position = position;
+    e.extent   = extent;
+    e.expected = expected;
+    e.text     = "";
+    e.render   = render_error_code;
+
+    std::fill( e.lhs, e.lhs + PHYS_UNITS_DIMENSION_OF( e.lhs ), dimensions::value_type( 0 ) );
+    std::fill( e.rhs, e.rhs + PHYS_UNITS_DIMENSION_OF( e.rhs ), dimensions::value_type( 0 ) );
+
+    return e;
+}
+
+/**
+ * error information for incompatible dimensions in operation text.
+ */
+inline error_info make_dimension_error( char const * text, dimensions const & lhs, dimensions const & rhs )
+{
+    error_info e = make_error( errc::incompatible_dimension );
+
+    e.text   = text;
+    e.render = render_dimension_error;
+
+    to_raw( lhs, e.lhs );
+    to_raw( rhs, e.rhs );
+
+    return e;
+}
+
+/**
+ * report an event with dimension lhs and, for a mismatch, rhs to the trace hook, if any.
+ */
+inline void trace( trace_op::type op, char const * text, dimensions const & lhs, dimensions const & rhs = dimensions() )
+{
+    if ( trace_hook const hook = get_trace_hook() )
+    {
+        trace_event e = make_trace_event( op, text );
+
+        to_raw( lhs, e.lhs );
+        to_raw( rhs, e.rhs );
+
+        hook( e );
+    }
+}
+
+} // namespace detail
+
+/**
+ * incompatible dimensions error; the message is rendered on first access.
+ */
+struct incompatible_dimension_error : public dimension_error
+{
+    /**
+     * constructor; text must have static storage duration, e.g. "operator+".
      */
-    std::vector<value_type> d;
-
-private:
-    static bool is_non_zero( value_type const v )
+    incompatible_dimension_error( char const * const text, dimensions const & lhs, dimensions const & rhs )
+    : dimension_error( detail::make_dimension_error( text, lhs, rhs ) )
     {
-        return value_type(0) != v;
     }
 
-    static bool is_non_even_multiple( value_type /*const*/ v, int /*const*/ N )
+    /**
+     * constructor for operation text of any storage duration.
+     */
+    incompatible_dimension_error( std::string const & text, dimensions const & lhs, dimensions const & rhs )
+    : dimension_error( detail::make_dimension_error( "", lhs, rhs ), text )
     {
-        return value_type(0) != v % N;
     }
 };
 
-/** \name Dimension, operations */
-/// @{
+/**
+ * handler for dimension violations found while checking is (partly) disabled:
+ * operation text, lhs dimension and rhs dimension.
+ */
+typedef void (*dimension_violation_handler)( char const * text, dimensions const & lhs, dimensions const & rhs );
+
+namespace detail {
 
 /**
- * dimension product.
+ * per-thread dimension checking state.
  */
-inline dimensions product( dimensions const & lhs, dimensions const & rhs )
+struct check_state
 {
-    return lhs.product( rhs );
-}
+    bool unchecked;                         //< skip dimension checks
+    unsigned long sample_every;             //< while unchecked, check one in this many (0: none)
+    unsigned long countdown;                //< operations until next sampled check
+    dimension_violation_handler handler;    //< report sampled violations (0: throw)
+};
 
 /**
- * dimension quotient.
+ * the dimension checking state of the current thread.
  */
-inline dimensions quotient( dimensions const & lhs, dimensions const & rhs )
+inline check_state & get_check_state()
 {
-    return lhs.quotient( rhs );
+    static PHYS_UNITS_THREAD_LOCAL check_state state = { false, 0, 0, 0 };
+    return state;
 }
 
-/**
- * reciprocal of dimension.
- */
-inline dimensions reciprocal( dimensions const & lhs )
+/// operation text shim.
+inline char const * c_str( char const * const text )
 {
-    return lhs.reciprocal();
+    return text;
 }
 
-/**
- * integral power of dimension.
- */
-inline dimensions power( dimensions const & lhs, int const N )
+/// operation text shim.
+inline char const * c_str( std::string const & text )
 {
-    return lhs.power( N );
+    return text.c_str();
 }
 
 /**
- * integral root of dimension.
+ * check for same dimensions; throw incompatible_dimension_error if dimensions differ.
+ * Within an unchecked_scope, only sampled operations are checked and a violation
+ * is reported to the scope's handler, if any.
  */
-inline dimensions root( dimensions const & lhs, int const N )
+template <typename Text>
+inline void check_dimension( dimensions const & lhs, dimensions const & rhs, Text const & text )
 {
-    return lhs.root( N );
-}
-/// @}
+    check_state & state = get_check_state();
 
-/** \name Dimension, conversion to text */
-/// @{
+    if ( state.unchecked )
+    {
+        if ( 0 == state.sample_every || 0 != --state.countdown )
+        {
+            return;
+        }
+
+        state.countdown = state.sample_every;
+    }
+
+    PHYS_UNITS_STATS_ADD( dimension_checks, 1 );
+
+    if ( lhs != rhs )
+    {
+        PHYS_UNITS_STATS_ADD( dimension_mismatches, 1 );
+
+        trace( trace_op::dimension_mismatch, c_str( text ), lhs, rhs );
+
+        if ( state.unchecked && state.handler )
+        {
+            state.handler( c_str( text ), lhs, rhs );
+            return;
+        }
+
+        PHYS_UNITS_THROW( incompatible_dimension_error( text, lhs, rhs ) );
+    }
+}
 
 /**
- * format dimension as string, for example "1,0,0,0,-1,\~".
+ * check input, such as a row for a table, for same dimensions; throw
+ * incompatible_dimension_error if dimensions differ. Unlike check_dimension(),
+ * this check is also made within an unchecked_scope and does not count as a
+ * sampled operation.
  */
-inline std::string to_string( dimensions const & d )
+inline void require_dimension( dimensions const & lhs, dimensions const & rhs, char const * const text )
 {
-    std::ostringstream os;
-    std::copy( d.d.begin(), d.d.end(), std::ostream_iterator<int>( os, ",") );
-    return os.str();
+    if ( lhs != rhs )
+    {
+        trace( trace_op::dimension_mismatch, text, lhs, rhs );
+
+        PHYS_UNITS_THROW( incompatible_dimension_error( text, lhs, rhs ) );
+    }
 }
-/// @}
+
+} // namespace detail
 
 /**
- * incompatible dimensions error.
+ * scope guard that disables dimension checks of + - = and comparisons for the
+ * current thread, optionally verifying one in sample_every operations.
+ * A sampled violation is reported to handler, or thrown if handler is 0.
+ * The previous checking state is restored at the end of the scope.
+ *
+ * \code
+ * {
+ *     unchecked_scope guard( 1000, log_violation );
+ *     run_validated_model();
+ * }
+ * \endcode
  */
-struct incompatible_dimension_error : public dimension_error
+class unchecked_scope
 {
-    incompatible_dimension_error( std::string text, dimensions const & lhs, dimensions const & rhs )
-    : dimension_error(
-        (std::string("quantity: incompatible dimension in ") + text + ": lhs:" +
-            to_string(lhs) + ", rhs:" + to_string(rhs) ).c_str() )
+public:
+    explicit unchecked_scope( unsigned long sample_every = 0, dimension_violation_handler handler = 0 )
+    : m_saved( detail::get_check_state() )
+    {
+        detail::check_state & state = detail::get_check_state();
+
+        state.unchecked    = true;
+        state.sample_every = sample_every;
+        state.countdown    = sample_every;
+        state.handler      = handler;
+    }
+
+    ~unchecked_scope()
     {
+        detail::get_check_state() = m_saved;
     }
+
+private:
+    unchecked_scope( unchecked_scope const & );
+    unchecked_scope & operator=( unchecked_scope const & );
+
+private:
+    detail::check_state m_saved;    ///< state to restore
 };
 
+/**
+ * true if dimension checks are enabled for the current thread.
+ */
+inline bool is_dimension_checked()
+{
+    return ! detail::get_check_state().unchecked;
+}
+
 /**
  * quantity.
  */
@@ -557,7 +1472,7 @@ public:
     /**
      * internal dimension (const).
      */
-    dimension_type dimension( /* permit */ ) const
+    dimension_type const & dimension( /* permit */ ) const
     {
         return m_dim;
     }
@@ -573,12 +1488,17 @@ public:
     /**
      * check for same dimension as other; throw incompatible_dimension_error if dimensions differ.
      */
-    void check_dimension( quantity const & other, std::string text ) const
+    void check_dimension( quantity const & other, char const * const text ) const
     {
-        if ( ! same_dimension( other ) )
-        {
-            throw incompatible_dimension_error( text, m_dim, other.m_dim );
-        }
+        detail::check_dimension( m_dim, other.m_dim, text );
+    }
+
+    /**
+     * check for same dimension as other; throw incompatible_dimension_error if dimensions differ.
+     */
+    void check_dimension( quantity const & other, std::string const & text ) const
+    {
+        detail::check_dimension( m_dim, other.m_dim, text );
     }
 
     /**
@@ -840,6 +1760,283 @@ operator>( quantity const & lhs, quantity const & rhs )
 }
 /// @}
 
+/** \name Quantity, hashing */
+/// @{
+
+/**
+ * hash of quantity, of its dimension and value; 0 and -0 hash the same.
+ */
+inline std::size_t hash_value( quantity const & q )
+{
+    double const v = Rep( 0 ) == q.value() ? 0.0 : static_cast<double>( q.value() );
+
+    unsigned char bytes[ sizeof v ];
+    std::memcpy( bytes, &v, sizeof v );
+
+    unsigned long h = static_cast<unsigned long>( hash_value( q.dimension() ) );
+
+    for ( std::size_t i = 0; i < sizeof bytes; ++i )
+    {
+        h = detail::fnv1a( h, bytes[i] );
+    }
+    return static_cast<std::size_t>( h );
+}
+
+/**
+ * quantity hash function object.
+ */
+struct quantity_hash
+{
+    std::size_t operator()( quantity const & q ) const
+    {
+        return hash_value( q );
+    }
+};
+
+/**
+ * quantity equality function object that does not throw for different
+ * dimensions, for unordered containers of quantities of several dimensions;
+ * operator== throws incompatible_dimension_error for these.
+ */
+struct quantity_equal
+{
+    bool operator()( quantity const & lhs, quantity const & rhs ) const
+    {
+        return lhs.same_dimension( rhs ) && lhs.value() == rhs.value();
+    }
+};
+/// @}
+
+/** \name Quantity, non-throwing operations */
+/// @{
+
+/**
+ * result of a non-throwing operation: the quantity, or a compact error
+ * description of which the message is rendered on request.
+ */
+class quantity_result
+{
+public:
+    /**
+     * successful result.
+     */
+    quantity_result( quantity const & q )
+    : m_value( q )
+    , m_error( detail::make_error( errc::ok ) )
+    , m_input()
+    {
+    }
+
+    /**
+     * failed result; input is the text the error position refers to, if any.
+     */
+    quantity_result( quantity const & q, error_info const & e, std::string const & input = std::string() )
+    : m_value( q )
+    , m_error( e )
+    , m_input( input )
+    {
+    }
+
+    /**
+     * true if the operation succeeded.
+     */
+    bool ok() const
+    {
+        return errc::ok == m_error.code;
+    }
+
+    /**
+     * the error code, errc::ok on success.
+     */
+    errc::type code() const
+    {
+        return m_error.code;
+    }
+
+    /**
+     * the input position of the error, 0 if not applicable.
+     */
+    int position() const
+    {
+        return m_error.position;
+    }
+
+    /**
+     * the resulting quantity; unspecified if the operation failed.
+     */
+    quantity const & value() const
+    {
+        return m_value;
+    }
+
+    /**
+     * the error information.
+     */
+    error_info const & error() const
+    {
+        return m_error;
+    }
+
+    /**
+     * the error message, rendered now; empty on success.
+     */
+    std::string message() const
+    {
+        return ok() ? std::string() : m_error.render( m_error, m_input );
+    }
+
+private:
+    quantity m_value;       ///< resulting quantity
+    error_info m_error;     ///< error information
+    std::string m_input;    ///< input text for errors referring to it
+};
+
+/**
+ * quan + quan; result with errc::incompatible_dimension if dimensions differ.
+ */
+inline quantity_result
+try_add( quantity const & lhs, quantity const & rhs )
+{
+    PHYS_UNITS_STATS_ADD( dimension_checks, 1 );
+
+    if ( ! lhs.same_dimension( rhs ) )
+    {
+        PHYS_UNITS_STATS_ADD( dimension_mismatches, 1 );
+
+        detail::trace( trace_op::dimension_mismatch, "operator+", lhs.dimension(), rhs.dimension() );
+
+        return quantity_result( lhs, detail::make_dimension_error( "operator+", lhs.dimension(), rhs.dimension() ) );
+    }
+    return quantity_result( quantity( lhs.dimension(), lhs.value() + rhs.value() ) );
+}
+
+/**
+ * quan - quan; result with errc::incompatible_dimension if dimensions differ.
+ */
+inline quantity_result
+try_subtract( quantity const & lhs, quantity const & rhs )
+{
+    PHYS_UNITS_STATS_ADD( dimension_checks, 1 );
+
+    if ( ! lhs.same_dimension( rhs ) )
+    {
+        PHYS_UNITS_STATS_ADD( dimension_mismatches, 1 );
+
+        detail::trace( trace_op::dimension_mismatch, "operator-", lhs.dimension(), rhs.dimension() );
+
+        return quantity_result( lhs, detail::make_dimension_error( "operator-", lhs.dimension(), rhs.dimension() ) );
+    }
+    return quantity_result( quantity( lhs.dimension(), lhs.value() - rhs.value() ) );
+}
+/// @}
+
+namespace detail {
+
+enum
+{
+    max_squaring_power = 32             ///< largest N raised by repeated squaring
+};
+
+/**
+ * x to the integral power N: by repeated squaring for N up to
+ * max_squaring_power, as 1/x and 1/(x*x) for N is -1 and -2, and by pow()
+ * otherwise; the reciprocal of a larger power would add a rounding step
+ * and its square could overflow.
+ */
+inline Rep int_power( Rep x, int const N )
+{
+    if ( -1 == N )
+    {
+        return 1 / x;
+    }
+
+    if ( -2 == N )
+    {
+        Rep const xx = x * x;
+
+        if ( xx >= std::numeric_limits<Rep>::min() && xx <= std::numeric_limits<Rep>::max() )
+        {
+            return 1 / xx;
+        }
+    }
+
+    if ( N < 0 || N > max_squaring_power )
+    {
+        return std::pow( x, Rep( N ) );
+    }
+
+    unsigned n = static_cast<unsigned>( N );
+    Rep result = 1;
+
+    for ( ;; )
+    {
+        if ( n & 1 )
+        {
+            result *= x;
+        }
+
+        if ( 0 == ( n >>= 1 ) )
+        {
+            break;
+        }
+
+        x *= x;
+    }
+
+    return result;
+}
+
+/**
+ * the real N-th root of x: sqrt() and cbrt() for N is 2 and 3, pow() otherwise;
+ * an odd root of a negative x is negative, with and without cbrt().
+ */
+inline Rep int_root( Rep const x, int const N )
+{
+    switch ( N )
+    {
+        case 1:  return x;
+        case 2:  return std::sqrt( x );
+#if __cplusplus >= 201103L
+        case 3:  return std::cbrt( x );
+#endif
+        default:
+            if ( x < 0 && 0 != N % 2 )
+            {
+                return -std::pow( -x, Rep( 1.0 ) / N );
+            }
+            return std::pow( x, Rep( 1.0 ) / N );
+    }
+}
+
+/**
+ * out[i] = in[i] to the integral power N for i in [0, n); loops of their
+ * own for the frequent powers, so that these vectorize.
+ */
+inline void int_power( Rep const * in, Rep * out, std::size_t const n, int const N )
+{
+    switch ( N )
+    {
+        case  2: for ( std::size_t i = 0; i < n; ++i ) out[i] = in[i] * in[i]; break;
+        case  3: for ( std::size_t i = 0; i < n; ++i ) out[i] = in[i] * in[i] * in[i]; break;
+        case -1: for ( std::size_t i = 0; i < n; ++i ) out[i] = 1 / in[i]; break;
+        default: for ( std::size_t i = 0; i < n; ++i ) out[i] = int_power( in[i], N ); break;
+    }
+}
+
+/**
+ * out[i] = the real N-th root of in[i] for i in [0, n).
+ */
+inline void int_root( Rep const * in, Rep * out, std::size_t const n, int const N )
+{
+    switch ( N )
+    {
+        case  2: for ( std::size_t i = 0; i < n; ++i ) out[i] = std::sqrt( in[i] ); break;
+        default: for ( std::size_t i = 0; i < n; ++i ) out[i] = int_root( in[i], N ); break;
+    }
+}
+
+} // namespace detail
+
 /** \name Quantity, functions */
 /// @{
 
@@ -854,12 +2051,12 @@ abs( quantity const & arg )
 }
 
 /**
- * N-th power.
+ * N-th power; by repeated squaring for small N.
  */
 inline quantity
 nth_power( quantity const & arg, int const N )
 {
-    return quantity( power( arg.dimension(), N ), pow( arg.value(), Rep( N ) ) );
+    return quantity( power( arg.dimension(), N ), detail::int_power( arg.value(), N ) );
 }
 
 // Low powers defined separately for efficiency.
@@ -870,7 +2067,7 @@ nth_power( quantity const & arg, int const N )
 inline quantity
 square( quantity const & arg )
 {
-    return arg * arg;
+    return quantity( power( arg.dimension(), 2 ), arg.value() * arg.value() );
 }
 
 /**
@@ -879,18 +2076,18 @@ square( quantity const & arg )
 inline quantity
 cube( quantity const & arg )
 {
-    return arg * arg * arg;
+    return quantity( power( arg.dimension(), 3 ), arg.value() * arg.value() * arg.value() );
 }
 
 // General root
 
 /**
- * n-th root.
+ * n-th root; sqrt() and cbrt() for the square and cube root.
  */
 inline quantity
 nth_root( quantity const & arg, int const N )
 {
-    return quantity( root( arg.dimension(), N ), pow( arg.value(), Rep( 1.0 ) / N ) );
+    return quantity( root( arg.dimension(), N ), detail::int_root( arg.value(), N ) );
 }
 
 // Low roots defined separately for convenience.
@@ -901,7 +2098,7 @@ nth_root( quantity const & arg, int const N )
 inline quantity
 sqrt( quantity const & arg )
 {
-    return quantity( root( arg.dimension(), 2 ), pow( arg.value(), Rep( 1.0 ) / 2 ) );
+    return quantity( root( arg.dimension(), 2 ), std::sqrt( arg.value() ) );
 }
 /// @}
 
@@ -942,8 +2139,8 @@ inline T quantity_cast( quantity const & q )
 {
     if ( dimensionless_d != q.dimension() )
     {
-        throw bad_quantity_cast( std::string() +
-            "cast quantity to '" + typeid(T).name() + "': quantity must be dimensionless" );
+        PHYS_UNITS_THROW( bad_quantity_cast( std::string() +
+            "cast quantity to '" + typeid(T).name() + "': quantity must be dimensionless" ) );
     }
 
     return static_cast<T>( q.value() );
@@ -1205,6 +2402,24 @@ inline quantity tonne()        { return ton_metric(); }
 using namespace rt;
 #endif
 
+#if __cplusplus >= 201103L
+namespace std {
+
+/**
+ * dimension hash for unordered containers.
+ */
+template <>
+struct hash< ::rt::phys::units::dimensions > : ::rt::phys::units::dimensions_hash {};
+
+/**
+ * quantity hash for unordered containers.
+ */
+template <>
+struct hash< ::rt::phys::units::quantity > : ::rt::phys::units::quantity_hash {};
+
+} // namespace std
+#endif
+
 #endif // PHYS_UNITS_QUANTITY_HPP_INCLUDED
 
 /*
@@ -0,0 +1,329 @@
+/**
+ * \file quantity_array.hpp
+ *
+ * \brief   Array of quantities that share a single dimension.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef PHYS_UNITS_QUANTITY_ARRAY_HPP_INCLUDED
+#define PHYS_UNITS_QUANTITY_ARRAY_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * array size error, for example when combining arrays of different length.
+ */
+struct array_size_error : public quantity_error
+{
+    array_size_error( std::string const text )
+    : quantity_error( text )
+    {
+    }
+};
+
+/**
+ * array of magnitudes with a single dimension for all elements.
+ *
+ * Where a std::vector<quantity> stores (and checks) a dimension per element,
+ * quantity_array stores it once, next to densely packed magnitudes.
+ */
+class quantity_array
+{
+public:
+    typedef dimensions dimension_type;                      //< the dimension type.
+    typedef Rep value_type;                                 //< the magnitude value type.
+    typedef std::vector<value_type> container_type;         //< the magnitude container type.
+    typedef container_type::size_type size_type;            //< the size type.
+    typedef container_type::iterator iterator;              //< magnitude iterator.
+    typedef container_type::const_iterator const_iterator;  //< magnitude const iterator.
+
+    /**
+     * default constructor.
+     */
+    quantity_array()
+    : m_dim( )
+    , m_values( )
+    {
+    }
+
+    /**
+     * initializing constructor: n elements of given magnitude.
+     */
+    explicit quantity_array( dimension_type dimensions, size_type n = 0, value_type val = 0 )
+    : m_dim( dimensions )
+    , m_values( n, val )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, n > 0 );
+    }
+
+    /**
+     * initializing constructor: magnitudes from range [first, last).
+     */
+    template <typename InputIt>
+    quantity_array( dimension_type dimensions, InputIt first, InputIt last )
+    : m_dim( dimensions )
+    , m_values( first, last )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, m_values.capacity() > 0 );
+    }
+
+    /**
+     * copy constructor.
+     */
+    quantity_array( quantity_array const & other )
+    : m_dim( other.m_dim )
+    , m_values( other.m_values )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, ! m_values.empty() );
+    }
+
+    /**
+     * assignment operator.
+     */
+    quantity_array & operator=( quantity_array other )
+    {
+        check_dimension( other, "operator=" );
+        other.swap( *this );
+        return *this;
+    }
+
+    /**
+     * swap with other.
+     */
+    void swap( quantity_array & other )
+    {
+        using std::swap;
+        swap( m_dim, other.m_dim );
+        m_values.swap( other.m_values );
+    }
+
+    /**
+     * number of elements.
+     */
+    size_type size() const
+    {
+        return m_values.size();
+    }
+
+    /**
+     * true if there are no elements.
+     */
+    bool empty() const
+    {
+        return m_values.empty();
+    }
+
+    /**
+     * resize to n elements, new elements get magnitude val.
+     */
+    void resize( size_type n, value_type val = 0 )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, n > m_values.capacity() );
+        m_values.resize( n, val );
+    }
+
+    /**
+     * reserve space for n elements.
+     */
+    void reserve( size_type n )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, n > m_values.capacity() );
+        m_values.reserve( n );
+    }
+
+    /**
+     * remove all elements, keep dimension.
+     */
+    void clear()
+    {
+        m_values.clear();
+    }
+
+    /**
+     * append quantity; throw incompatible_dimension_error if dimensions differ.
+     */
+    void push_back( quantity const & q )
+    {
+        detail::check_dimension( m_dim, q.dimension(), "push_back" );
+        PHYS_UNITS_STATS_ADD( allocations, m_values.size() == m_values.capacity() );
+        m_values.push_back( q.value() );
+    }
+
+    /**
+     * append magnitude, taken to be in the array's dimension.
+     */
+    void push_back_value( value_type val )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, m_values.size() == m_values.capacity() );
+        m_values.push_back( val );
+    }
+
+    /**
+     * element i as quantity.
+     */
+    quantity at( size_type i ) const
+    {
+        return quantity( m_dim, m_values.at( i ) );
+    }
+
+    /**
+     * reference to magnitude of element i (non-const).
+     */
+    value_type & value( size_type i )
+    {
+        return m_values[i];
+    }
+
+    /**
+     * magnitude of element i (const).
+     */
+    value_type value( size_type i ) const
+    {
+        return m_values[i];
+    }
+
+    /**
+     * pointer to the contiguous magnitudes (non-const).
+     */
+    value_type * data()
+    {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    /**
+     * pointer to the contiguous magnitudes (const).
+     */
+    value_type const * data() const
+    {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    iterator begin() { return m_values.begin(); }   ///< begin of magnitudes.
+    iterator end()   { return m_values.end();   }   ///< end of magnitudes.
+
+    const_iterator begin() const { return m_values.begin(); }  ///< begin of magnitudes (const).
+    const_iterator end()   const { return m_values.end();   }  ///< end of magnitudes (const).
+
+    /**
+     * reference to internal dimension (non-const).
+     */
+    dimension_type & dimension()
+    {
+        return m_dim;
+    }
+
+    /**
+     * internal dimension (const).
+     */
+    dimension_type const & dimension() const
+    {
+        return m_dim;
+    }
+
+    /**
+     * true if has same dimension as other.
+     */
+    bool same_dimension( quantity_array const & other ) const
+    {
+        return m_dim == other.m_dim;
+    }
+
+    /**
+     * check for same dimension as other; throw incompatible_dimension_error if dimensions differ.
+     */
+    void check_dimension( quantity_array const & other, char const * const text ) const
+    {
+        detail::check_dimension( m_dim, other.m_dim, text );
+    }
+
+private:
+    dimension_type m_dim;       ///< dimension, shared by all elements
+    container_type m_values;    ///< magnitudes
+};
+
+/** \name Quantity array, attributes */
+/// @{
+
+/**
+ * the array's dimension; same as a.dimension().
+ */
+inline dimensions
+dimension( quantity_array const & a )
+{
+    return a.dimension();
+}
+/// @}
+
+/** \name Quantity array, functions */
+/// @{
+
+/**
+ * element-wise N-th power, with the dimension raised once.
+ */
+inline quantity_array
+nth_power( quantity_array const & a, int const N )
+{
+    quantity_array result( power( a.dimension(), N ), a.size() );
+    detail::int_power( a.data(), result.data(), a.size(), N );
+    return result;
+}
+
+/**
+ * element-wise square.
+ */
+inline quantity_array
+square( quantity_array const & a )
+{
+    return nth_power( a, 2 );
+}
+
+/**
+ * element-wise cube.
+ */
+inline quantity_array
+cube( quantity_array const & a )
+{
+    return nth_power( a, 3 );
+}
+
+/**
+ * element-wise N-th root, with the dimension checked and divided once.
+ */
+inline quantity_array
+nth_root( quantity_array const & a, int const N )
+{
+    quantity_array result( root( a.dimension(), N ), a.size() );
+    detail::int_root( a.data(), result.data(), a.size(), N );
+    return result;
+}
+
+/**
+ * element-wise square root.
+ */
+inline quantity_array
+sqrt( quantity_array const & a )
+{
+    return nth_root( a, 2 );
+}
+/// @}
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_QUANTITY_ARRAY_HPP_INCLUDED
+
+/*
+ * end of file
+ */
@@ -0,0 +1,778 @@
+/**
+ * \file quantity_expr.hpp
+ *
+ * \brief   Expression templates for fused quantity and quantity array arithmetic.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/**
+\struct rt::phys::units::expression
+\verbatim
+
+An arithmetic expression that involves lazy(q) or a quantity_array does not
+compute anything until it is assigned: the dimension of the whole expression
+is determined once and the magnitudes are computed in a single pass (a single
+loop for arrays), without intermediate quantities.
+
+  quantity x1, x2, x3;
+  x1 += lazy( x2 ) / x3;             // one dimension check, no temporaries
+
+  quantity_array a, b, c;
+  assign( c, 2 * a * b + c );        // one loop over the elements
+
+Dimensions are checked with the same exceptions as the eager operators:
+adding or subtracting operands of different dimension throws
+incompatible_dimension_error when the expression's dimension is determined,
+before any magnitude is changed. Combining arrays of different length throws
+array_size_error.
+
+Note: expressions refer to their operands; evaluate an expression within the
+full expression that creates it.
+
+\endverbatim
+*/
+
+#ifndef PHYS_UNITS_QUANTITY_EXPR_HPP_INCLUDED
+#define PHYS_UNITS_QUANTITY_EXPR_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <cstddef>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * base of all expression types (CRTP).
+ */
+template <typename E>
+struct expression
+{
+    /**
+     * the derived expression.
+     */
+    E const & self() const
+    {
+        return static_cast<E const &>( *this );
+    }
+
+    /**
+     * number of elements, 0 for a scalar expression.
+     */
+    std::size_t size() const
+    {
+        return self().size();
+    }
+
+    /**
+     * magnitude of element i.
+     */
+    Rep value( std::size_t i ) const
+    {
+        return self().value( i );
+    }
+
+    /**
+     * add sign times the expression's dimension to d.
+     */
+    void accumulate( dimensions & d, int const sign ) const
+    {
+        self().accumulate( d, sign );
+    }
+
+    /**
+     * the expression's dimension; throws incompatible_dimension_error for
+     * addition or subtraction of operands with different dimensions.
+     */
+    dimensions dimension() const
+    {
+        dimensions d;
+        self().accumulate( d, 1 );
+        return d;
+    }
+};
+
+namespace detail {
+
+/**
+ * add sign times dimension o to dimension d.
+ */
+inline void accumulate_dimension( dimensions & d, dimensions const & o, int const sign )
+{
+    for ( std::size_t i = 0; i < d.d.size(); ++i )
+    {
+        d.d[i] = static_cast<dimensions::value_type>( d.d[i] + sign * o.d[i] );
+    }
+}
+
+/**
+ * common number of elements of two operands, 0 meaning scalar;
+ * throws array_size_error for arrays of different length.
+ */
+inline std::size_t common_size( std::size_t const lhs, std::size_t const rhs )
+{
+    if ( lhs && rhs && lhs != rhs )
+    {
+        PHYS_UNITS_THROW( array_size_error( "quantity: incompatible array sizes in expression" ) );
+    }
+    return lhs ? lhs : rhs;
+}
+
+} // namespace detail
+
+/**
+ * expression leaf: reference to a quantity.
+ */
+class quantity_ref : public expression<quantity_ref>
+{
+public:
+    explicit quantity_ref( quantity const & q )
+    : m_q( q ) {}
+
+    std::size_t size() const { return 0; }
+
+    Rep value( std::size_t ) const { return m_q.value(); }
+
+    void accumulate( dimensions & d, int const sign ) const
+    {
+        detail::accumulate_dimension( d, m_q.dimension(), sign );
+    }
+
+private:
+    quantity const & m_q;
+};
+
+/**
+ * expression leaf: reference to a quantity array.
+ */
+class array_ref : public expression<array_ref>
+{
+public:
+    explicit array_ref( quantity_array const & a )
+    : m_a( a ), m_p( a.data() ) {}
+
+    std::size_t size() const { return m_a.size(); }
+
+    Rep value( std::size_t const i ) const { return m_p[i]; }
+
+    void accumulate( dimensions & d, int const sign ) const
+    {
+        detail::accumulate_dimension( d, m_a.dimension(), sign );
+    }
+
+private:
+    quantity_array const & m_a;
+    Rep const * m_p;
+};
+
+/**
+ * expression leaf: dimensionless number.
+ */
+class number_ref : public expression<number_ref>
+{
+public:
+    explicit number_ref( Rep const v )
+    : m_v( v ) {}
+
+    std::size_t size() const { return 0; }
+
+    Rep value( std::size_t ) const { return m_v; }
+
+    void accumulate( dimensions &, int const ) const {}
+
+private:
+    Rep m_v;
+};
+
+/**
+ * expression node: binary operation Op on L and R.
+ */
+template <typename L, typename R, typename Op>
+class binary_expr : public expression< binary_expr<L, R, Op> >
+{
+public:
+    binary_expr( L const & lhs, R const & rhs )
+    : m_lhs( lhs ), m_rhs( rhs ) {}
+
+    std::size_t size() const
+    {
+        return detail::common_size( m_lhs.size(), m_rhs.size() );
+    }
+
+    Rep value( std::size_t const i ) const
+    {
+        return Op::apply( m_lhs.value( i ), m_rhs.value( i ) );
+    }
+
+    void accumulate( dimensions & d, int const sign ) const
+    {
+        Op::accumulate( m_lhs, m_rhs, d, sign );
+    }
+
+private:
+    L m_lhs;
+    R m_rhs;
+};
+
+/**
+ * expression node: negation of E.
+ */
+template <typename E>
+class negate_expr : public expression< negate_expr<E> >
+{
+public:
+    explicit negate_expr( E const & e )
+    : m_e( e ) {}
+
+    std::size_t size() const { return m_e.size(); }
+
+    Rep value( std::size_t const i ) const { return - m_e.value( i ); }
+
+    void accumulate( dimensions & d, int const sign ) const
+    {
+        m_e.accumulate( d, sign );
+    }
+
+private:
+    E m_e;
+};
+
+namespace detail {
+
+/**
+ * additive operation: operands must have the same dimension.
+ */
+template <typename Derived>
+struct additive_op
+{
+    template <typename L, typename R>
+    static void accumulate( L const & lhs, R const & rhs, dimensions & d, int const sign )
+    {
+        dimensions dl; lhs.accumulate( dl, 1 );
+        dimensions dr; rhs.accumulate( dr, 1 );
+
+        check_dimension( dl, dr, Derived::name() );
+
+        accumulate_dimension( d, dl, sign );
+    }
+};
+
+struct plus_op : additive_op<plus_op>
+{
+    static char const * name() { return "operator+"; }
+    static Rep apply( Rep const a, Rep const b ) { return a + b; }
+};
+
+struct minus_op : additive_op<minus_op>
+{
+    static char const * name() { return "operator-"; }
+    static Rep apply( Rep const a, Rep const b ) { return a - b; }
+};
+
+struct multiplies_op
+{
+    static Rep apply( Rep const a, Rep const b ) { return a * b; }
+
+    template <typename L, typename R>
+    static void accumulate( L const & lhs, R const & rhs, dimensions & d, int const sign )
+    {
+        lhs.accumulate( d, sign );
+        rhs.accumulate( d, sign );
+    }
+};
+
+struct divides_op
+{
+    static Rep apply( Rep const a, Rep const b ) { return a / b; }
+
+    template <typename L, typename R>
+    static void accumulate( L const & lhs, R const & rhs, dimensions & d, int const sign )
+    {
+        lhs.accumulate( d, sign );
+        rhs.accumulate( d, -sign );
+    }
+};
+
+/**
+ * enable_if for pre-C++11 compilers.
+ */
+template <bool B, typename T = void> struct enable_if_c {};
+template <typename T> struct enable_if_c<true, T> { typedef T type; };
+
+/**
+ * placeholder for types that do not take part in expressions.
+ */
+struct no_expr {};
+
+/**
+ * how a type takes part in an expression: is_operand, is_lazy (starts
+ * an expression) and the expression type it is wrapped in.
+ */
+template <typename T>
+struct expr_traits
+{
+    enum { is_operand = 0, is_lazy = 0 };
+    typedef no_expr type;
+};
+
+template <>
+struct expr_traits<quantity>
+{
+    enum { is_operand = 1, is_lazy = 0 };
+    typedef quantity_ref type;
+    static type make( quantity const & q ) { return type( q ); }
+};
+
+template <>
+struct expr_traits<quantity_array>
+{
+    enum { is_operand = 1, is_lazy = 1 };
+    typedef array_ref type;
+    static type make( quantity_array const & a ) { return type( a ); }
+};
+
+#define PHYS_UNITS_EXPR_NUMBER_TRAITS( T ) \
+    template <> \
+    struct expr_traits<T> \
+    { \
+        enum { is_operand = 1, is_lazy = 0 }; \
+        typedef number_ref type; \
+        static type make( T const v ) { return type( static_cast<Rep>( v ) ); } \
+    };
+
+PHYS_UNITS_EXPR_NUMBER_TRAITS( int )
+PHYS_UNITS_EXPR_NUMBER_TRAITS( long )
+PHYS_UNITS_EXPR_NUMBER_TRAITS( unsigned )
+PHYS_UNITS_EXPR_NUMBER_TRAITS( unsigned long )
+PHYS_UNITS_EXPR_NUMBER_TRAITS( float )
+PHYS_UNITS_EXPR_NUMBER_TRAITS( double )
+PHYS_UNITS_EXPR_NUMBER_TRAITS( long double )
+
+#undef PHYS_UNITS_EXPR_NUMBER_TRAITS
+
+#define PHYS_UNITS_EXPR_LEAF_TRAITS( T ) \
+    template <> \
+    struct expr_traits<T> \
+    { \
+        enum { is_operand = 1, is_lazy = 1 }; \
+        typedef T type; \
+        static type make( type const & e ) { return e; } \
+    };
+
+PHYS_UNITS_EXPR_LEAF_TRAITS( quantity_ref )
+PHYS_UNITS_EXPR_LEAF_TRAITS( array_ref )
+PHYS_UNITS_EXPR_LEAF_TRAITS( number_ref )
+
+#undef PHYS_UNITS_EXPR_LEAF_TRAITS
+
+template <typename L, typename R, typename Op>
+struct expr_traits< binary_expr<L, R, Op> >
+{
+    enum { is_operand = 1, is_lazy = 1 };
+    typedef binary_expr<L, R, Op> type;
+    static type make( type const & e ) { return e; }
+};
+
+template <typename E>
+struct expr_traits< negate_expr<E> >
+{
+    enum { is_operand = 1, is_lazy = 1 };
+    typedef negate_expr<E> type;
+    static type make( type const & e ) { return e; }
+};
+
+/**
+ * result type of a binary operation; only defined if at least one of the
+ * operands is lazy, so that the eager quantity operators remain in effect.
+ */
+template <typename L, typename R, typename Op>
+struct binary_result : enable_if_c<
+    expr_traits<L>::is_operand && expr_traits<R>::is_operand &&
+    ( expr_traits<L>::is_lazy || expr_traits<R>::is_lazy ),
+    binary_expr< typename expr_traits<L>::type, typename expr_traits<R>::type, Op > >
+{
+};
+
+/**
+ * result type of negation; only defined for lazy operands.
+ */
+template <typename E>
+struct negate_result : enable_if_c<
+    expr_traits<E>::is_lazy, negate_expr< typename expr_traits<E>::type > >
+{
+};
+
+/**
+ * evaluate expression into n magnitudes at out.
+ */
+template <typename E>
+inline void assign_values( Rep * const out, expression<E> const & e, std::size_t const n )
+{
+    E const & x = e.self();
+
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        out[i] = x.value( i );
+    }
+}
+
+/**
+ * the size of the expression, which must be scalar or have n elements.
+ */
+template <typename E>
+inline std::size_t checked_size( expression<E> const & e, std::size_t const n )
+{
+    const std::size_t size = e.size();
+
+    if ( size != 0 && size != n )
+    {
+        PHYS_UNITS_THROW( array_size_error( "quantity: array size differs from expression size" ) );
+    }
+    return size;
+}
+
+/**
+ * check for a scalar expression; throws array_size_error for array expressions.
+ */
+template <typename E>
+inline void scalar_size( expression<E> const & e )
+{
+    if ( e.size() != 0 )
+    {
+        PHYS_UNITS_THROW( array_size_error( "quantity: cannot evaluate array expression to quantity" ) );
+    }
+}
+
+} // namespace detail
+
+/** \name Expression, create */
+/// @{
+
+/**
+ * start an expression with quantity q, e.g. x1 += lazy( x2 ) / x3.
+ */
+inline quantity_ref
+lazy( quantity const & q )
+{
+    return quantity_ref( q );
+}
+
+/**
+ * quantity array as expression.
+ */
+inline array_ref
+lazy( quantity_array const & a )
+{
+    return array_ref( a );
+}
+/// @}
+
+/** \name Expression, operators */
+/// @{
+
+/**
+ * lazy + operand, operand + lazy.
+ */
+template <typename L, typename R>
+inline typename detail::binary_result<L, R, detail::plus_op>::type
+operator+( L const & lhs, R const & rhs )
+{
+    return typename detail::binary_result<L, R, detail::plus_op>::type(
+        detail::expr_traits<L>::make( lhs ), detail::expr_traits<R>::make( rhs ) );
+}
+
+/**
+ * lazy - operand, operand - lazy.
+ */
+template <typename L, typename R>
+inline typename detail::binary_result<L, R, detail::minus_op>::type
+operator-( L const & lhs, R const & rhs )
+{
+    return typename detail::binary_result<L, R, detail::minus_op>::type(
+        detail::expr_traits<L>::make( lhs ), detail::expr_traits<R>::make( rhs ) );
+}
+
+/**
+ * lazy * operand, operand * lazy.
+ */
+template <typename L, typename R>
+inline typename detail::binary_result<L, R, detail::multiplies_op>::type
+operator*( L const & lhs, R const & rhs )
+{
+    return typename detail::binary_result<L, R, detail::multiplies_op>::type(
+        detail::expr_traits<L>::make( lhs ), detail::expr_traits<R>::make( rhs ) );
+}
+
+/**
+ * lazy / operand, operand / lazy.
+ */
+template <typename L, typename R>
+inline typename detail::binary_result<L, R, detail::divides_op>::type
+operator/( L const & lhs, R const & rhs )
+{
+    return typename detail::binary_result<L, R, detail::divides_op>::type(
+        detail::expr_traits<L>::make( lhs ), detail::expr_traits<R>::make( rhs ) );
+}
+
+/**
+ * \- lazy
+ */
+template <typename E>
+inline typename detail::negate_result<E>::type
+operator-( E const & e )
+{
+    return typename detail::negate_result<E>::type( detail::expr_traits<E>::make( e ) );
+}
+/// @}
+
+/** \name Expression, evaluate into quantity */
+/// @{
+
+/**
+ * the quantity of a scalar expression.
+ */
+template <typename E>
+inline quantity
+evaluate( expression<E> const & e )
+{
+    detail::scalar_size( e );
+    return quantity( e.dimension(), e.value( 0 ) );
+}
+
+/**
+ * quan = expr; throws incompatible_dimension_error if dimensions differ.
+ */
+template <typename E>
+inline quantity &
+assign( quantity & lhs, expression<E> const & rhs )
+{
+    detail::scalar_size( rhs );
+    detail::check_dimension( lhs.dimension(), rhs.dimension(), "operator=" );
+    lhs.value() = rhs.value( 0 );
+    return lhs;
+}
+
+/**
+ * quan += expr
+ */
+template <typename E>
+inline quantity &
+operator+=( quantity & lhs, expression<E> const & rhs )
+{
+    detail::scalar_size( rhs );
+    detail::check_dimension( lhs.dimension(), rhs.dimension(), "operator+=" );
+    lhs.value() += rhs.value( 0 );
+    return lhs;
+}
+
+/**
+ * quan -= expr
+ */
+template <typename E>
+inline quantity &
+operator-=( quantity & lhs, expression<E> const & rhs )
+{
+    detail::scalar_size( rhs );
+    detail::check_dimension( lhs.dimension(), rhs.dimension(), "operator-=" );
+    lhs.value() -= rhs.value( 0 );
+    return lhs;
+}
+
+/**
+ * quan *= expr
+ */
+template <typename E>
+inline quantity &
+operator*=( quantity & lhs, expression<E> const & rhs )
+{
+    detail::scalar_size( rhs );
+    lhs.dimension() *= rhs.dimension();
+    lhs.value() *= rhs.value( 0 );
+    return lhs;
+}
+
+/**
+ * quan /= expr
+ */
+template <typename E>
+inline quantity &
+operator/=( quantity & lhs, expression<E> const & rhs )
+{
+    detail::scalar_size( rhs );
+    lhs.dimension() /= rhs.dimension();
+    lhs.value() /= rhs.value( 0 );
+    return lhs;
+}
+/// @}
+
+/** \name Expression, evaluate into quantity array */
+/// @{
+
+/**
+ * the quantity array of an array expression, evaluated in a single loop.
+ */
+template <typename E>
+inline quantity_array
+evaluate_array( expression<E> const & e )
+{
+    quantity_array result( e.dimension(), e.size() );
+    detail::assign_values( result.data(), e, result.size() );
+    return result;
+}
+
+/**
+ * array = expr; the array takes the expression's size; a scalar expression
+ * is assigned to all elements. Throws incompatible_dimension_error if dimensions differ.
+ */
+template <typename E>
+inline quantity_array &
+assign( quantity_array & lhs, expression<E> const & rhs )
+{
+    detail::check_dimension( lhs.dimension(), rhs.dimension(), "operator=" );
+
+    if ( std::size_t const n = rhs.size() )
+    {
+        // evaluate before resizing, rhs may refer to lhs:
+        quantity_array tmp( lhs.dimension(), n );
+        detail::assign_values( tmp.data(), rhs, n );
+        lhs.swap( tmp );
+    }
+    else
+    {
+        detail::assign_values( lhs.data(), rhs, lhs.size() );
+    }
+    return lhs;
+}
+
+/**
+ * array += expr
+ */
+template <typename E>
+inline quantity_array &
+operator+=( quantity_array & lhs, expression<E> const & rhs )
+{
+    detail::check_dimension( lhs.dimension(), rhs.dimension(), "operator+=" );
+    detail::checked_size( rhs, lhs.size() );
+
+    E const & x = rhs.self();
+    Rep * const p = lhs.data();
+
+    for ( std::size_t i = 0, n = lhs.size(); i < n; ++i )
+    {
+        p[i] += x.value( i );
+    }
+    return lhs;
+}
+
+/**
+ * array -= expr
+ */
+template <typename E>
+inline quantity_array &
+operator-=( quantity_array & lhs, expression<E> const & rhs )
+{
+    detail::check_dimension( lhs.dimension(), rhs.dimension(), "operator-=" );
+    detail::checked_size( rhs, lhs.size() );
+
+    E const & x = rhs.self();
+    Rep * const p = lhs.data();
+
+    for ( std::size_t i = 0, n = lhs.size(); i < n; ++i )
+    {
+        p[i] -= x.value( i );
+    }
+    return lhs;
+}
+
+/**
+ * array *= expr
+ */
+template <typename E>
+inline quantity_array &
+operator*=( quantity_array & lhs, expression<E> const & rhs )
+{
+    detail::checked_size( rhs, lhs.size() );
+    lhs.dimension() *= rhs.dimension();
+
+    E const & x = rhs.self();
+    Rep * const p = lhs.data();
+
+    for ( std::size_t i = 0, n = lhs.size(); i < n; ++i )
+    {
+        p[i] *= x.value( i );
+    }
+    return lhs;
+}
+
+/**
+ * array /= expr
+ */
+template <typename E>
+inline quantity_array &
+operator/=( quantity_array & lhs, expression<E> const & rhs )
+{
+    detail::checked_size( rhs, lhs.size() );
+    lhs.dimension() /= rhs.dimension();
+
+    E const & x = rhs.self();
+    Rep * const p = lhs.data();
+
+    for ( std::size_t i = 0, n = lhs.size(); i < n; ++i )
+    {
+        p[i] /= x.value( i );
+    }
+    return lhs;
+}
+
+/**
+ * array += array
+ */
+inline quantity_array &
+operator+=( quantity_array & lhs, quantity_array const & rhs )
+{
+    return lhs += lazy( rhs );
+}
+
+/**
+ * array -= array
+ */
+inline quantity_array &
+operator-=( quantity_array & lhs, quantity_array const & rhs )
+{
+    return lhs -= lazy( rhs );
+}
+
+/**
+ * array *= array
+ */
+inline quantity_array &
+operator*=( quantity_array & lhs, quantity_array const & rhs )
+{
+    return lhs *= lazy( rhs );
+}
+
+/**
+ * array /= array
+ */
+inline quantity_array &
+operator/=( quantity_array & lhs, quantity_array const & rhs )
+{
+    return lhs /= lazy( rhs );
+}
+/// @}
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_QUANTITY_EXPR_HPP_INCLUDED
+
+/*
+ * end of file
+ */
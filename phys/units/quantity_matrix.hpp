@@ -0,0 +1,601 @@
+/**
+ * \file quantity_matrix.hpp
+ *
+ * \brief   Vectors and matrices of quantities with a dimension per row and column.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * A quantity_vector holds quantities of mixed dimension, such as a state of
+ * position, velocity and temperature: a dimension per element next to
+ * densely packed magnitudes.
+ *
+ * A quantity_matrix stores a dimension per row and per column; element (i, j)
+ * has the dimension of row i divided by that of column j, as the Jacobian
+ * dy_i/dx_j of a vector y to a vector x has rows of y and columns of x. The
+ * magnitudes are stored row by row.
+ *
+ * A product A x is consistent if x_j divided by column j of A has the same
+ * dimension d for every j; then row i of the result has the dimension of row i
+ * of A times d. Likewise for A B with the rows of B. The products check this
+ * once per row or column, and then compute the magnitudes without dimensions:
+ * matrix-vector products per row in lanes (see quantity_reduce.hpp), matrix
+ * products in blocks that fit in the cache.
+ */
+
+#ifndef PHYS_UNITS_QUANTITY_MATRIX_HPP_INCLUDED
+#define PHYS_UNITS_QUANTITY_MATRIX_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+#include "phys/units/quantity_reduce.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace rt { namespace phys { namespace units {
+
+/**
+ * vector of quantities with a dimension per element.
+ */
+class quantity_vector
+{
+public:
+    typedef dimensions dimension_type;                      //< the dimension type.
+    typedef Rep value_type;                                 //< the magnitude value type.
+    typedef std::vector<dimension_type> dimensions_type;    //< the dimensions container type.
+    typedef std::vector<value_type> container_type;         //< the magnitude container type.
+    typedef container_type::size_type size_type;            //< the size type.
+
+    /**
+     * default constructor.
+     */
+    quantity_vector()
+    : m_dims( )
+    , m_values( )
+    {
+    }
+
+    /**
+     * initializing constructor: an element of given magnitude per dimension.
+     */
+    explicit quantity_vector( dimensions_type const & dims, value_type val = 0 )
+    : m_dims( dims )
+    , m_values( dims.size(), val )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, ! dims.empty() );
+    }
+
+    /**
+     * swap with other.
+     */
+    void swap( quantity_vector & other )
+    {
+        m_dims.swap( other.m_dims );
+        m_values.swap( other.m_values );
+    }
+
+    /**
+     * number of elements.
+     */
+    size_type size() const
+    {
+        return m_values.size();
+    }
+
+    /**
+     * true if there are no elements.
+     */
+    bool empty() const
+    {
+        return m_values.empty();
+    }
+
+    /**
+     * append quantity, with its dimension.
+     */
+    void push_back( quantity const & q )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, m_values.size() == m_values.capacity() );
+        m_dims.push_back( q.dimension() );
+        m_values.push_back( q.value() );
+    }
+
+    /**
+     * element i as quantity.
+     */
+    quantity at( size_type i ) const
+    {
+        return quantity( m_dims.at( i ), m_values.at( i ) );
+    }
+
+    /**
+     * reference to magnitude of element i (non-const).
+     */
+    value_type & value( size_type i )
+    {
+        return m_values[i];
+    }
+
+    /**
+     * magnitude of element i (const).
+     */
+    value_type value( size_type i ) const
+    {
+        return m_values[i];
+    }
+
+    /**
+     * pointer to the contiguous magnitudes (non-const).
+     */
+    value_type * data()
+    {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    /**
+     * pointer to the contiguous magnitudes (const).
+     */
+    value_type const * data() const
+    {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    /**
+     * dimension of element i.
+     */
+    dimension_type const & dimension( size_type i ) const
+    {
+        return m_dims[i];
+    }
+
+    /**
+     * dimensions of all elements.
+     */
+    dimensions_type const & element_dimensions() const
+    {
+        return m_dims;
+    }
+
+    /**
+     * check for same size and dimensions as other; throw array_size_error
+     * or incompatible_dimension_error if these differ.
+     */
+    void check_dimensions( quantity_vector const & other, char const * const text ) const
+    {
+        if ( size() != other.size() )
+        {
+            PHYS_UNITS_THROW( array_size_error( "quantity: incompatible vector sizes" ) );
+        }
+
+        for ( size_type i = 0; i < size(); ++i )
+        {
+            detail::check_dimension( m_dims[i], other.m_dims[i], text );
+        }
+    }
+
+private:
+    dimensions_type m_dims;     ///< dimension per element
+    container_type m_values;    ///< magnitudes
+};
+
+/**
+ * matrix of quantities with a dimension per row and per column; element
+ * (i, j) has the dimension of row i divided by that of column j.
+ */
+class quantity_matrix
+{
+public:
+    typedef dimensions dimension_type;                      //< the dimension type.
+    typedef Rep value_type;                                 //< the magnitude value type.
+    typedef std::vector<dimension_type> dimensions_type;    //< the dimensions container type.
+    typedef std::vector<value_type> container_type;         //< the magnitude container type.
+    typedef container_type::size_type size_type;            //< the size type.
+
+    /**
+     * default constructor.
+     */
+    quantity_matrix()
+    : m_rows( )
+    , m_cols( )
+    , m_values( )
+    {
+    }
+
+    /**
+     * initializing constructor: given row and column dimensions, all
+     * elements of given magnitude.
+     */
+    quantity_matrix( dimensions_type const & rows, dimensions_type const & cols, value_type val = 0 )
+    : m_rows( rows )
+    , m_cols( cols )
+    , m_values( rows.size() * cols.size(), val )
+    {
+        PHYS_UNITS_STATS_ADD( allocations, ! m_values.empty() );
+    }
+
+    /**
+     * swap with other.
+     */
+    void swap( quantity_matrix & other )
+    {
+        m_rows.swap( other.m_rows );
+        m_cols.swap( other.m_cols );
+        m_values.swap( other.m_values );
+    }
+
+    /**
+     * number of rows.
+     */
+    size_type rows() const
+    {
+        return m_rows.size();
+    }
+
+    /**
+     * number of columns.
+     */
+    size_type cols() const
+    {
+        return m_cols.size();
+    }
+
+    /**
+     * dimension of row i.
+     */
+    dimension_type const & row_dimension( size_type i ) const
+    {
+        return m_rows[i];
+    }
+
+    /**
+     * dimension of column j.
+     */
+    dimension_type const & column_dimension( size_type j ) const
+    {
+        return m_cols[j];
+    }
+
+    /**
+     * dimensions of all rows.
+     */
+    dimensions_type const & row_dimensions() const
+    {
+        return m_rows;
+    }
+
+    /**
+     * dimensions of all columns.
+     */
+    dimensions_type const & column_dimensions() const
+    {
+        return m_cols;
+    }
+
+    /**
+     * dimension of element (i, j).
+     */
+    dimension_type dimension( size_type i, size_type j ) const
+    {
+        return quotient( m_rows[i], m_cols[j] );
+    }
+
+    /**
+     * element (i, j) as quantity.
+     */
+    quantity at( size_type i, size_type j ) const
+    {
+        return quantity( dimension( i, j ), m_values.at( index( i, j ) ) );
+    }
+
+    /**
+     * set element (i, j); throw incompatible_dimension_error if the dimension
+     * of q differs from that of the element.
+     */
+    void set( size_type i, size_type j, quantity const & q )
+    {
+        detail::require_dimension( dimension( i, j ), q.dimension(), "set" );
+        m_values.at( index( i, j ) ) = q.value();
+    }
+
+    /**
+     * reference to magnitude of element (i, j) (non-const).
+     */
+    value_type & value( size_type i, size_type j )
+    {
+        return m_values[ index( i, j ) ];
+    }
+
+    /**
+     * magnitude of element (i, j) (const).
+     */
+    value_type value( size_type i, size_type j ) const
+    {
+        return m_values[ index( i, j ) ];
+    }
+
+    /**
+     * pointer to the contiguous magnitudes, row by row (non-const).
+     */
+    value_type * data()
+    {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    /**
+     * pointer to the contiguous magnitudes, row by row (const).
+     */
+    value_type const * data() const
+    {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+private:
+    /**
+     * offset of element (i, j) in the magnitudes.
+     */
+    size_type index( size_type i, size_type j ) const
+    {
+        return i * m_cols.size() + j;
+    }
+
+    dimensions_type m_rows;     ///< dimension per row
+    dimensions_type m_cols;     ///< dimension per column
+    container_type m_values;    ///< magnitudes, row by row
+};
+
+namespace detail {
+
+enum
+{
+    matrix_block = 64                   ///< rows and columns of a block of a matrix product
+};
+
+/**
+ * true if a / b equals c / d, without creating these quotients.
+ */
+inline bool same_ratio( dimensions const & a, dimensions const & b, dimensions const & c, dimensions const & d )
+{
+    for ( std::size_t k = 0; k < a.d.size(); ++k )
+    {
+        if ( a.d[k] - b.d[k] != c.d[k] - d.d[k] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * the dimension d such that factors[j] = columns[j] d for all j;
+ * throws array_size_error if the sizes differ and incompatible_dimension_error
+ * if there is no such d. Dimensionless if there are no columns.
+ */
+inline dimensions common_ratio( quantity_matrix::dimensions_type const & columns,
+    quantity_matrix::dimensions_type const & factors, char const * const text )
+{
+    if ( columns.size() != factors.size() )
+    {
+        PHYS_UNITS_THROW( array_size_error( std::string( "quantity: incompatible sizes in " ) + text ) );
+    }
+
+    if ( columns.empty() )
+    {
+        return dimensions();
+    }
+
+    for ( std::size_t j = 1; j < columns.size(); ++j )
+    {
+        if ( ! same_ratio( factors[j], columns[j], factors[0], columns[0] ) )
+        {
+            check_dimension( quotient( factors[0], columns[0] ), quotient( factors[j], columns[j] ), text );
+        }
+    }
+    return quotient( factors[0], columns[0] );
+}
+
+/**
+ * the dimensions of rows times d.
+ */
+inline quantity_matrix::dimensions_type scaled( quantity_matrix::dimensions_type const & rows, dimensions const & d )
+{
+    quantity_matrix::dimensions_type result( rows );
+
+    for ( std::size_t i = 0; i < result.size(); ++i )
+    {
+        result[i] *= d;
+    }
+    return result;
+}
+
+/**
+ * c += a b for the row-major m x k matrix a and k x n matrix b, in blocks.
+ */
+inline void multiply_blocked( Rep const * a, Rep const * b, Rep * c,
+    std::size_t const m, std::size_t const k, std::size_t const n )
+{
+    for ( std::size_t ii = 0; ii < m; ii += matrix_block )
+    {
+        std::size_t const iend = ii + matrix_block < m ? ii + matrix_block : m;
+
+        for ( std::size_t pp = 0; pp < k; pp += matrix_block )
+        {
+            std::size_t const pend = pp + matrix_block < k ? pp + matrix_block : k;
+
+            for ( std::size_t jj = 0; jj < n; jj += matrix_block )
+            {
+                std::size_t const jend = jj + matrix_block < n ? jj + matrix_block : n;
+
+                for ( std::size_t i = ii; i < iend; ++i )
+                {
+                    Rep * const ci = c + i * n;
+
+                    for ( std::size_t p = pp; p < pend; ++p )
+                    {
+                        Rep const aip = a[ i * k + p ];
+                        Rep const * const bp = b + p * n;
+
+                        for ( std::size_t j = jj; j < jend; ++j )
+                        {
+                            ci[j] += aip * bp[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/** \name Quantity vector, arithmetic */
+/// @{
+
+/**
+ * element-wise sum; throws for vectors of different size or dimensions.
+ */
+inline quantity_vector
+operator+( quantity_vector const & lhs, quantity_vector const & rhs )
+{
+    lhs.check_dimensions( rhs, "operator+" );
+
+    quantity_vector result( lhs );
+
+    for ( quantity_vector::size_type i = 0; i < result.size(); ++i )
+    {
+        result.value( i ) += rhs.value( i );
+    }
+    return result;
+}
+
+/**
+ * element-wise difference; throws for vectors of different size or dimensions.
+ */
+inline quantity_vector
+operator-( quantity_vector const & lhs, quantity_vector const & rhs )
+{
+    lhs.check_dimensions( rhs, "operator-" );
+
+    quantity_vector result( lhs );
+
+    for ( quantity_vector::size_type i = 0; i < result.size(); ++i )
+    {
+        result.value( i ) -= rhs.value( i );
+    }
+    return result;
+}
+
+/**
+ * vector times real.
+ */
+inline quantity_vector
+operator*( quantity_vector const & lhs, Rep const rhs )
+{
+    quantity_vector result( lhs );
+
+    for ( quantity_vector::size_type i = 0; i < result.size(); ++i )
+    {
+        result.value( i ) *= rhs;
+    }
+    return result;
+}
+
+/**
+ * real times vector.
+ */
+inline quantity_vector
+operator*( Rep const lhs, quantity_vector const & rhs )
+{
+    return rhs * lhs;
+}
+/// @}
+
+/** \name Quantity matrix, operations */
+/// @{
+
+/**
+ * matrix-vector product; row i has the dimension of row i of a times the
+ * common ratio of the elements of x to the columns of a. Throws
+ * array_size_error or incompatible_dimension_error if a and x do not match.
+ */
+inline quantity_vector
+operator*( quantity_matrix const & a, quantity_vector const & x )
+{
+    dimensions const d( detail::common_ratio( a.column_dimensions(), x.element_dimensions(), "operator*" ) );
+
+    quantity_vector result( detail::scaled( a.row_dimensions(), d ) );
+
+    for ( quantity_matrix::size_type i = 0; i < a.rows(); ++i )
+    {
+        detail::product_term const term = { a.data() + i * a.cols(), x.data() };
+
+        result.value( i ) = detail::pairwise_sum( term, 0, a.cols() );
+    }
+    return result;
+}
+
+/**
+ * matrix product; row i has the dimension of row i of a times the common
+ * ratio of the rows of b to the columns of a, column j that of column j of b.
+ * Throws array_size_error or incompatible_dimension_error if a and b do not match.
+ */
+inline quantity_matrix
+operator*( quantity_matrix const & a, quantity_matrix const & b )
+{
+    dimensions const d( detail::common_ratio( a.column_dimensions(), b.row_dimensions(), "operator*" ) );
+
+    quantity_matrix result( detail::scaled( a.row_dimensions(), d ), b.column_dimensions() );
+
+    detail::multiply_blocked( a.data(), b.data(), result.data(), a.rows(), a.cols(), b.cols() );
+
+    return result;
+}
+
+/**
+ * transposed matrix; element (j, i) has the dimension of element (i, j), with
+ * the reciprocal column dimensions as rows and vice versa.
+ */
+inline quantity_matrix
+transpose( quantity_matrix const & a )
+{
+    quantity_matrix::dimensions_type rows( a.cols() );
+    quantity_matrix::dimensions_type cols( a.rows() );
+
+    for ( quantity_matrix::size_type j = 0; j < a.cols(); ++j )
+    {
+        rows[j] = reciprocal( a.column_dimension( j ) );
+    }
+
+    for ( quantity_matrix::size_type i = 0; i < a.rows(); ++i )
+    {
+        cols[i] = reciprocal( a.row_dimension( i ) );
+    }
+
+    quantity_matrix result( rows, cols );
+
+    for ( quantity_matrix::size_type i = 0; i < a.rows(); ++i )
+    {
+        for ( quantity_matrix::size_type j = 0; j < a.cols(); ++j )
+        {
+            result.value( j, i ) = a.value( i, j );
+        }
+    }
+    return result;
+}
+/// @}
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_QUANTITY_MATRIX_HPP_INCLUDED
+
+/*
+ * end of file
+ */
@@ -0,0 +1,437 @@
+/**
+ * \file quantity_reduce.hpp
+ *
+ * \brief   Reductions over arrays of quantities that share a single dimension.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ * \since   1.1
+ *
+ * This code is provided as-is, with no warrantee of correctness.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * The reductions determine the dimension of their result once and then run
+ * over the contiguous magnitudes of a quantity_array, without per-element
+ * dimension checks or allocations.
+ *
+ * Sums are pairwise: the magnitudes are split in halves down to blocks of
+ * 128, of which the sum is computed in 8 independent lanes. The rounding error
+ * grows with the logarithm of the length instead of with the length itself,
+ * and the lanes are written such that compilers vectorize them (e.g. -O3, or
+ * -O2 with -ftree-vectorize), without reordering the additions.
+ *
+ * Arrays longer than 64 Ki elements are reduced per chunk of that size, and
+ * the chunk results pairwise. When compiled with OpenMP (e.g. -fopenmp,
+ * /openmp) the chunks can be reduced in parallel; as the chunks only depend on
+ * the length of the array, the result is the same for any number of threads.
+ */
+
+#ifndef PHYS_UNITS_QUANTITY_REDUCE_HPP_INCLUDED
+#define PHYS_UNITS_QUANTITY_REDUCE_HPP_INCLUDED
+
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+namespace rt { namespace phys { namespace units {
+
+namespace detail {
+
+enum
+{
+    reduce_lanes = 8,                   ///< independent accumulators of a block
+    reduce_block = 128,                 ///< largest block summed in lanes
+    reduce_chunk = 64 * 1024            ///< elements per (parallel) chunk
+};
+
+/**
+ * reduction term: the magnitude.
+ */
+struct value_term
+{
+    Rep const * p;
+
+    Rep operator()( std::size_t const i ) const { return p[i]; }
+};
+
+/**
+ * reduction term: the square of the magnitude, scaled by 1/scale.
+ */
+struct square_term
+{
+    Rep const * p;
+    Rep scale;
+
+    Rep operator()( std::size_t const i ) const { Rep const x = p[i] / scale; return x * x; }
+};
+
+/**
+ * reduction term: the square of the deviation from the mean.
+ */
+struct deviation_term
+{
+    Rep const * p;
+    Rep mean;
+
+    Rep operator()( std::size_t const i ) const { Rep const x = p[i] - mean; return x * x; }
+};
+
+/**
+ * reduction term: the product of the magnitudes of two arrays.
+ */
+struct product_term
+{
+    Rep const * p;
+    Rep const * q;
+
+    Rep operator()( std::size_t const i ) const { return p[i] * q[i]; }
+};
+
+/**
+ * sum of the terms [first, first + n) of a block, in lanes.
+ */
+template <typename Term>
+inline Rep block_sum( Term const & term, std::size_t const first, std::size_t const n )
+{
+    Rep acc[ reduce_lanes ] = { 0 };
+
+    std::size_t i = first;
+    std::size_t const last = first + n;
+
+    for ( ; i + reduce_lanes <= last; i += reduce_lanes )
+    {
+        for ( int k = 0; k < reduce_lanes; ++k )
+        {
+            acc[k] += term( i + k );
+        }
+    }
+
+    Rep tail = 0;
+
+    for ( ; i < last; ++i )
+    {
+        tail += term( i );
+    }
+
+    return ( ( acc[0] + acc[1] ) + ( acc[2] + acc[3] ) ) + ( ( acc[4] + acc[5] ) + ( acc[6] + acc[7] ) ) + tail;
+}
+
+/**
+ * pairwise sum of the terms [first, first + n).
+ */
+template <typename Term>
+inline Rep pairwise_sum( Term const & term, std::size_t const first, std::size_t const n )
+{
+    if ( n <= reduce_block )
+    {
+        return block_sum( term, first, n );
+    }
+
+    // split at a multiple of the lanes, so that both halves fill whole lanes:
+    std::size_t const half = n / 2 / reduce_lanes * reduce_lanes;
+
+    return pairwise_sum( term, first, half ) + pairwise_sum( term, first + half, n - half );
+}
+
+/**
+ * the number of threads to use, or all when 0 (only when compiled with OpenMP).
+ */
+inline int reduce_threads( int const threads )
+{
+#ifdef _OPENMP
+    return threads > 0 ? threads : omp_get_max_threads();
+#else
+    (void) threads;
+    return 1;
+#endif
+}
+
+/**
+ * sum of the terms [0, n), per chunk on up to threads threads; the result
+ * does not depend on the number of threads.
+ */
+template <typename Term>
+inline Rep chunked_sum( Term const & term, std::size_t const n, int const threads )
+{
+    if ( n <= reduce_chunk )
+    {
+        return pairwise_sum( term, 0, n );
+    }
+
+    int const nchunks = static_cast<int>( ( n + reduce_chunk - 1 ) / reduce_chunk );
+
+    std::vector<Rep> partials( nchunks );
+
+#ifdef _OPENMP
+# pragma omp parallel for num_threads( reduce_threads( threads ) ) schedule( static )
+#else
+    (void) threads;
+#endif
+    for ( int i = 0; i < nchunks; ++i )
+    {
+        std::size_t const first = std::size_t( i ) * reduce_chunk;
+        std::size_t const last  = first + reduce_chunk < n ? first + reduce_chunk : n;
+
+        partials[i] = pairwise_sum( term, first, last - first );
+    }
+
+    value_term const chunk_term = { &partials[0] };
+
+    return pairwise_sum( chunk_term, 0, partials.size() );
+}
+
+/**
+ * comparison for the smallest element.
+ */
+struct less_op
+{
+    static Rep initial() { return std::numeric_limits<Rep>::infinity(); }
+
+    bool operator()( Rep const x, Rep const y ) const { return x < y; }
+};
+
+/**
+ * comparison for the largest element.
+ */
+struct greater_op
+{
+    static Rep initial() { return -std::numeric_limits<Rep>::infinity(); }
+
+    bool operator()( Rep const x, Rep const y ) const { return x > y; }
+};
+
+/**
+ * first magnitude of [first, last) in the order of compare, in lanes; NaN is
+ * skipped. Gives Compare::initial() if there are only NaN.
+ */
+template <typename Compare>
+inline Rep block_extreme( Compare const & compare, Rep const * p, std::size_t const first, std::size_t const last )
+{
+    Rep acc[ reduce_lanes ];
+
+    for ( int k = 0; k < reduce_lanes; ++k )
+    {
+        acc[k] = Compare::initial();
+    }
+
+    std::size_t i = first;
+
+    for ( ; i + reduce_lanes <= last; i += reduce_lanes )
+    {
+        for ( int k = 0; k < reduce_lanes; ++k )
+        {
+            acc[k] = compare( p[i + k], acc[k] ) ? p[i + k] : acc[k];
+        }
+    }
+
+    for ( ; i < last; ++i )
+    {
+        acc[0] = compare( p[i], acc[0] ) ? p[i] : acc[0];
+    }
+
+    for ( int k = 1; k < reduce_lanes; ++k )
+    {
+        acc[0] = compare( acc[k], acc[0] ) ? acc[k] : acc[0];
+    }
+    return acc[0];
+}
+
+/**
+ * first magnitude of [0, n) in the order of compare, per chunk on up to
+ * threads threads; NaN is skipped, NaN if there are only NaN.
+ */
+template <typename Compare>
+inline Rep chunked_extreme( Compare const & compare, Rep const * p, std::size_t const n, int const threads )
+{
+    Rep result = Compare::initial();
+
+    if ( n <= reduce_chunk )
+    {
+        result = block_extreme( compare, p, 0, n );
+    }
+    else
+    {
+        int const nchunks = static_cast<int>( ( n + reduce_chunk - 1 ) / reduce_chunk );
+
+        std::vector<Rep> partials( nchunks );
+
+#ifdef _OPENMP
+# pragma omp parallel for num_threads( reduce_threads( threads ) ) schedule( static )
+#else
+        (void) threads;
+#endif
+        for ( int i = 0; i < nchunks; ++i )
+        {
+            std::size_t const first = std::size_t( i ) * reduce_chunk;
+            std::size_t const last  = first + reduce_chunk < n ? first + reduce_chunk : n;
+
+            partials[i] = block_extreme( compare, p, first, last );
+        }
+
+        result = block_extreme( compare, &partials[0], 0, partials.size() );
+    }
+
+    if ( result != Compare::initial() )
+    {
+        return result;
+    }
+
+    // only NaN, or the extreme is an infinity:
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        if ( p[i] == p[i] )
+        {
+            return result;
+        }
+    }
+    return std::numeric_limits<Rep>::quiet_NaN();
+}
+
+/**
+ * throw array_size_error for an empty array.
+ */
+inline void check_not_empty( quantity_array const & a, char const * const text )
+{
+    if ( 0 == a.size() )
+    {
+        PHYS_UNITS_THROW( array_size_error( std::string( "quantity: " ) + text + " of empty array" ) );
+    }
+}
+
+} // namespace detail
+
+/** \name Quantity array, reductions */
+/// @{
+
+/**
+ * sum of the elements; zero of the array's dimension if empty.
+ * Uses threads threads, or all when 0 (only when compiled with OpenMP).
+ */
+inline quantity
+sum( quantity_array const & a, int const threads = 1 )
+{
+    detail::value_term const term = { a.data() };
+
+    return quantity( a.dimension(), detail::chunked_sum( term, a.size(), threads ) );
+}
+
+/**
+ * arithmetic mean of the elements; throws array_size_error if empty.
+ */
+inline quantity
+mean( quantity_array const & a, int const threads = 1 )
+{
+    detail::check_not_empty( a, "mean" );
+
+    detail::value_term const term = { a.data() };
+
+    return quantity( a.dimension(), detail::chunked_sum( term, a.size(), threads ) / Rep( a.size() ) );
+}
+
+/**
+ * smallest element, skipping NaN; throws array_size_error if empty.
+ * (The parentheses keep a function-like macro min from expanding.)
+ */
+inline quantity
+(min)( quantity_array const & a, int const threads = 1 )
+{
+    detail::check_not_empty( a, "min" );
+
+    return quantity( a.dimension(), detail::chunked_extreme( detail::less_op(), a.data(), a.size(), threads ) );
+}
+
+/**
+ * largest element, skipping NaN; throws array_size_error if empty.
+ */
+inline quantity
+(max)( quantity_array const & a, int const threads = 1 )
+{
+    detail::check_not_empty( a, "max" );
+
+    return quantity( a.dimension(), detail::chunked_extreme( detail::greater_op(), a.data(), a.size(), threads ) );
+}
+
+/**
+ * population variance of the elements, as the mean squared deviation from the
+ * mean, computed in two passes; has the squared dimension of the array.
+ * Throws array_size_error if empty.
+ */
+inline quantity
+variance( quantity_array const & a, int const threads = 1 )
+{
+    detail::check_not_empty( a, "variance" );
+
+    detail::value_term const term = { a.data() };
+    detail::deviation_term const deviation = { a.data(), detail::chunked_sum( term, a.size(), threads ) / Rep( a.size() ) };
+
+    return quantity( power( a.dimension(), 2 ), detail::chunked_sum( deviation, a.size(), threads ) / Rep( a.size() ) );
+}
+
+/**
+ * Euclidean norm of the elements, the square root of the sum of squares;
+ * has the dimension of the array. Large and small magnitudes are rescaled
+ * to avoid overflow and underflow of the squares.
+ */
+inline quantity
+norm( quantity_array const & a, int const threads = 1 )
+{
+    detail::square_term term = { a.data(), 1 };
+
+    Rep const s = detail::chunked_sum( term, a.size(), threads );
+
+    if ( 0 == a.size() || s != s || ( s <= std::numeric_limits<Rep>::max() && s >= std::numeric_limits<Rep>::min() ) )
+    {
+        return quantity( a.dimension(), std::sqrt( s ) );
+    }
+
+    // scale by the largest absolute magnitude:
+    Rep const hi = std::fabs( detail::chunked_extreme( detail::greater_op(), a.data(), a.size(), threads ) );
+    Rep const lo = std::fabs( detail::chunked_extreme( detail::less_op(), a.data(), a.size(), threads ) );
+
+    term.scale = hi > lo ? hi : lo;
+
+    if ( 0 == term.scale || term.scale > std::numeric_limits<Rep>::max() )
+    {
+        return quantity( a.dimension(), term.scale );
+    }
+
+    return quantity( a.dimension(), term.scale * std::sqrt( detail::chunked_sum( term, a.size(), threads ) ) );
+}
+
+/**
+ * dot product of two arrays of equal length; has the product of their
+ * dimensions, e.g. m and N give J. Throws array_size_error if the lengths differ.
+ */
+inline quantity
+dot( quantity_array const & a, quantity_array const & b, int const threads = 1 )
+{
+    if ( a.size() != b.size() )
+    {
+        PHYS_UNITS_THROW( array_size_error( "quantity: incompatible array sizes in dot product" ) );
+    }
+
+    detail::product_term const term = { a.data(), b.data() };
+
+    return quantity( product( a.dimension(), b.dimension() ), detail::chunked_sum( term, a.size(), threads ) );
+}
+/// @}
+
+}}} // namespace rt { namespace phys { namespace units {
+
+#endif // PHYS_UNITS_QUANTITY_REDUCE_HPP_INCLUDED
+
+/*
+ * end of file
+ */
@@ -0,0 +1,1843 @@
+/**
+ * \file Benchmark.cpp
+ *
+ * \brief   Benchmark suite for the run-time quantity library.
+ * \author  Martin Moene
+ * \date    18 October 2026
+ *
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+// g++ -Wall -O2 -I../../ -o Benchmark Benchmark.cpp && ./Benchmark
+// cl -nologo -W3 -EHsc -O2 -D_CRT_SECURE_NO_WARNINGS -I../../ Benchmark.cpp && Benchmark
+
+/*
+ * Each benchmark runs an operation n times, with n chosen such that a run
+ * takes at least --min-time. After --warmup untimed runs, --reps runs are
+ * timed, in turn with the other benchmarks; the report gives the median and 10th and 90th percentile of the
+ * time per operation and the number of heap allocations per operation.
+ *
+ * The work/ benchmarks are the loops of the original perf-test.cpp; the
+ * summary relates them to the loop with doubles, as in the README table.
+ */
+
+#include "phys/units/formula.hpp"
+#include "phys/units/io.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_expr.hpp"
+#include "phys/units/quantity_matrix.hpp"
+#include "phys/units/quantity_reduce.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201103L
+# include <unordered_map>
+#endif
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+using namespace phys::units;
+
+char const * const version_text =
+    "1.0 (18 October 2026)";
+
+/*
+ * heap allocation counting; the benchmarks run on a single thread.
+ */
+
+std::size_t g_allocations = 0;
+
+#if __cplusplus >= 201103L
+# define BENCHMARK_THROW_BAD_ALLOC
+# define BENCHMARK_NOTHROW noexcept
+#else
+# define BENCHMARK_THROW_BAD_ALLOC throw( std::bad_alloc )
+# define BENCHMARK_NOTHROW throw()
+#endif
+
+// keep the compiler from pairing malloc() and free() with new and delete:
+#ifdef __GNUC__
+# define BENCHMARK_NOINLINE __attribute__(( noinline ))
+#else
+# define BENCHMARK_NOINLINE
+#endif
+
+BENCHMARK_NOINLINE void * operator new( std::size_t size ) BENCHMARK_THROW_BAD_ALLOC
+{
+    ++g_allocations;
+
+    if ( void * const p = std::malloc( size ? size : 1 ) )
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void * operator new[]( std::size_t size ) BENCHMARK_THROW_BAD_ALLOC
+{
+    return operator new( size );
+}
+
+BENCHMARK_NOINLINE void operator delete( void * p ) BENCHMARK_NOTHROW
+{
+    std::free( p );
+}
+
+void operator delete[]( void * p ) BENCHMARK_NOTHROW
+{
+    std::free( p );
+}
+
+/**
+ * monotonic time in seconds.
+ */
+double now()
+{
+#ifdef _WIN32
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return double( count.QuadPart ) / double( frequency.QuadPart );
+#else
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+/*
+ * operands and result sink; the operands are read through a volatile, so
+ * that the compiler cannot fold the operations on them.
+ */
+
+enum { operand_count = 16, operand_mask = operand_count - 1 };
+
+volatile double g_seed = 1.5;
+volatile double g_sink = 0;
+
+double    g_real  [operand_count];
+quantity  g_length[operand_count];
+quantity  g_time  [operand_count];
+quantity  g_area  [operand_count];
+
+char const * const g_texts[operand_count] =
+{
+    "12.5 km/h", "3 mm", "9.81 m/s2", "230 V", "1.5 kW.h", "42 km", "1 dm3", "2 (3.14 mm)2",
+    "0.5 kg", "3 ms", "-2.5e3 m", "60 Hz", "1013 hPa", "4.2 kJ", "25 mA", "7 N.m",
+};
+
+char const * const g_units[operand_count] =
+{
+    "km/h", "mm", "m/s2", "V", "kW.h", "km", "dm3", "mm2", "kg", "ms", "m", "Hz", "hPa", "kJ", "mA", "N.m",
+};
+
+char const * const g_names[operand_count] =
+{
+    "m", "s", "kg", "N", "Pa", "J", "W", "C", "V", "F", "Ohm", "S", "Wb", "T", "H", "Hz",
+};
+
+void init_operands()
+{
+    for ( int i = 0; i < operand_count; ++i )
+    {
+        g_real[i] = g_seed + i;
+
+        ( g_real[i] * meter() ).swap( g_length[i] );
+        ( g_real[i] * second() ).swap( g_time[i] );
+        ( g_real[i] * square( meter() ) ).swap( g_area[i] );
+    }
+}
+
+/**
+ * a benchmark body runs its operation n times.
+ */
+typedef void (*body_t)( std::size_t n );
+
+/*
+ * baseline:
+ */
+
+void baseline_double_add( std::size_t n )
+{
+    double r = 0;
+    for ( std::size_t i = 0; i < n; ++i )
+        r += g_real[i & operand_mask] + g_real[( i + 1 ) & operand_mask];
+    g_sink = r;
+}
+
+/*
+ * construction and copy:
+ */
+
+void construct_value_dimension( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = quantity( length_d, g_real[i & operand_mask] ).value();
+}
+
+void construct_unit_product( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = ( g_real[i & operand_mask] * meter() ).value();
+}
+
+void copy_construct( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = quantity( g_length[i & operand_mask] ).value();
+}
+
+void copy_assign( std::size_t n )
+{
+    quantity q( meter() );
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        q = g_length[i & operand_mask];
+        g_sink = q.value();
+    }
+}
+
+/*
+ * arithmetic:
+ */
+
+void arithmetic_add( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = ( g_length[i & operand_mask] + g_length[( i + 1 ) & operand_mask] ).value();
+}
+
+void arithmetic_sub( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = ( g_length[i & operand_mask] - g_length[( i + 1 ) & operand_mask] ).value();
+}
+
+void arithmetic_mul( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = ( g_length[i & operand_mask] * g_time[( i + 1 ) & operand_mask] ).value();
+}
+
+void arithmetic_div( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = ( g_length[i & operand_mask] / g_time[( i + 1 ) & operand_mask] ).value();
+}
+
+void arithmetic_add_assign( std::size_t n )
+{
+    quantity q( meter() );
+    for ( std::size_t i = 0; i < n; ++i )
+        q += g_length[i & operand_mask];
+    g_sink = q.value();
+}
+
+void arithmetic_mul_real( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = ( g_length[i & operand_mask] * g_real[( i + 1 ) & operand_mask] ).value();
+}
+
+/*
+ * comparison:
+ */
+
+void compare_less( std::size_t n )
+{
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < n; ++i )
+        count += g_length[i & operand_mask] < g_length[( i + 5 ) & operand_mask];
+    g_sink = double( count );
+}
+
+void compare_equal( std::size_t n )
+{
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < n; ++i )
+        count += g_length[i & operand_mask] == g_length[( i + 5 ) & operand_mask];
+    g_sink = double( count );
+}
+
+/*
+ * powers and roots:
+ */
+
+void math_nth_power( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = nth_power( g_length[i & operand_mask], 3 ).value();
+}
+
+void math_square( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = square( g_length[i & operand_mask] ).value();
+}
+
+void math_sqrt( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = sqrt( g_area[i & operand_mask] ).value();
+}
+
+/*
+ * parsing:
+ */
+
+void parse_to_quantity( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = to_quantity( g_texts[i & operand_mask] ).value();
+}
+
+void parse_parser_reuse( std::size_t n )
+{
+    quantity_parser parser;
+    std::string text;
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        text = g_texts[i & operand_mask];
+        g_sink = parser.try_parse( text ).value().value();
+    }
+}
+
+void parse_unit_cache( std::size_t n )
+{
+    unit_cache cache;
+    std::string text;
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        text = g_texts[i & operand_mask];
+        g_sink = cache.to_quantity( text ).value();
+    }
+}
+
+/*
+ * printing:
+ */
+
+void print_io_to_string( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( io::to_string( g_length[i & operand_mask] / g_time[i & operand_mask] ).size() );
+}
+
+void print_io_format_to( std::size_t n )
+{
+    char buf[80];
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( io::format_to( buf, sizeof buf, g_length[i & operand_mask] ) );
+}
+
+void print_eng_to_string( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( io::eng::to_string( g_length[i & operand_mask] / g_time[i & operand_mask] ).size() );
+}
+
+void print_eng_format_to( std::size_t n )
+{
+    char buf[80];
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( io::eng::format_to( buf, sizeof buf, g_length[i & operand_mask] ) );
+}
+
+/*
+ * registry lookups:
+ */
+
+/// g_names as strings, so that lookups do not construct keys.
+std::string const * name_strings()
+{
+    static std::string names[operand_count];
+    for ( int i = 0; i < operand_count; ++i )
+        names[i] = g_names[i];
+    return names;
+}
+
+void registry_unit( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = unit( g_names[i & operand_mask] ).value();
+}
+
+/// the map lookup and unit function call that unit() used before the unit table.
+void registry_unit_map( std::size_t n )
+{
+    static std::string const * const names = name_strings();
+    detail::unitmap const & m = detail::get_umap();
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = m.find( names[i & operand_mask] )->second().value();
+}
+
+void registry_unit_table( std::size_t n )
+{
+    static std::string const * const names = name_strings();
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = detail::find_predefined_unit( names[i & operand_mask] )->unit.value();
+}
+
+/// the single dimensions of which to_unit_symbol() looks up the names.
+dimensions const * name_dimensions()
+{
+    static std::vector<dimensions> dims;
+    for ( int i = int( dims.size() ); i < operand_count; ++i )
+        dims.push_back( dimensions( i, 1 ) );
+    return &dims[0];
+}
+
+/// unit name lookup in an ordered map.
+void registry_name_map( std::size_t n )
+{
+    static dimensions const * const dims = name_dimensions();
+    static detail::unitnamemap const names( detail::predefined_unit_names() );
+    static std::map<dimensions, std::string> const m( names.begin(), names.end() );
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( m.find( dims[i & operand_mask] )->second.size() );
+}
+
+#if __cplusplus >= 201103L
+/// unit name lookup in a hashed map.
+void registry_name_hash( std::size_t n )
+{
+    static dimensions const * const dims = name_dimensions();
+    static detail::unitnamemap const names( detail::predefined_unit_names() );
+    static std::unordered_map<dimensions, std::string> const m( names.begin(), names.end() );
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( m.find( dims[i & operand_mask] )->second.size() );
+}
+#endif
+
+void registry_has_prefix( std::size_t n )
+{
+    static char const * const prefixes[] = { "k", "M", "m", "u", "G", "n", "da", "x" };
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < n; ++i )
+        count += has_prefix( prefixes[i & 7] );
+    g_sink = double( count );
+}
+
+void registry_to_unit_symbol( std::size_t n )
+{
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = double( to_unit_symbol( ( g_length[i & operand_mask] / g_time[i & operand_mask] ).dimension() ).size() );
+}
+
+void registry_unit_cache( std::size_t n )
+{
+    unit_cache cache;
+    for ( std::size_t i = 0; i < n; ++i )
+        g_sink = cache.unit( g_units[i & operand_mask] ).value();
+}
+
+/*
+ * reductions; an operation is one element of a 4096-element array.
+ */
+
+std::size_t const reduce_size = 4096;
+
+quantity_array const & reduce_operand()
+{
+    static quantity_array a( length_d );
+
+    for ( std::size_t i = a.size(); i < reduce_size; ++i )
+    {
+        a.push_back( g_real[i & operand_mask] * meter() );
+    }
+    return a;
+}
+
+void reduce_quantity_loop( std::size_t n )
+{
+    quantity_array const & a = reduce_operand();
+
+    for ( std::size_t done = 0; done < n; done += reduce_size )
+    {
+        quantity s( length_d, 0 );
+        for ( std::size_t i = 0; i < reduce_size; ++i )
+            s += a.at( i );
+        g_sink = s.value();
+    }
+}
+
+void reduce_sum( std::size_t n )
+{
+    quantity_array const & a = reduce_operand();
+
+    for ( std::size_t done = 0; done < n; done += reduce_size )
+        g_sink = sum( a ).value();
+}
+
+void reduce_dot( std::size_t n )
+{
+    quantity_array const & a = reduce_operand();
+
+    for ( std::size_t done = 0; done < n; done += reduce_size )
+        g_sink = dot( a, a ).value();
+}
+
+void reduce_max( std::size_t n )
+{
+    quantity_array const & a = reduce_operand();
+
+    for ( std::size_t done = 0; done < n; done += reduce_size )
+        g_sink = max( a ).value();
+}
+
+/*
+ * matrix products; an operation is one multiply-add of a 64 x 64 product.
+ */
+
+std::size_t const matrix_size = 64;
+
+quantity_matrix const & matrix_operand()
+{
+    static quantity_matrix a(
+        quantity_matrix::dimensions_type( matrix_size, length_d ),
+        quantity_matrix::dimensions_type( matrix_size, time_interval_d ) );
+
+    for ( std::size_t i = 0; i < matrix_size * matrix_size; ++i )
+        a.data()[i] = g_real[i & operand_mask];
+    return a;
+}
+
+quantity_vector const & vector_operand()
+{
+    static quantity_vector x( quantity_vector::dimensions_type( matrix_size, time_interval_d ), 1.5 );
+    return x;
+}
+
+void matrix_quantity_loop( std::size_t n )
+{
+    quantity_matrix const & a = matrix_operand();
+    quantity_vector const & x = vector_operand();
+
+    std::vector<quantity> elements;
+    for ( std::size_t i = 0; i < matrix_size * matrix_size; ++i )
+        elements.push_back( a.at( i / matrix_size, i % matrix_size ) );
+
+    for ( std::size_t done = 0; done < n; done += matrix_size * matrix_size )
+    {
+        for ( std::size_t i = 0; i < matrix_size; ++i )
+        {
+            quantity y( length_d, 0 );
+            for ( std::size_t j = 0; j < matrix_size; ++j )
+                y += elements[i * matrix_size + j] * x.at( j );
+            g_sink = y.value();
+        }
+    }
+}
+
+void matrix_mat_vec( std::size_t n )
+{
+    quantity_matrix const & a = matrix_operand();
+    quantity_vector const & x = vector_operand();
+
+    for ( std::size_t done = 0; done < n; done += matrix_size * matrix_size )
+        g_sink = ( a * x ).value( 0 );
+}
+
+void matrix_mat_mat( std::size_t n )
+{
+    quantity_matrix const & a = matrix_operand();
+    quantity_matrix const b( transpose( a ) );
+
+    for ( std::size_t done = 0; done < n; done += matrix_size * matrix_size * matrix_size )
+        g_sink = ( a * b ).value( 0, 0 );
+}
+
+/*
+ * formulas; an operation is one row of 0.5 m v^2 + m g h over 4096 rows.
+ */
+
+std::size_t const formula_rows = 4096;
+
+std::vector<quantity_array> const & formula_columns()
+{
+    static std::vector<quantity_array> columns;
+
+    if ( columns.empty() )
+    {
+        columns.push_back( quantity_array( mass_d ) );
+        columns.push_back( quantity_array( quotient( length_d, time_interval_d ) ) );
+        columns.push_back( quantity_array( length_d ) );
+
+        for ( std::size_t i = 0; i < formula_rows; ++i )
+            for ( std::size_t c = 0; c < columns.size(); ++c )
+                columns[c].push_back_value( g_real[( i + c ) & operand_mask] );
+    }
+    return columns;
+}
+
+void formula_quantity_loop( std::size_t n )
+{
+    std::vector<quantity_array> const & columns = formula_columns();
+    quantity const g( 9.81 * meter() / square( second() ) );
+
+    for ( std::size_t done = 0; done < n; done += formula_rows )
+    {
+        for ( std::size_t i = 0; i < formula_rows; ++i )
+        {
+            quantity const m( columns[0].at( i ) ), v( columns[1].at( i ) ), h( columns[2].at( i ) );
+            g_sink = ( 0.5 * m * v * v + m * g * h ).value();
+        }
+    }
+}
+
+void formula_evaluate( std::size_t n )
+{
+    std::vector<quantity_array> const & columns = formula_columns();
+
+    formula_compiler compiler;
+    compiler.column( "m", columns[0].dimension() ).column( "v", columns[1].dimension() ).column( "h", columns[2].dimension() );
+
+    formula const f( compiler.compile( "0.5 * m * v^2 + m * [9.81 m/s2] * h" ) );
+
+    std::vector<Rep const *> data;
+    for ( std::size_t c = 0; c < columns.size(); ++c )
+        data.push_back( columns[c].data() );
+
+    std::vector<Rep> result( formula_rows );
+
+    for ( std::size_t done = 0; done < n; done += formula_rows )
+    {
+        f.evaluate( &data[0], formula_rows, &result[0] );
+        g_sink = result[0];
+    }
+}
+
+/*
+ * the work loops of perf-test.cpp; an operation is one pass of the loop body.
+ * The loops restart every block, as x3 would overflow for large n.
+ */
+
+std::size_t const work_block = 1000000;
+
+template< typename T1, typename T2, typename T3 >
+T1 do_work( std::size_t n, T1 v1, T2 v2, T3 v3 )
+{
+    T1 x1 = v1;
+    for ( std::size_t done = 0; done < n; done += work_block )
+    {
+        T2 x2 = v2;
+        T3 x3 = v3;
+        for ( std::size_t i = done; i < n && i < done + work_block; ++i )
+        {
+            x2 = -x2 - v2;
+            x3 *= 1.00002;
+            x1 += x2 / x3;
+        }
+    }
+    return x1;
+}
+
+quantity const biga( 2 * ohm() );
+quantity const bigb( siemens() / 2 );
+
+quantity do_more_work( std::size_t n, quantity v1, quantity v2, quantity v3 )
+{
+    quantity x1 = v1;
+    for ( std::size_t done = 0; done < n; done += work_block )
+    {
+        quantity x2 = v2;
+        quantity x3 = v3;
+        for ( std::size_t i = done; i < n && i < done + work_block; ++i )
+        {
+            x2 = -x2 - v2;
+            x3 *= to_real( biga * 1.00002 * bigb );
+            x1 += x2 / x3;
+        }
+    }
+    return x1;
+}
+
+quantity do_lazy_work( std::size_t n, quantity v1, quantity v2, quantity v3 )
+{
+    quantity x1 = v1;
+    for ( std::size_t done = 0; done < n; done += work_block )
+    {
+        quantity x2 = v2;
+        quantity x3 = v3;
+        for ( std::size_t i = done; i < n && i < done + work_block; ++i )
+        {
+            assign( x2, -lazy( x2 ) - v2 );
+            x3 *= to_real( biga * 1.00002 * bigb );
+            x1 += lazy( x2 ) / x3;
+        }
+    }
+    return x1;
+}
+
+void work_double( std::size_t n )
+{
+    g_sink = do_work( n, 0.1 * g_seed, 0.2 * g_seed, 0.3 * g_seed );
+}
+
+void work_quantity( std::size_t n )
+{
+    g_sink = do_work( n, 0.1 * g_seed * meter() / second(), 0.2 * g_seed * meter(), 0.3 * g_seed * second() ).value();
+}
+
+void work_quantity_plus( std::size_t n )
+{
+    g_sink = do_more_work( n, 0.1 * g_seed * meter() / second(), 0.2 * g_seed * meter(), 0.3 * g_seed * second() ).value();
+}
+
+void work_lazy( std::size_t n )
+{
+    g_sink = do_lazy_work( n, 0.1 * g_seed * meter() / second(), 0.2 * g_seed * meter(), 0.3 * g_seed * second() ).value();
+}
+
+/**
+ * a named benchmark.
+ */
+struct benchmark
+{
+    char const * name;
+    body_t body;
+    std::size_t block;      ///< body runs whole blocks of this many operations (0: any number)
+};
+
+benchmark const g_benchmarks[] =
+{
+    { "baseline/double-add"        , baseline_double_add },
+    { "construct/value-dimension"  , construct_value_dimension },
+    { "construct/unit-product"     , construct_unit_product },
+    { "copy/construct"             , copy_construct },
+    { "copy/assign"                , copy_assign },
+    { "arithmetic/add"             , arithmetic_add },
+    { "arithmetic/sub"             , arithmetic_sub },
+    { "arithmetic/mul"             , arithmetic_mul },
+    { "arithmetic/div"             , arithmetic_div },
+    { "arithmetic/add-assign"      , arithmetic_add_assign },
+    { "arithmetic/mul-real"        , arithmetic_mul_real },
+    { "compare/less"               , compare_less },
+    { "compare/equal"              , compare_equal },
+    { "math/nth_power"             , math_nth_power },
+    { "math/square"                , math_square },
+    { "math/sqrt"                  , math_sqrt },
+    { "parse/to_quantity"          , parse_to_quantity },
+    { "parse/parser-reuse"         , parse_parser_reuse },
+    { "parse/unit_cache"           , parse_unit_cache },
+    { "print/io-to_string"         , print_io_to_string },
+    { "print/io-format_to"         , print_io_format_to },
+    { "print/eng-to_string"        , print_eng_to_string },
+    { "print/eng-format_to"        , print_eng_format_to },
+    { "registry/unit"              , registry_unit },
+    { "registry/unit-map"          , registry_unit_map },
+    { "registry/unit-table"        , registry_unit_table },
+    { "registry/name-map"          , registry_name_map },
+#if __cplusplus >= 201103L
+    { "registry/name-hash"         , registry_name_hash },
+#endif
+    { "registry/has_prefix"        , registry_has_prefix },
+    { "registry/to_unit_symbol"    , registry_to_unit_symbol },
+    { "registry/unit_cache"        , registry_unit_cache },
+    { "reduce/quantity-loop"       , reduce_quantity_loop,  reduce_size },
+    { "reduce/sum"                 , reduce_sum,            reduce_size },
+    { "reduce/dot"                 , reduce_dot,            reduce_size },
+    { "reduce/max"                 , reduce_max,            reduce_size },
+    { "matrix/quantity-loop"       , matrix_quantity_loop,  matrix_size * matrix_size },
+    { "matrix/mat-vec"             , matrix_mat_vec,        matrix_size * matrix_size },
+    { "matrix/mat-mat"             , matrix_mat_mat,        matrix_size * matrix_size * matrix_size },
+    { "formula/quantity-loop"      , formula_quantity_loop, formula_rows },
+    { "formula/evaluate"           , formula_evaluate,      formula_rows },
+    { "work/double"                , work_double },
+    { "work/quantity"              , work_quantity },
+    { "work/quantity++"            , work_quantity_plus },
+    { "work/lazy"                  , work_lazy },
+};
+
+std::size_t const g_benchmark_count = sizeof g_benchmarks / sizeof g_benchmarks[0];
+
+/**
+ * run settings.
+ */
+struct settings
+{
+    std::vector<std::string> filters;   ///< run benchmarks of which the name contains one of these
+    int reps;                           ///< timed runs
+    int warmup;                         ///< untimed runs
+    double min_time;                    ///< minimum duration of a run [s]
+};
+
+/**
+ * the result of a benchmark.
+ */
+struct result
+{
+    std::string name;
+    std::size_t iterations;             ///< operations per run
+    std::vector<double> samples;        ///< time per operation of each run [ns]
+    double allocations;                 ///< heap allocations per operation
+
+    double median;
+    double p10;
+    double p90;
+    double min;
+    double mean;
+};
+
+/**
+ * the p-th percentile (0..100) of sorted values, interpolated.
+ */
+double percentile( std::vector<double> const & sorted, double p )
+{
+    if ( sorted.empty() )
+    {
+        return 0;
+    }
+
+    double const pos = p / 100 * ( sorted.size() - 1 );
+    std::size_t const i = static_cast<std::size_t>( pos );
+
+    if ( i + 1 >= sorted.size() )
+    {
+        return sorted.back();
+    }
+    return sorted[i] + ( pos - i ) * ( sorted[i + 1] - sorted[i] );
+}
+
+/**
+ * time n operations of body [s].
+ */
+double time_run( body_t body, std::size_t n )
+{
+    double const t0 = now();
+    body( n );
+    return now() - t0;
+}
+
+/**
+ * the number of operations for a run of at least min_time seconds;
+ * a multiple of block, if any, so that each run does what it counts.
+ */
+std::size_t calibrate( body_t body, double min_time, std::size_t block )
+{
+    block = std::max( block, std::size_t( 1 ) );
+
+    std::size_t n = block;
+
+    for ( ;; )
+    {
+        double const t = time_run( body, n );
+
+        if ( t >= min_time )
+        {
+            return n;
+        }
+
+        double const factor = t > 0 ? 1.2 * min_time / t : 10;
+
+        n = static_cast<std::size_t>( n * std::min( 10.0, std::max( 2.0, factor ) ) );
+        n = ( n + block - 1 ) / block * block;
+    }
+}
+
+/**
+ * compute the statistics of the samples of r.
+ */
+void summarize( result & r )
+{
+    std::vector<double> sorted( r.samples );
+    std::sort( sorted.begin(), sorted.end() );
+
+    r.median = percentile( sorted, 50 );
+    r.p10    = percentile( sorted, 10 );
+    r.p90    = percentile( sorted, 90 );
+    r.min    = sorted.front();
+
+    double sum = 0;
+    for ( std::size_t i = 0; i < sorted.size(); ++i )
+    {
+        sum += sorted[i];
+    }
+    r.mean = sum / sorted.size();
+}
+
+/**
+ * run the benchmarks with the given settings. The timed runs of all
+ * benchmarks are interleaved, so that a slow phase of the machine affects
+ * all of them alike, rather than a few of them as a whole.
+ */
+std::vector<result> run( std::vector<benchmark> const & selection, settings const & s, bool progress )
+{
+    std::vector<result> results( selection.size() );
+
+    for ( std::size_t k = 0; k < selection.size(); ++k )
+    {
+        if ( progress )
+        {
+            std::cerr << "calibrating " << selection[k].name << "..." << std::string( 20, ' ' ) << "\r" << std::flush;
+        }
+
+        result & r = results[k];
+        r.name = selection[k].name;
+        r.iterations = calibrate( selection[k].body, s.min_time, selection[k].block );
+        r.allocations = 0;
+
+        for ( int i = 0; i < s.warmup; ++i )
+        {
+            selection[k].body( r.iterations );
+        }
+    }
+
+    for ( int i = 0; i < s.reps; ++i )
+    {
+        if ( progress )
+        {
+            std::cerr << "run " << i + 1 << " of " << s.reps << "..." << std::string( 40, ' ' ) << "\r" << std::flush;
+        }
+
+        for ( std::size_t k = 0; k < selection.size(); ++k )
+        {
+            result & r = results[k];
+
+            std::size_t const a0 = g_allocations;
+            double const t = time_run( selection[k].body, r.iterations );
+            r.allocations += g_allocations - a0;
+
+            r.samples.push_back( 1e9 * t / r.iterations );
+        }
+    }
+
+    for ( std::size_t k = 0; k < selection.size(); ++k )
+    {
+        results[k].allocations /= double( s.reps ) * results[k].iterations;
+        summarize( results[k] );
+    }
+
+    if ( progress )
+    {
+        std::cerr << std::string( 60, ' ' ) << "\r" << std::flush;
+    }
+
+    return results;
+}
+
+/**
+ * true if benchmark name is selected by the filters.
+ */
+bool selected( std::string const & name, std::vector<std::string> const & filters )
+{
+    if ( filters.empty() )
+    {
+        return true;
+    }
+
+    for ( std::size_t i = 0; i < filters.size(); ++i )
+    {
+        if ( std::string::npos != name.find( filters[i] ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * the median time of the named result, or 0.
+ */
+double median_of( std::vector<result> const & results, std::string const & name )
+{
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+        if ( results[i].name == name )
+        {
+            return results[i].median;
+        }
+    }
+    return 0;
+}
+
+/*
+ * machine notes:
+ */
+
+/**
+ * the value of the first line in file path that starts with key, or "".
+ */
+std::string read_field( char const * path, char const * key )
+{
+    std::ifstream is( path );
+    std::string line;
+
+    while ( std::getline( is, line ) )
+    {
+        if ( 0 == line.compare( 0, std::strlen( key ), key ) )
+        {
+            std::string::size_type const pos = line.find( ':' );
+            std::string::size_type const first = line.find_first_not_of( " \t", pos == std::string::npos ? std::strlen( key ) : pos + 1 );
+
+            return first == std::string::npos ? std::string() : line.substr( first );
+        }
+    }
+    return std::string();
+}
+
+/**
+ * the first line of file path, or "".
+ */
+std::string read_line( char const * path )
+{
+    std::ifstream is( path );
+    std::string line;
+    std::getline( is, line );
+    return line;
+}
+
+/**
+ * the machine and build the benchmarks ran on.
+ */
+struct context
+{
+    std::string date;
+    std::string compiler;
+    std::string build;
+    std::string cpu;
+    std::string cpu_mhz;                ///< current frequency as reported [MHz]
+    std::string governor;               ///< frequency scaling governor
+    std::string max_mhz;                ///< maximum frequency [MHz]
+    std::string notes;
+};
+
+std::string compiler_name()
+{
+    std::ostringstream os;
+#if defined( __clang__ )
+    os << "Clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__;
+#elif defined( __GNUC__ )
+    os << "GCC " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__;
+#elif defined( _MSC_VER )
+    os << "MSVC " << _MSC_VER;
+#else
+    os << "Unknown";
+#endif
+    os << " (C++ " << __cplusplus << ")";
+    return os.str();
+}
+
+context get_context()
+{
+    context c;
+
+    char buf[32];
+    std::time_t const t = std::time( 0 );
+    std::strftime( buf, sizeof buf, "%Y-%m-%d %H:%M:%S", std::localtime( &t ) );
+    c.date = buf;
+
+    c.compiler = compiler_name();
+
+#if defined( __OPTIMIZE__ ) || ( defined( _MSC_VER ) && defined( NDEBUG ) )
+    c.build = "optimized";
+#elif defined( _MSC_VER )
+    c.build = "unknown optimization";
+#else
+    c.build = "not optimized";
+#endif
+
+#ifdef _WIN32
+    if ( char const * const cpu = std::getenv( "PROCESSOR_IDENTIFIER" ) )
+    {
+        c.cpu = cpu;
+    }
+#else
+    c.cpu      = read_field( "/proc/cpuinfo", "model name" );
+    c.cpu_mhz  = read_field( "/proc/cpuinfo", "cpu MHz" );
+    c.governor = read_line( "/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor" );
+
+    std::string const max_khz = read_line( "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq" );
+    if ( ! max_khz.empty() )
+    {
+        std::ostringstream os;
+        os << std::atof( max_khz.c_str() ) / 1000;
+        c.max_mhz = os.str();
+    }
+#endif
+
+    if ( c.build != "optimized" )
+    {
+        c.notes += "build is not optimized; ";
+    }
+    if ( ! c.governor.empty() && c.governor != "performance" )
+    {
+        c.notes += "frequency scaling governor is '" + c.governor + "', use 'performance' for stable results; ";
+    }
+    if ( "1" != read_line( "/sys/devices/system/cpu/intel_pstate/no_turbo" ) && ! read_line( "/sys/devices/system/cpu/intel_pstate/no_turbo" ).empty() )
+    {
+        c.notes += "turbo boost is enabled; ";
+    }
+    if ( ! c.notes.empty() )
+    {
+        c.notes.erase( c.notes.size() - 2 );
+    }
+    return c;
+}
+
+/*
+ * reporting:
+ */
+
+void report_text( std::ostream & os, context const & c, settings const & s, std::vector<result> const & results )
+{
+    os <<
+        "Benchmark of run-time quantity library " << version_text << "\n"
+        "Date     : " << c.date << "\n"
+        "Compiler : " << c.compiler << ", " << c.build << "\n"
+        "CPU      : " << ( c.cpu.empty() ? "unknown" : c.cpu ) << "\n";
+
+    if ( ! c.cpu_mhz.empty() || ! c.governor.empty() )
+    {
+        os << "Frequency: " << ( c.cpu_mhz.empty() ? "unknown" : c.cpu_mhz ) << " MHz";
+        if ( ! c.max_mhz.empty()  ) os << ", max " << c.max_mhz << " MHz";
+        if ( ! c.governor.empty() ) os << ", governor " << c.governor;
+        os << "\n";
+    }
+    if ( ! c.notes.empty() )
+    {
+        os << "Note     : " << c.notes << "\n";
+    }
+
+    os << "Runs     : " << s.reps << " timed after " << s.warmup << " warmup, at least " << s.min_time * 1000 << " ms each\n\n";
+
+    char line[160];
+
+    std::sprintf( line, "%-28s %12s %10s %10s %10s %8s\n", "benchmark", "iterations", "median", "p10", "p90", "allocs" );
+    os << line;
+    std::sprintf( line, "%-28s %12s %10s %10s %10s %8s\n", "", "", "[ns/op]", "[ns/op]", "[ns/op]", "[/op]" );
+    os << line;
+
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+        result const & r = results[i];
+
+        std::sprintf( line, "%-28s %12lu %10.2f %10.2f %10.2f %8.2f\n",
+            r.name.c_str(), static_cast<unsigned long>( r.iterations ), r.median, r.p10, r.p90, r.allocations );
+        os << line;
+    }
+
+    double const base = median_of( results, "work/double" );
+
+    if ( base > 0 )
+    {
+        os << "\nRelative running time (lower is better)\n";
+
+        char const * const names[] = { "work/double", "work/quantity", "work/quantity++", "work/lazy" };
+
+        for ( std::size_t i = 0; i < sizeof names / sizeof names[0]; ++i )
+        {
+            if ( double const t = median_of( results, names[i] ) )
+            {
+                std::sprintf( line, "%-28s %10.1f\n", names[i], t / base );
+                os << line;
+            }
+        }
+    }
+}
+
+std::string json_string( std::string const & text )
+{
+    std::string result( "\"" );
+
+    for ( std::string::const_iterator pos = text.begin(); pos != text.end(); ++pos )
+    {
+        if      ( '"'  == *pos ) result += "\\\"";
+        else if ( '\\' == *pos ) result += "\\\\";
+        else if ( static_cast<unsigned char>( *pos ) < ' ' ) result += ' ';
+        else                     result += *pos;
+    }
+    return result + "\"";
+}
+
+std::string json_number( double x )
+{
+    char buf[32];
+    std::sprintf( buf, "%.4f", x );
+    return buf;
+}
+
+void report_json( std::ostream & os, context const & c, settings const & s, std::vector<result> const & results )
+{
+    os <<
+        "{\n"
+        "  \"context\": {\n"
+        "    \"version\": "  << json_string( version_text ) << ",\n"
+        "    \"date\": "     << json_string( c.date ) << ",\n"
+        "    \"compiler\": " << json_string( c.compiler ) << ",\n"
+        "    \"build\": "    << json_string( c.build ) << ",\n"
+        "    \"cpu\": "      << json_string( c.cpu ) << ",\n"
+        "    \"cpu_mhz\": "  << json_string( c.cpu_mhz ) << ",\n"
+        "    \"max_mhz\": "  << json_string( c.max_mhz ) << ",\n"
+        "    \"governor\": " << json_string( c.governor ) << ",\n"
+        "    \"notes\": "    << json_string( c.notes ) << ",\n"
+        "    \"reps\": "     << s.reps << ",\n"
+        "    \"warmup\": "   << s.warmup << ",\n"
+        "    \"min_time_ms\": " << json_number( s.min_time * 1000 ) << "\n"
+        "  },\n"
+        "  \"benchmarks\": [";
+
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+        result const & r = results[i];
+
+        os << ( i ? "," : "" ) << "\n"
+            "    {\n"
+            "      \"name\": " << json_string( r.name ) << ",\n"
+            "      \"iterations\": " << r.iterations << ",\n"
+            "      \"median_ns\": " << json_number( r.median ) << ",\n"
+            "      \"p10_ns\": " << json_number( r.p10 ) << ",\n"
+            "      \"p90_ns\": " << json_number( r.p90 ) << ",\n"
+            "      \"min_ns\": " << json_number( r.min ) << ",\n"
+            "      \"mean_ns\": " << json_number( r.mean ) << ",\n"
+            "      \"allocations\": " << json_number( r.allocations ) << ",\n"
+            "      \"samples_ns\": [";
+
+        for ( std::size_t k = 0; k < r.samples.size(); ++k )
+        {
+            os << ( k ? ", " : "" ) << json_number( r.samples[k] );
+        }
+        os << "]\n"
+            "    }";
+    }
+    os << "\n  ]\n}\n";
+}
+
+/*
+ * baseline files: reading the JSON written by report_json().
+ */
+
+/**
+ * minimal reader for the JSON of a baseline file.
+ */
+class json_reader
+{
+public:
+    explicit json_reader( std::string const & text )
+    : m_text( text ), m_pos( 0 ) {}
+
+    /**
+     * true if the next token is c, which is then consumed.
+     */
+    bool accept( char c )
+    {
+        skip_blanks();
+
+        if ( m_pos < m_text.size() && c == m_text[m_pos] )
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * consume c; throws std::runtime_error if the next token is not c.
+     */
+    void expect( char c )
+    {
+        if ( ! accept( c ) )
+        {
+            fail( std::string( "expecting '" ) + c + "'" );
+        }
+    }
+
+    std::string string()
+    {
+        expect( '"' );
+
+        std::string result;
+
+        while ( m_pos < m_text.size() && '"' != m_text[m_pos] )
+        {
+            if ( '\\' == m_text[m_pos] && m_pos + 1 < m_text.size() )
+            {
+                ++m_pos;
+            }
+            result += m_text[m_pos++];
+        }
+        expect( '"' );
+        return result;
+    }
+
+    double number()
+    {
+        skip_blanks();
+
+        char const * const first = m_text.c_str() + m_pos;
+        char * last = 0;
+        double const x = std::strtod( first, &last );
+
+        if ( last == first )
+        {
+            fail( "expecting a number" );
+        }
+        m_pos += last - first;
+        return x;
+    }
+
+    /**
+     * skip a value of any type.
+     */
+    void skip()
+    {
+        skip_blanks();
+
+        if ( m_pos >= m_text.size() )
+        {
+            fail( "unexpected end" );
+        }
+
+        char const c = m_text[m_pos];
+
+        if ( '"' == c )
+        {
+            string();
+        }
+        else if ( '{' == c || '[' == c )
+        {
+            char const close = '{' == c ? '}' : ']';
+            ++m_pos;
+
+            if ( accept( close ) )
+            {
+                return;
+            }
+            do
+            {
+                if ( '}' == close )
+                {
+                    string();
+                    expect( ':' );
+                }
+                skip();
+            }
+            while ( accept( ',' ) );
+
+            expect( close );
+        }
+        else if ( 0 == m_text.compare( m_pos, 4, "true" ) || 0 == m_text.compare( m_pos, 4, "null" ) )
+        {
+            m_pos += 4;
+        }
+        else if ( 0 == m_text.compare( m_pos, 5, "false" ) )
+        {
+            m_pos += 5;
+        }
+        else
+        {
+            number();
+        }
+    }
+
+private:
+    void skip_blanks()
+    {
+        while ( m_pos < m_text.size() && std::strchr( " \t\r\n", m_text[m_pos] ) )
+        {
+            ++m_pos;
+        }
+    }
+
+    void fail( std::string const & text ) const
+    {
+        std::ostringstream os;
+        os << text << " at offset " << m_pos;
+        throw std::runtime_error( os.str() );
+    }
+
+    std::string m_text;
+    std::size_t m_pos;
+};
+
+/**
+ * read the results and context of baseline file path; throws std::runtime_error.
+ */
+std::vector<result> read_baseline( std::string const & path, context & c )
+{
+    std::ifstream is( path.c_str() );
+
+    if ( ! is )
+    {
+        throw std::runtime_error( "cannot read '" + path + "'" );
+    }
+
+    std::ostringstream text;
+    text << is.rdbuf();
+
+    json_reader json( text.str() );
+    std::vector<result> results;
+
+    json.expect( '{' );
+    do
+    {
+        std::string const key( json.string() );
+        json.expect( ':' );
+
+        if ( "context" == key )
+        {
+            json.expect( '{' );
+            do
+            {
+                std::string const field( json.string() );
+                json.expect( ':' );
+
+                if      ( "cpu"      == field ) c.cpu      = json.string();
+                else if ( "compiler" == field ) c.compiler = json.string();
+                else if ( "date"     == field ) c.date     = json.string();
+                else                            json.skip();
+            }
+            while ( json.accept( ',' ) );
+            json.expect( '}' );
+        }
+        else if ( "benchmarks" == key )
+        {
+            json.expect( '[' );
+            do
+            {
+                result r = result();
+                json.expect( '{' );
+                do
+                {
+                    std::string const field( json.string() );
+                    json.expect( ':' );
+
+                    if      ( "name"        == field ) r.name        = json.string();
+                    else if ( "median_ns"   == field ) r.median      = json.number();
+                    else if ( "allocations" == field ) r.allocations = json.number();
+                    else if ( "samples_ns"  == field )
+                    {
+                        json.expect( '[' );
+                        do
+                        {
+                            r.samples.push_back( json.number() );
+                        }
+                        while ( json.accept( ',' ) );
+                        json.expect( ']' );
+                    }
+                    else
+                    {
+                        json.skip();
+                    }
+                }
+                while ( json.accept( ',' ) );
+                json.expect( '}' );
+
+                results.push_back( r );
+            }
+            while ( json.accept( ',' ) );
+            json.expect( ']' );
+        }
+        else
+        {
+            json.skip();
+        }
+    }
+    while ( json.accept( ',' ) );
+    json.expect( '}' );
+
+    return results;
+}
+
+/*
+ * comparison:
+ */
+
+/**
+ * complementary error function; fractional error below 1.2e-7
+ * (Numerical Recipes, erfcc()).
+ */
+double erfc_approx( double x )
+{
+    double const z = std::fabs( x );
+    double const t = 1 / ( 1 + 0.5 * z );
+    double const r = t * std::exp( -z * z - 1.26551223 + t * ( 1.00002368 + t * ( 0.37409196 + t * ( 0.09678418 +
+        t * ( -0.18628806 + t * ( 0.27886807 + t * ( -1.13520398 + t * ( 1.48851587 +
+        t * ( -0.82215223 + t * 0.17087277 ) ) ) ) ) ) ) ) );
+
+    return x >= 0 ? r : 2 - r;
+}
+
+/**
+ * one-sided p-value of the Mann-Whitney U test for the hypothesis that
+ * values of b tend to be larger than those of a; normal approximation
+ * with tie and continuity correction.
+ */
+double mann_whitney_greater( std::vector<double> const & a, std::vector<double> const & b )
+{
+    std::size_t const n1 = a.size();
+    std::size_t const n2 = b.size();
+    std::size_t const n  = n1 + n2;
+
+    if ( 0 == n1 || 0 == n2 )
+    {
+        return 1;
+    }
+
+    // rank the pooled samples, with mid-ranks for ties:
+    std::vector< std::pair<double, int> > pooled;
+
+    for ( std::size_t i = 0; i < n1; ++i ) pooled.push_back( std::make_pair( a[i], 0 ) );
+    for ( std::size_t i = 0; i < n2; ++i ) pooled.push_back( std::make_pair( b[i], 1 ) );
+
+    std::sort( pooled.begin(), pooled.end() );
+
+    double rank_b = 0;
+    double ties = 0;
+
+    for ( std::size_t i = 0; i < n; )
+    {
+        std::size_t j = i;
+
+        while ( j < n && pooled[j].first == pooled[i].first )
+        {
+            ++j;
+        }
+
+        double const rank = ( i + 1 + j ) / 2.0;
+        double const t = double( j - i );
+
+        for ( std::size_t k = i; k < j; ++k )
+        {
+            if ( pooled[k].second )
+            {
+                rank_b += rank;
+            }
+        }
+
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double const u    = rank_b - n2 * ( n2 + 1 ) / 2.0;
+    double const mean = n1 * n2 / 2.0;
+    double const var  = n1 * n2 / 12.0 * ( ( n + 1 ) - ties / ( double( n ) * ( n - 1 ) ) );
+
+    if ( var <= 0 )
+    {
+        return 1;
+    }
+
+    double const z = ( u - mean - 0.5 ) / std::sqrt( var );
+
+    return 0.5 * erfc_approx( z / std::sqrt( 2.0 ) );
+}
+
+/**
+ * regression thresholds.
+ */
+struct thresholds
+{
+    double alpha;                       ///< significance level of the test
+    double slower;                      ///< minimal median change [%] to report
+    double allocations;                 ///< minimal change of allocations per operation
+};
+
+/**
+ * compare results against baseline; report changes to os and return the
+ * number of regressions.
+ */
+int compare( std::ostream & os, std::vector<result> const & baseline, context const & bc,
+    std::vector<result> const & results, context const & c, thresholds const & th )
+{
+    char line[200];
+    int regressions = 0;
+    int improvements = 0;
+
+    os << "\nComparison with baseline of " << bc.date << "\n";
+
+    if ( bc.cpu != c.cpu || bc.compiler != c.compiler )
+    {
+        os << "Note     : baseline measured with " << bc.compiler << " on " << ( bc.cpu.empty() ? "unknown" : bc.cpu ) <<
+            "; comparisons between machines or compilers are not meaningful.\n";
+    }
+
+    os << "Criteria : slower or faster by more than " << th.slower << "% with p < " << th.alpha <<
+        " (Mann-Whitney U), or more than " << th.allocations << " allocations per operation more\n\n";
+
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+        result const & r = results[i];
+        std::vector<result>::const_iterator b = baseline.begin();
+
+        while ( b != baseline.end() && b->name != r.name )
+        {
+            ++b;
+        }
+
+        if ( b == baseline.end() )
+        {
+            std::sprintf( line, "  new       %-28s not in baseline\n", r.name.c_str() );
+            os << line;
+            continue;
+        }
+
+        double const change = b->median > 0 ? 100 * ( r.median - b->median ) / b->median : 0;
+
+        if ( change > th.slower && mann_whitney_greater( b->samples, r.samples ) < th.alpha )
+        {
+            std::sprintf( line, "  SLOWER    %-28s got %.1f%% slower (median %.2f -> %.2f ns/op, p = %.2g)\n",
+                r.name.c_str(), change, b->median, r.median, mann_whitney_greater( b->samples, r.samples ) );
+            os << line;
+            ++regressions;
+        }
+        else if ( -change > th.slower && mann_whitney_greater( r.samples, b->samples ) < th.alpha )
+        {
+            std::sprintf( line, "  faster    %-28s got %.1f%% faster (median %.2f -> %.2f ns/op, p = %.2g)\n",
+                r.name.c_str(), -change, b->median, r.median, mann_whitney_greater( r.samples, b->samples ) );
+            os << line;
+            ++improvements;
+        }
+
+        if ( r.allocations > b->allocations + th.allocations )
+        {
+            std::sprintf( line, "  ALLOCS    %-28s allocations went from %.2g to %.2g per operation\n",
+                r.name.c_str(), b->allocations, r.allocations );
+            os << line;
+            ++regressions;
+        }
+        else if ( r.allocations < b->allocations - th.allocations )
+        {
+            std::sprintf( line, "  fewer     %-28s allocations went from %.2g to %.2g per operation\n",
+                r.name.c_str(), b->allocations, r.allocations );
+            os << line;
+            ++improvements;
+        }
+    }
+
+    os << "\n" << regressions << " regression(s), " << improvements << " improvement(s) in " << results.size() << " benchmark(s)\n";
+
+    return regressions;
+}
+
+/*
+ * commandline:
+ */
+
+int usage( std::string const progname )
+{
+    std::cout <<
+        "\nUsage: " << progname << " [option...] [filter...]" <<
+        "\n"
+        "\nRun the benchmarks of which the name contains one of the filters, or all."
+        "\n"
+        "\nOptions"
+        "\n        -h, --help: this help."
+        "\n            --list: list the benchmarks."
+        "\n          --reps=n: timed runs per benchmark [15]."
+        "\n        --warmup=n: untimed runs per benchmark [2]."
+        "\n     --min-time=ms: minimum duration of a run [20]."
+        "\n     --json[=file]: write results as JSON to file, or to standard output."
+        "\n   --baseline=file: compare results with the JSON results in file."
+        "\n   --threshold=pct: report median changes larger than pct percent [10]."
+        "\n         --alpha=p: significance level of the Mann-Whitney U test [0.01]."
+        "\n         --version: report version of program."
+        "\n"
+        "\nWith --baseline, the program exits with status 1 if a benchmark got"
+        "\nslower or makes more heap allocations per operation than in the baseline."
+        "\n"
+        "\nExamples"
+        "\n  " << progname << " work/"
+        "\n  " << progname << " --reps=30 --json=baseline.json"
+        "\n  " << progname << " --reps=30 --baseline=baseline.json"
+        "\n";
+
+    return EXIT_SUCCESS;
+}
+
+int error( std::string const text )
+{
+    std::cerr << "Error: " << text << std::endl;
+    return EXIT_FAILURE;
+}
+
+int main( int argc, char *argv[] )
+{
+    (void) argc;
+
+    char const * const progname = "Benchmark";
+
+    settings s;
+    s.reps = 15;
+    s.warmup = 2;
+    s.min_time = 0.020;
+
+    bool opt_list = false;
+    bool opt_json = false;
+    std::string opt_json_path;
+    std::string opt_baseline;
+
+    thresholds th;
+    th.alpha = 0.01;
+    th.slower = 10;
+    th.allocations = 0.1;
+
+    // process options and filters:
+
+    while( *++argv )
+    {
+        char const * const argument = argv[0];
+
+        if ( '-' != argument[0] )
+        {
+            s.filters.push_back( argument );
+            continue;
+        }
+
+        char const * const pos = std::strchr( argument, '=' );
+
+        std::string const option( argument, pos ? pos : argument + std::strlen( argument ) );
+        std::string const value ( pos ? pos + 1 : "" );
+
+        if ( "-h" == option || "--help" == option )
+        {
+            return usage( progname );
+        }
+        else if ( "--list" == option )
+        {
+            opt_list = true;
+        }
+        else if ( "--reps" == option || "--warmup" == option || "--min-time" == option )
+        {
+            char * end = 0;
+            double const x = std::strtod( value.c_str(), &end );
+
+            if ( value.empty() || *end || x < ( "--warmup" == option ? 0 : 1 ) )
+            {
+                return error( "expecting a positive number for option '" + option + "', got '" + value + "'" );
+            }
+
+            if      ( "--reps"   == option ) s.reps = static_cast<int>( x );
+            else if ( "--warmup" == option ) s.warmup = static_cast<int>( x );
+            else                             s.min_time = x / 1000;
+        }
+        else if ( "--threshold" == option || "--alpha" == option )
+        {
+            char * end = 0;
+            double const x = std::strtod( value.c_str(), &end );
+
+            if ( value.empty() || *end || x <= 0 || ( "--alpha" == option && x >= 1 ) )
+            {
+                return error( "expecting a positive number for option '" + option + "', got '" + value + "'" );
+            }
+
+            if ( "--alpha" == option ) th.alpha = x;
+            else                       th.slower = x;
+        }
+        else if ( "--baseline" == option )
+        {
+            opt_baseline = value;
+        }
+        else if ( "--json" == option )
+        {
+            opt_json = true;
+            opt_json_path = value;
+        }
+        else if ( "--version" == option )
+        {
+            std::cout << progname << " " << version_text << std::endl;
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            return error( "invalid option '" + option + "'.\nTry option --help for more information." );
+        }
+    }
+
+    if ( opt_list )
+    {
+        for ( std::size_t i = 0; i < g_benchmark_count; ++i )
+        {
+            std::cout << g_benchmarks[i].name << "\n";
+        }
+        return EXIT_SUCCESS;
+    }
+
+    context bc;
+    std::vector<result> baseline;
+
+    if ( ! opt_baseline.empty() )
+    {
+        try
+        {
+            baseline = read_baseline( opt_baseline, bc );
+        }
+        catch ( std::exception const & e )
+        {
+            return error( "baseline '" + opt_baseline + "': " + e.what() );
+        }
+    }
+
+    init_operands();
+
+    // create the unit tables before timing:
+    unit( "m" );
+
+    std::vector<benchmark> selection;
+
+    for ( std::size_t i = 0; i < g_benchmark_count; ++i )
+    {
+        if ( selected( g_benchmarks[i].name, s.filters ) )
+        {
+            selection.push_back( g_benchmarks[i] );
+        }
+    }
+
+    std::vector<result> const results( run( selection, s, ! opt_json || ! opt_json_path.empty() ) );
+
+    context const c( get_context() );
+
+    std::ostream & os = opt_json && opt_json_path.empty() ? std::cerr : std::cout;
+
+    if ( opt_json && opt_json_path.empty() )
+    {
+        report_json( std::cout, c, s, results );
+    }
+    else
+    {
+        report_text( std::cout, c, s, results );
+    }
+
+    if ( opt_json && ! opt_json_path.empty() )
+    {
+        std::ofstream json( opt_json_path.c_str() );
+
+        if ( ! json )
+        {
+            return error( "cannot write '" + opt_json_path + "'" );
+        }
+        report_json( json, c, s, results );
+    }
+
+    if ( ! opt_baseline.empty() && compare( os, baseline, bc, results, c, th ) > 0 )
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * end of file
+ */
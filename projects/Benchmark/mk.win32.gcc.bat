@@ -0,0 +1 @@
+mingw32-make.exe -f Makefile.win32.gcc %*
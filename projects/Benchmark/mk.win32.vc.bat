@@ -0,0 +1 @@
+nmake -nologo -f Makefile.win32.vc %*
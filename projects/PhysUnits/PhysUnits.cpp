@@ -17,10 +17,14 @@
 #define PHYS_UNITS_MICRO_GLYPH "u"
 
 #include "phys/units/io.hpp"
+#include "phys/units/io_bulk.hpp"
 #include "phys/units/quantity.hpp"
 
 #include <iostream>
+#include <cstdio>
 #include <cstring>
+#include <iterator>
+#include <vector>
 
 #ifdef PHYS_UNITS_COMPILER_IS_MSVC
 # include <io.h>
@@ -29,8 +33,18 @@
 # include <unistd.h>
 #endif
 
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
 char const * const version_text =
-    "1.4 (12 October 2012)";
+    "1.5 (18 October 2026)";
 
 char const * const copyright_text =
     "Copyright 2012, Universiteit Leiden";
@@ -77,28 +91,48 @@ int usage( std::string const progname )
 {
     std::cout <<
         "\nUsage: " << progname << " [option...] [--] [-] [\"expression\"...]" <<
+        "\n       " << progname << " --batch [option...] [--] [file...]" <<
         "\n"
         "\nParse the unit expressions given on the commandline or read from standard"
         "\ninput and present each resulting quantity in engineering notation and as"
         "\nunit expressed in the seven SI base units."
         "\n"
+        "\nIn batch mode, parse each line of the given files, or of standard input,"
+        "\nand write one result per line; report failing lines on standard error."
+        "\n"
         "\nOptions"
         "\n      -h, --help: this help."
+        "\n     -b, --batch: batch mode for files or standard input."
         "\n   -d, --dimless: accept dimensionless quantities."
         "\n  -e, --escape=c: define escape character for extended units [!]."
         "\n    -x, --extend: define units when first encountered [no extend]."
+        "\n  -f, --format=f: batch output format: eng, si or json [eng]."
+        "\n    -j, --jobs=n: batch conversion with n threads [1]."
+        "\n     --to=u, -tu: batch conversion to unit u, e.g. kW.h [SI base units]."
+        "\n         --stats: report throughput, timings and unit cache use at exit."
         "\n         --debug: report debug info [no debug]."
         "\n       --version: report version of program."
         "\n              --: end option section."
         "\n               -: read from standard input."
         "\n"
         "\nOption --escape implies option --extend."
+        "\nOption --extend implies option --jobs=1."
+        "\nOptions --to and --stats imply option --batch."
+        "\nOption --jobs requires a program compiled with OpenMP."
+        "\n"
+        "\nBatch output formats"
+        "\n   eng: '3 km': 3 km [m]"
+        "\n    si: 3000 m"
+        "\n  json: {\"input\":\"3 km\",\"value\":3000,\"unit\":\"m\"}"
+        "\n  with --to=mm, eng: '3 km': 3e+06 mm, si: 3000000 mm"
         "\n"
         "\nExamples"
         "\n  " << progname << " \"42 km\" \"1 dm3\" \"2 (3.14 mm)2\""
         "\n  " << progname << " \"330 m/s\" \"9.8 m/s2\" \"9.8 m.s-2\" \"9.8 m s-2\""
         "\n  " << progname << " \"3 kHz\" \"3 1/s\" \"3 kV.A\" \"2.2 kOhm\""
         "\n  " << progname << " --extend \"3 Foo\" \"4 !foo\" \"ffoo\" \"f!foo\" \"J2/ffoo\""
+        "\n  " << progname << " --batch --format=si --jobs=8 values.txt > si-values.txt"
+        "\n  " << progname << " --to=kW.h --format=si --stats < energy.txt > energy-kWh.txt"
         "\n"
         "\nSyntax (EBNF)"
         "\n     expression = [magnitude] factor { (\" \"|\".\"|\"/\") factor } ."
@@ -154,6 +188,45 @@ int expect_character( char const * const option_str, char const * const value_st
     return value_str[0];
 }
 
+/**
+ * check for and return positive number from option argument.
+ */
+int expect_number( char const * const option_str, char const * const value_str )
+{
+    int const n = atoi( value_str );
+
+    if ( n <= 0 )
+    {
+        exit( error( std::string() +
+            "expecting positive number for option '" + option_str + "', got '" + value_str + "'\n"
+            "Try option --help for more information." ) );
+    }
+    return n;
+}
+
+/**
+ * parser settings from the commandline.
+ */
+struct parser_options
+{
+    bool debug;
+    bool extend;
+    bool dimless;
+    char escape;
+};
+
+/**
+ * apply parser settings.
+ */
+void configure( phys::units::quantity_parser & parser, parser_options const & opt )
+{
+    parser.
+        debug ( opt.debug  ).
+        extend( opt.extend ).
+        escape( opt.escape ).
+        dimensionless( opt.dimless );
+}
+
 /**
  * report text and quantity created from that.
  */
@@ -269,6 +342,597 @@ void interactive( std::string const progname, phys::units::quantity_parser & par
     }
 }
 
+/**
+ * batch output format.
+ */
+enum output_format
+{
+    format_eng,
+    format_si,
+    format_json
+};
+
+/**
+ * batch settings from the commandline.
+ */
+struct batch_options
+{
+    parser_options parser;
+    output_format format;
+    int jobs;
+    std::string to;     // target unit, empty for SI base units
+    bool stats;
+};
+
+/**
+ * batch counters and stage timings in seconds.
+ */
+struct batch_stats
+{
+    batch_stats()
+    : lines( 0 ), errors( 0 ), bytes( 0 ), hits( 0 ), misses( 0 )
+    , read( 0 ), parse( 0 ), format( 0 ), write( 0 ) {}
+
+    batch_stats & operator+=( batch_stats const & other )
+    {
+        lines  += other.lines;
+        errors += other.errors;
+        bytes  += other.bytes;
+        hits   += other.hits;
+        misses += other.misses;
+        read   += other.read;
+        parse  += other.parse;
+        format += other.format;
+        write  += other.write;
+        return *this;
+    }
+
+    std::size_t lines;      // converted lines
+    std::size_t errors;     // failed lines and files
+    std::size_t bytes;      // bytes read
+    std::size_t hits;       // unit cache hits
+    std::size_t misses;     // unit cache misses
+    double read;            // reading input
+    double parse;           // parsing lines
+    double format;          // formatting results
+    double write;           // writing output
+};
+
+/**
+ * seconds since an arbitrary moment, for stage timings.
+ */
+double now()
+{
+#ifdef _WIN32
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    return double( count.QuadPart ) / double( frequency.QuadPart );
+#else
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+/**
+ * converts the text of a line to a quantity; one per thread.
+ *
+ * Text such as "12.5 km/h" is split into magnitude and unit the way the
+ * parser scans it, and the unit is parsed once and then taken from a cache.
+ * Other text, and text of which the unit fails, is parsed as a whole, so
+ * that results and error messages are those of the parser.
+ */
+class converter
+{
+public:
+    explicit converter( parser_options const & opt )
+    : m_cache( phys::units::extend( opt.extend ), phys::units::dimensionless( opt.dimless ), opt.escape )
+    {
+        configure( m_parser, opt );
+    }
+
+    phys::units::quantity_result convert( std::string const & text )
+    {
+        using namespace phys::units;
+
+        // characters of a magnitude, as scanned by the parser:
+        char const * const real_chars = "0123456789.eE+-";
+
+        std::string::size_type const first      = text.find_first_not_of( " \t" );
+        std::string::size_type const num_last   = text.find_first_not_of( real_chars, first );
+        std::string::size_type const unit_first = text.find_first_not_of( " \t", num_last );
+
+        if ( std::string::npos != unit_first && 0 == strchr( real_chars, text[unit_first] ) )
+        {
+            m_unit.assign( text, unit_first, text.find_last_not_of( " \t" ) + 1 - unit_first );
+
+            if ( quantity const * const u = m_cache.find( m_unit ) )
+            {
+                double const value = first == num_last ?
+                    1.0 : strtod( text.substr( first, num_last - first ).c_str(), 0 );
+
+                return quantity_result( quantity( u->dimension(), value * u->value() ) );
+            }
+        }
+        return m_parser.try_parse( text );
+    }
+
+    phys::units::unit_cache const & cache() const
+    {
+        return m_cache;
+    }
+
+private:
+    phys::units::quantity_parser m_parser;
+    phys::units::unit_cache m_cache;
+    std::string m_unit;
+};
+
+/**
+ * append quantity's unit in SI base units; cached per dimension.
+ */
+void append_base_symbol( std::string & out, phys::units::quantity const & q )
+{
+    using namespace phys::units;
+
+    detail::symbol_cache_entry const * const entry = detail::cached_unit_symbol( q.dimension(), base_symbols() );
+
+    if ( entry )
+    {
+        out.append( entry->symbol, entry->length );
+    }
+    else
+    {
+        out += to_unit_symbol( q, base_symbols() );
+    }
+}
+
+/**
+ * append text as JSON string.
+ */
+void append_json_string( std::string & out, std::string const & text )
+{
+    out += '"';
+
+    for ( std::string::const_iterator pos = text.begin(); pos != text.end(); ++pos )
+    {
+        unsigned char const chr = static_cast<unsigned char>( *pos );
+
+        if ( '"' == chr || '\\' == chr )
+        {
+            out += '\\';
+            out += *pos;
+        }
+        else if ( chr < 0x20 )
+        {
+            char buf[8];
+            sprintf( buf, "\\u%04x", chr );
+            out += buf;
+        }
+        else
+        {
+            out += *pos;
+        }
+    }
+
+    out += '"';
+}
+
+/**
+ * append value with given precision (0: shortest exact); null in JSON if not finite.
+ */
+void append_number( std::string & out, double const value, int const precision, bool const json )
+{
+    if ( json && ( value != value || value - value != 0 ) )
+    {
+        out += "null";
+        return;
+    }
+
+    char buf[32];
+    out.append( buf, phys::units::detail::format_real( buf, value, precision ) );
+}
+
+/**
+ * append line's error to err, and to out for JSON.
+ */
+void append_error(
+    std::string const & text, std::string const & message, output_format format,
+    std::string const & name, std::size_t line, std::string & out, std::string & err )
+{
+    char buf[32];
+    sprintf( buf, ":%lu: ", static_cast<unsigned long>( line ) );
+
+    err += "PhysUnits: " + name + buf + message + "\n";
+
+    if ( format_json == format )
+    {
+        out += "{\"input\":";
+        append_json_string( out, text );
+        out += ",\"error\":";
+        append_json_string( out, message );
+        out += "}\n";
+    }
+}
+
+/**
+ * append the result for one line in the requested format to out, or its
+ * error to err; convert to target if given. Return false on error.
+ */
+bool convert_line(
+    std::string const & text, converter & conv, phys::units::quantity const * target,
+    batch_options const & opt, std::string const & name, std::size_t line,
+    std::string & out, std::string & err, batch_stats * stats )
+{
+    using namespace phys::units;
+
+    double const t0 = stats ? now() : 0;
+
+    quantity_result const r( conv.convert( text ) );
+
+    double const t1 = stats ? now() : 0;
+
+    if ( ! r.ok() )
+    {
+        append_error( text, r.message(), opt.format, name, line, out, err );
+        return false;
+    }
+
+    quantity const & q = r.value();
+
+    if ( target && target->dimension() != q.dimension() )
+    {
+        append_error( text, "cannot convert to '" + opt.to + "': incompatible dimension", opt.format, name, line, out, err );
+        return false;
+    }
+
+    switch ( opt.format )
+    {
+        case format_eng:
+            out += '\'';
+            out += text;
+            out += "': ";
+            if ( target )
+            {
+                append_number( out, q.value() / target->value(), 6, false );
+                out += ' ';
+                out += opt.to;
+            }
+            else
+            {
+                io::eng::format_to( std::back_inserter( out ), q );
+                out += " [";
+                append_base_symbol( out, q );
+                out += ']';
+            }
+            out += '\n';
+            break;
+
+        case format_si:
+            if ( target )
+            {
+                append_number( out, q.value() / target->value(), 0, false );
+                out += ' ';
+                out += opt.to;
+            }
+            else
+            {
+                io::format_to( std::back_inserter( out ), q, io::format_options( 0, base_symbols() ) );
+            }
+            out += '\n';
+            break;
+
+        case format_json:
+            out += "{\"input\":";
+            append_json_string( out, text );
+            out += ",\"value\":";
+            append_number( out, target ? q.value() / target->value() : q.value(), 0, true );
+            out += ",\"unit\":";
+            if ( target )
+            {
+                append_json_string( out, opt.to );
+            }
+            else
+            {
+                out += '"';
+                append_base_symbol( out, q );
+                out += '"';
+            }
+            out += "}\n";
+            break;
+    }
+
+    if ( stats )
+    {
+        double const t2 = now();
+        stats->parse  += t1 - t0;
+        stats->format += t2 - t1;
+    }
+    return true;
+}
+
+/**
+ * convert the lines in [first, last), starting at line number line.
+ */
+void convert_lines(
+    char const * first, char const * last, std::size_t line,
+    converter & conv, phys::units::quantity const * target, batch_options const & opt,
+    std::string const & name, std::string & out, std::string & err, batch_stats & stats )
+{
+    std::string text;
+
+    for ( char const * pos = first; pos != last; ++line )
+    {
+        char const * const nl = static_cast<char const *>( memchr( pos, '\n', last - pos ) );
+        char const * end = nl ? nl : last;
+
+        if ( end != pos && '\r' == end[-1] )
+        {
+            --end;
+        }
+
+        text.assign( pos, end );
+
+        if ( std::string::npos != text.find_first_not_of( " \t" ) )
+        {
+            ++stats.lines;
+
+            if ( ! convert_line( text, conv, target, opt, name, line, out, err, opt.stats ? &stats : 0 ) )
+            {
+                ++stats.errors;
+            }
+        }
+
+        pos = nl ? nl + 1 : last;
+    }
+}
+
+/**
+ * convert a block of whole lines, with several threads if requested, and
+ * write the results in order.
+ */
+void convert_block(
+    char const * first, char const * last, std::size_t line,
+    std::vector<converter *> const & conv, phys::units::quantity const * target,
+    batch_options const & opt, std::string const & name, batch_stats & stats )
+{
+    using namespace phys::units;
+
+    std::vector<detail::bulk_chunk> chunks( detail::split_lines( first, last, 4 * opt.jobs ) );
+
+    int const nchunks = static_cast<int>( chunks.size() );
+
+    for ( int i = 0; i < nchunks; ++i )
+    {
+        chunks[i].line = line;
+        line += detail::count_lines( chunks[i].first, chunks[i].last );
+    }
+
+    std::vector<std::string> out( nchunks );
+    std::vector<std::string> err( nchunks );
+    std::vector<batch_stats> chunk_stats( nchunks );
+
+#ifdef _OPENMP
+# pragma omp parallel for num_threads( opt.jobs ) schedule( dynamic, 1 )
+#endif
+    for ( int i = 0; i < nchunks; ++i )
+    {
+#ifdef _OPENMP
+        converter & c = *conv[ omp_get_thread_num() ];
+#else
+        converter & c = *conv[ 0 ];
+#endif
+        out[i].reserve( 2 * ( chunks[i].last - chunks[i].first ) );
+        convert_lines( chunks[i].first, chunks[i].last, chunks[i].line, c, target, opt, name, out[i], err[i], chunk_stats[i] );
+    }
+
+    double const t0 = opt.stats ? now() : 0;
+
+    for ( int i = 0; i < nchunks; ++i )
+    {
+        fwrite( out[i].data(), 1, out[i].size(), stdout );
+
+        if ( ! err[i].empty() )
+        {
+            fflush( stdout );
+            fwrite( err[i].data(), 1, err[i].size(), stderr );
+        }
+        stats += chunk_stats[i];
+    }
+
+    if ( opt.stats )
+    {
+        stats.write += now() - t0;
+    }
+}
+
+/**
+ * convert the lines of a stream in blocks.
+ */
+void convert_stream(
+    FILE * file, std::vector<converter *> const & conv, phys::units::quantity const * target,
+    batch_options const & opt, std::string const & name, batch_stats & stats )
+{
+    std::vector<char> buffer( opt.jobs * ( 1 << 20 ) );
+    std::size_t size = 0;
+    std::size_t line = 1;
+
+    for ( ; ; )
+    {
+        if ( size == buffer.size() )
+        {
+            buffer.resize( 2 * buffer.size() );
+        }
+
+        double const t0 = opt.stats ? now() : 0;
+
+        std::size_t const got = fread( &buffer[0] + size, 1, buffer.size() - size, file );
+
+        if ( opt.stats )
+        {
+            stats.read += now() - t0;
+        }
+
+        size += got;
+        stats.bytes += got;
+
+        if ( 0 == got )
+        {
+            if ( size > 0 )
+            {
+                convert_block( &buffer[0], &buffer[0] + size, line, conv, target, opt, name, stats );
+            }
+            return;
+        }
+
+        // convert the whole lines, keep the rest for the next block:
+
+        std::size_t end = size;
+
+        while ( end > 0 && '\n' != buffer[end - 1] )
+        {
+            --end;
+        }
+
+        if ( end > 0 )
+        {
+            convert_block( &buffer[0], &buffer[0] + end, line, conv, target, opt, name, stats );
+            line += phys::units::detail::count_lines( &buffer[0], &buffer[0] + end );
+
+            std::copy( buffer.begin() + end, buffer.begin() + size, buffer.begin() );
+            size -= end;
+        }
+    }
+}
+
+/**
+ * report throughput, stage timings and unit cache use on standard error.
+ */
+void report_stats( batch_stats const & stats, double const seconds, int const jobs )
+{
+    double const mb = stats.bytes / 1e6;
+    double const lookups = double( stats.hits + stats.misses );
+
+    fprintf( stderr,
+        "PhysUnits: %lu lines, %lu errors, %.1f MB in %.3f s: %.0f lines/s, %.1f MB/s\n"
+        "PhysUnits: read %.3f s, parse %.3f s, format %.3f s, write %.3f s%s\n"
+        "PhysUnits: unit cache: %.2f%% hits (%lu hits, %lu misses)\n",
+        static_cast<unsigned long>( stats.lines ), static_cast<unsigned long>( stats.errors ),
+        mb, seconds, seconds > 0 ? stats.lines / seconds : 0.0, seconds > 0 ? mb / seconds : 0.0,
+        stats.read, stats.parse, stats.format, stats.write,
+        jobs > 1 ? " (parse and format summed over all jobs)" : "",
+        lookups > 0 ? 100 * stats.hits / lookups : 0.0,
+        static_cast<unsigned long>( stats.hits ), static_cast<unsigned long>( stats.misses ) );
+}
+
+/**
+ * batch mode: convert the lines of the given files, or of standard input;
+ * return EXIT_FAILURE if a line or file failed.
+ */
+int batch( char * argv[], batch_options opt )
+{
+    using namespace phys::units;
+
+    double const start = now();
+
+    if ( opt.parser.extend )
+    {
+        // extending defines units in a table shared by all threads:
+        opt.jobs = 1;
+    }
+
+    // the target unit is parsed once:
+
+    quantity target;
+
+    if ( ! opt.to.empty() )
+    {
+        quantity_parser parser;
+        configure( parser, opt.parser );
+
+        quantity_result const r( parser.try_parse( opt.to ) );
+
+        if ( ! r.ok() )
+        {
+            return error( r.message() );
+        }
+
+        // the target counts as written, so that --to="2 m" divides by 2 m:
+
+        double const t = r.value().value();
+
+        if ( 0 == t || t != t || t - t != 0 )
+        {
+            return error( "target unit '" + opt.to + "' is zero or not finite" );
+        }
+
+        quantity( r.value() ).swap( target );
+    }
+
+    // create the unit tables before the threads use them:
+    detail::get_umap();
+    detail::get_unit_table();
+    detail::get_unit_scanner();
+    detail::get_xmap();
+
+    std::vector<converter *> conv( opt.jobs );
+
+    for ( int i = 0; i < opt.jobs; ++i )
+    {
+        conv[i] = new converter( opt.parser );
+    }
+
+    quantity const * const ptarget = opt.to.empty() ? 0 : &target;
+
+    batch_stats stats;
+
+    if ( 0 == *argv )
+    {
+        convert_stream( stdin, conv, ptarget, opt, "-", stats );
+    }
+
+    for ( ; *argv; ++argv )
+    {
+        std::string const name( *argv );
+
+        if ( "-" == name )
+        {
+            convert_stream( stdin, conv, ptarget, opt, name, stats );
+            continue;
+        }
+
+        FILE * const file = fopen( name.c_str(), "rb" );
+
+        if ( 0 == file )
+        {
+            (void) error( "cannot open file '" + name + "'" );
+            ++stats.errors;
+            continue;
+        }
+
+        convert_stream( file, conv, ptarget, opt, name, stats );
+        fclose( file );
+    }
+
+    fflush( stdout );
+
+    for ( int i = 0; i < opt.jobs; ++i )
+    {
+        stats.hits   += conv[i]->cache().hits();
+        stats.misses += conv[i]->cache().misses();
+        delete conv[i];
+    }
+
+    if ( opt.stats )
+    {
+        report_stats( stats, now() - start, opt.jobs );
+    }
+
+    return stats.errors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 /**
  * main program.
  */
@@ -282,10 +946,15 @@ int main( int argc, char *argv[] )
         bool opt_extend = false;
         bool opt_dimless = false;
         char opt_escape = '!';
+        bool opt_batch = false;
+        int opt_jobs = 1;
+        output_format opt_format = format_eng;
+        std::string opt_to;
+        bool opt_stats = false;
 
         // process options:
 
-        while( *++argv && '-' == *argv[0] )
+        while( *++argv && '-' == *argv[0] && '\0' != argv[0][1] )
         {
             // argument such as: -a=1.23, --alpha=1.23, --trace
             char * const argument = argv[0];
@@ -320,6 +989,41 @@ int main( int argc, char *argv[] )
             {
                 return usage( progname );
             }
+            else if ( strcmp( "-b", option) == 0 || strcmp( "--batch", option ) == 0 )
+            {
+                opt_batch = true;
+            }
+            else if ( strcmp( "-j", option) == 0 || strcmp( "--jobs", option ) == 0 )
+            {
+                opt_jobs = expect_number( option, value );
+            }
+            else if ( strncmp( "-t", option, 2 ) == 0 && strlen( option ) > 2 )
+            {
+                opt_to = option + 2;
+                opt_batch = true;
+            }
+            else if ( strcmp( "--to", option ) == 0 )
+            {
+                opt_to = value;
+                opt_batch = true;
+            }
+            else if ( strcmp( "--stats", option ) == 0 )
+            {
+                opt_stats = true;
+                opt_batch = true;
+            }
+            else if ( strcmp( "-f", option) == 0 || strcmp( "--format", option ) == 0 )
+            {
+                if      ( strcmp( "eng" , value ) == 0 ) opt_format = format_eng;
+                else if ( strcmp( "si"  , value ) == 0 ) opt_format = format_si;
+                else if ( strcmp( "json", value ) == 0 ) opt_format = format_json;
+                else
+                {
+                    return error( std::string() +
+                        "expecting eng, si or json for option '" + option + "', got '" + value + "'\n"
+                        "Try option --help for more information." );
+                }
+            }
             else if ( strcmp( "-d", option) == 0 || strcmp( "--dimless", option ) == 0
                                                  || strcmp( "--dimensionless", option ) == 0 )
             {
@@ -350,6 +1054,17 @@ int main( int argc, char *argv[] )
             }
         }
 
+        parser_options const popt = { opt_debug, opt_extend, opt_dimless, opt_escape };
+
+        // batch mode:
+
+        if ( opt_batch )
+        {
+            batch_options const bopt = { popt, opt_format, opt_jobs, opt_to, opt_stats };
+
+            return batch( argv, bopt );
+        }
+
         // no arguments, show help:
 
         if ( 0 == *argv )
@@ -366,12 +1081,7 @@ int main( int argc, char *argv[] )
             std::string const argument( *argv++ );
 
             quantity_parser parser;
-
-            parser.
-                debug ( opt_debug  ).
-                extend( opt_extend ).
-                escape( opt_escape ).
-                dimensionless( opt_dimless );
+            configure( parser, popt );
 
             if ( "-" == argument )
             {
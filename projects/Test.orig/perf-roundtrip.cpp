@@ -0,0 +1,119 @@
+//
+//      perf-roundtrip.cpp - performance test for round-trip quantity output
+//
+//	Copyright 2012 Universiteit Leiden. All rights reserved.
+//
+//	Distributed under the Boost Software License, Version 1.0. (See accompanying
+//	file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+/*
+	This program measures the throughput of writing quantities such that
+	they read back exactly: via a stream with setprecision(17), via the
+	roundtrip manipulator and via format_to() into a buffer. It also
+	measures reading them back and counts values that do not round trip.
+*/
+
+#include "phys/units/io.hpp"
+#include "phys/units/quantity.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <time.h>
+
+using namespace phys::units;
+using namespace phys::units::io;
+using namespace std;
+
+const int value_count = 200000;
+
+vector<quantity> make_values()
+{
+	quantity const unit[] = { meter(), volt() / ampere(), newton(), meter() / second() };
+
+	vector<quantity> values;
+	values.reserve( value_count );
+
+	unsigned long state = 12345;
+	for( int i = 0; i < value_count; i++ )
+	{
+		state = ( state * 1103515245u + 12345u ) & 0xffffffffu;
+		values.push_back( ( state / 4294967296.0 ) * 1000.0 * unit[ i % 4 ] );
+	}
+	return values;
+}
+
+size_t write_stream( vector<quantity> const & values, ostream & ( *mode )( ostream & ), int precision )
+{
+	size_t length = 0;
+	for( size_t i = 0; i < values.size(); i++ )
+	{
+		ostringstream os;
+		os << setprecision( precision ) << mode << values[i];
+		length += os.str().size();
+	}
+	return length;
+}
+
+size_t write_buffer( vector<quantity> const & values, vector<string> & texts )
+{
+	size_t length = 0;
+	char buf[ 64 ];
+	for( size_t i = 0; i < values.size(); i++ )
+	{
+		length += format_to( buf, sizeof buf, values[i] );
+		texts[i] = buf;
+	}
+	return length;
+}
+
+int read_back( vector<quantity> const & values, vector<string> const & texts )
+{
+	int failures = 0;
+	for( size_t i = 0; i < values.size(); i++ )
+	{
+		quantity const q = to_quantity( texts[i] );
+		if( q.value() != values[i].value() || q.dimension() != values[i].dimension() )
+		{
+			failures++;
+		}
+	}
+	return failures;
+}
+
+int main()
+{
+	cout << "Performance test of round-trip quantity output." << endl;
+
+	vector<quantity> const values = make_values();
+	vector<string> texts( values.size() );
+
+	clock_t t0 = clock();
+
+	size_t n1 = write_stream( values, noroundtrip, 17 );
+
+	clock_t t1 = clock();
+
+	size_t n2 = write_stream( values, roundtrip, 6 );
+
+	clock_t t2 = clock();
+
+	size_t n3 = write_buffer( values, texts );
+
+	clock_t t3 = clock();
+
+	int failures = read_back( values, texts );
+
+	clock_t t4 = clock();
+
+	const double cps = CLOCKS_PER_SEC;
+	cout << "values = " << value_count << endl;
+	cout << "setprecision(17) stream = " << (t1-t0)/cps * 1e6 / value_count << " usec/value, " << n1 / double( value_count ) << " chars/value" << endl;
+	cout << "roundtrip stream =        " << (t2-t1)/cps * 1e6 / value_count << " usec/value, " << n2 / double( value_count ) << " chars/value" << endl;
+	cout << "format_to buffer =        " << (t3-t2)/cps * 1e6 / value_count << " usec/value, " << n3 / double( value_count ) << " chars/value" << endl;
+	cout << "to_quantity read back =   " << (t4-t3)/cps * 1e6 / value_count << " usec/value" << endl;
+	cout << "round-trip failures = " << failures << endl;
+
+	return failures != 0;
+}
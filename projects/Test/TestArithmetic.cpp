@@ -94,6 +94,89 @@ TEST_CASE( "quantity/operator/arithmetic/exception", "Quantity arithmetic operat
     REQUIRE_THROWS_AS( q = second(), incompatible_dimension_error );
 }
 
+TEST_CASE( "quantity/operator/arithmetic/result", "Quantity non-throwing arithmetic" )
+{
+    quantity_result const sum( try_add( 2 * meter(), 3 * meter() ) );
+
+    REQUIRE( sum.ok() );
+    REQUIRE( b( sum.value() ) == "5.000000 m" );
+    REQUIRE( b( try_subtract( 2 * meter(), 3 * meter() ).value() ) == "-1.000000 m" );
+
+    quantity_result const err( try_add( meter(), second() ) );
+
+    REQUIRE( !err.ok() );
+    REQUIRE( err.code() == errc::incompatible_dimension );
+    REQUIRE( err.message() == "quantity: incompatible dimension in operator+: lhs:1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,, rhs:0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0," );
+}
+
+TEST_CASE( "quantity/operator/arithmetic/error", "Quantity dimension error message" )
+{
+    std::string const msg( "quantity: incompatible dimension in operator+: lhs:1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,, rhs:0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0," );
+
+    try
+    {
+        meter() + second();
+        FAIL( "Expect incompatible dimension error" );
+    }
+    catch ( incompatible_dimension_error const & e )
+    {
+        REQUIRE( e.code() == errc::incompatible_dimension );
+        REQUIRE( e.what() == msg );
+        REQUIRE( e.what() == msg );
+    }
+
+    incompatible_dimension_error const e( std::string( "my operation" ), length_d, time_interval_d );
+
+    REQUIRE( std::string( e.what() ).find( "incompatible dimension in my operation: " ) != std::string::npos );
+    REQUIRE( dimension_error( "quantity: text" ).what() == std::string( "quantity: text" ) );
+}
+
+namespace {
+
+int violation_count = 0;
+
+void count_violation( char const *, dimensions const &, dimensions const & )
+{
+    ++violation_count;
+}
+
+}
+
+TEST_CASE( "quantity/operator/arithmetic/unchecked", "Quantity arithmetic without dimension checks" )
+{
+    quantity m( meter() );
+    quantity s( second() );
+
+    {
+        unchecked_scope guard;
+
+        REQUIRE( !is_dimension_checked() );
+        REQUIRE( b( m + s ) == "2.000000 m" );
+        REQUIRE_NOTHROW( m < s );
+    }
+
+    REQUIRE( is_dimension_checked() );
+    REQUIRE_THROWS_AS( m + s, incompatible_dimension_error );
+
+    {
+        violation_count = 0;
+        unchecked_scope guard( 3, count_violation );
+
+        for ( int i = 0; i < 9; ++i )
+        {
+            m + s;
+        }
+        REQUIRE( violation_count == 3 );
+    }
+
+    {
+        unchecked_scope guard( 1 );
+
+        INFO( "Expect sampled violation without handler to throw:" );
+        REQUIRE_THROWS_AS( m - s, incompatible_dimension_error );
+    }
+}
+
 /*
  * end of file
  */
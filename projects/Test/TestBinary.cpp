@@ -0,0 +1,100 @@
+/*
+ * TestBinary.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io_binary.hpp"
+#include "phys/units/quantity.hpp"
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+TEST_CASE( "binary/roundtrip", "Quantity binary encoding round trip" )
+{
+    quantity_array a( length_d );
+    a.push_back( 1.5 * meter() );
+    a.push_back( -2.25 * meter() );
+
+    binary_writer writer;
+    writer.write( 4.7e3 * volt() / ampere() );
+    writer.write( 1.0 / 3 * volt() / ampere() );
+    writer.write( a );
+    writer.write( meter() / second() );
+
+    INFO( "Expect one byte plus magnitude for a repeated dimension:" );
+    binary_writer w2( writer );
+    std::size_t const before = w2.size();
+    w2.write( 2.0 * meter() / second() );
+    REQUIRE( w2.size() - before == 9 );
+
+    binary_reader reader( writer.data(), writer.size() );
+    quantity q;
+
+    REQUIRE( reader.read( q ) );
+    REQUIRE( b( q ) == "4700.000000 m+2 kg s-3 A-2" );
+    REQUIRE( reader.read( q ) );
+    REQUIRE( q.value() == 1.0 / 3 );
+
+    REQUIRE( reader.peek() == binary_reader::array_record );
+    binary_array_view const view( reader.read_array() );
+    REQUIRE( view.size() == 2 );
+    REQUIRE( view.dimension() == length_d );
+    REQUIRE( view.value( 1 ) == -2.25 );
+
+    quantity_array c;
+    view.copy_to( c );
+    REQUIRE( b( c.at( 0 ) ) == "1.500000 m" );
+
+    REQUIRE( reader.read( q ) );
+    REQUIRE( b( q ) == "1.000000 m s-1" );
+    REQUIRE( !reader.read( q ) );
+    REQUIRE( reader.at_end() );
+}
+
+TEST_CASE( "binary/exception", "Quantity binary decoding exceptions" )
+{
+    binary_writer writer;
+    writer.write( meter() );
+
+    std::vector<unsigned char> data( writer.buffer() );
+    quantity q;
+
+    INFO( "Expect missing header:" );
+    REQUIRE_THROWS_AS( binary_reader( &data[0], 3 ), binary_format_error );
+
+    INFO( "Expect truncated magnitude:" );
+    binary_reader truncated( &data[0], data.size() - 1 );
+    REQUIRE_THROWS_AS( truncated.read( q ), binary_format_error );
+
+    INFO( "Expect exponent out of range:" );
+    unsigned char const bad_exponent[] = { 'P', 'U', 'Q', 'B', 1, 0, 1, 0x80, 0x02, 2, 0, 0, 0, 0, 0, 0, 0, 0 };
+    binary_reader r1( bad_exponent, sizeof bad_exponent );
+    REQUIRE_THROWS_AS( r1.read( q ), binary_format_error );
+
+    INFO( "Expect undefined dimension id:" );
+    unsigned char const bad_id[] = { 'P', 'U', 'Q', 'B', 1, 3, 0, 0, 0, 0, 0, 0, 0, 0 };
+    binary_reader r2( bad_id, sizeof bad_id );
+    REQUIRE_THROWS_AS( r2.read( q ), binary_format_error );
+
+    INFO( "Expect array instead of quantity:" );
+    quantity_array a( length_d, 1 );
+    binary_writer w2;
+    w2.write( a );
+    binary_reader r3( w2.data(), w2.size() );
+    REQUIRE_THROWS_AS( r3.read( q ), binary_format_error );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,76 @@
+/*
+ * TestBulk.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io_bulk.hpp"
+#include "phys/units/quantity.hpp"
+
+#include <cstring>
+#include <sstream>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+TEST_CASE( "bulk/parse", "Bulk parsing of quantity lines" )
+{
+    char const * const text = "3 km\n4 m/s\n\n12 cm\r\n5 furlong\n2.5 km";
+
+    quantity_array values;
+    std::vector<line_error> errors;
+
+    REQUIRE( parse_lines( text, std::strlen( text ), values, errors ) == 6 );
+    REQUIRE( values.size() == 6 );
+    REQUIRE( values.dimension() == length_d );
+    REQUIRE( b( values.at( 0 ) ) == "3000.000000 m" );
+    REQUIRE( b( values.at( 3 ) ) == "0.120000 m" );
+    REQUIRE( b( values.at( 5 ) ) == "2500.000000 m" );
+    REQUIRE( values.value( 1 ) != values.value( 1 ) );
+
+    REQUIRE( errors.size() == 3 );
+    REQUIRE( errors[0].line == 2 );
+    REQUIRE( errors[0].info.code == errc::incompatible_dimension );
+    REQUIRE( errors[1].line == 3 );
+    REQUIRE( errors[2].line == 5 );
+    REQUIRE( errors[2].info.code == errc::undefined_unit );
+    REQUIRE( errors[2].message() == "quantity: parsing unit '5 furlong': quantity: undefined unit 'urlong'" );
+
+    REQUIRE( parse_lines( "", 0, values, errors ) == 0 );
+    REQUIRE( values.empty() );
+    REQUIRE( errors.empty() );
+}
+
+TEST_CASE( "bulk/chunks", "Bulk parsing over several chunks" )
+{
+    std::ostringstream os;
+
+    for ( int i = 0; i < 40000; ++i )
+    {
+        os << i << ( i == 30000 ? " s" : " mm" ) << '\n';
+    }
+
+    std::string const text( os.str() );
+
+    quantity_array values;
+    std::vector<line_error> errors;
+
+    REQUIRE( parse_lines( text.data(), text.size(), values, errors, 4 ) == 40000 );
+    REQUIRE( values.value( 39999 ) == Approx( 39.999 ) );
+    REQUIRE( errors.size() == 1 );
+    REQUIRE( errors[0].line == 30001 );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,110 @@
+/*
+ * TestColumnar.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io_columnar.hpp"
+#include "phys/units/quantity.hpp"
+
+#include <cstdio>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+TEST_CASE( "columnar/roundtrip", "Quantity columnar file round trip" )
+{
+    char const * const path = "TestColumnar.tmp";
+
+    std::vector<column_spec> columns;
+    columns.push_back( column_spec( "distance", length_d ) );
+    columns.push_back( column_spec( "duration", time_interval_d ) );
+
+    {
+        columnar_writer writer( path, columns, 4 );
+
+        quantity_array d( length_d );
+        quantity_array t( time_interval_d );
+
+        for ( int i = 0; i < 6; ++i )
+        {
+            d.push_back( i * meter() );
+            t.push_back( ( 10 - i ) * second() );
+        }
+
+        quantity_array const both[] = { d, t };
+        writer.append( both );
+
+        quantity const row[] = { 100 * meter(), 0.5 * second() };
+        writer.append( row );
+
+        INFO( "Expect incompatible dimension error:" );
+        quantity const bad[] = { second(), second() };
+        REQUIRE_THROWS_AS( writer.append( bad ), incompatible_dimension_error );
+
+        {
+            unchecked_scope guard;
+            REQUIRE_THROWS_AS( writer.append( bad ), incompatible_dimension_error );
+        }
+
+        writer.close();
+    }
+
+    columnar_reader reader( path );
+
+    REQUIRE( reader.column_count() == 2 );
+    REQUIRE( reader.column_name( 1 ) == "duration" );
+    REQUIRE( reader.column_index( "distance" ) == 0 );
+    REQUIRE( reader.column_dimension( 1 ) == time_interval_d );
+    REQUIRE( reader.block_count() == 2 );
+    REQUIRE( reader.block_rows( 1 ) == 3 );
+    REQUIRE( reader.row_count() == 7 );
+
+    REQUIRE( reader.block_min( 0, 0 ) == 0 );
+    REQUIRE( reader.block_max( 0, 0 ) == 3 );
+    REQUIRE( reader.block_min( 1, 1 ) == 0.5 );
+
+    REQUIRE(  reader.block_may_contain( 1, 0, 50, 200 ) );
+    REQUIRE( !reader.block_may_contain( 0, 0, 50, 200 ) );
+
+    column_view const view( reader.column( 1, 0 ) );
+    REQUIRE( view.size() == 3 );
+    REQUIRE( b( view.at( 2 ) ) == "100.000000 m" );
+
+    quantity_array const t( reader.read_column( 1 ) );
+    REQUIRE( t.size() == 7 );
+    REQUIRE( b( t.at( 5 ) ) == "5.000000 s" );
+
+    std::remove( path );
+}
+
+TEST_CASE( "columnar/exception", "Quantity columnar file exceptions" )
+{
+    char const * const path = "TestColumnar.tmp";
+
+    INFO( "Expect file error:" );
+    REQUIRE_THROWS_AS( columnar_reader( "TestColumnar.missing" ), file_error );
+
+    std::FILE * file = std::fopen( path, "wb" );
+    std::fputs( "PUQC this is not a columnar file, although it starts like one.......", file );
+    std::fclose( file );
+
+    INFO( "Expect format error:" );
+    REQUIRE_THROWS_AS( columnar_reader( path ), columnar_format_error );
+
+    std::remove( path );
+}
+
+/*
+ * end of file
+ */
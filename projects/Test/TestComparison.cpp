@@ -12,6 +12,11 @@
 #include "phys/units/io.hpp"
 #include "phys/units/quantity.hpp"
 
+#if __cplusplus >= 201103L
+# include <unordered_map>
+# include <unordered_set>
+#endif
+
 #ifdef PHYS_UNITS_IN_RT_NAMESPACE
 using namespace rt::phys::units;
 using namespace rt::phys::units::io;
@@ -120,6 +125,48 @@ TEST_CASE( "quantity/operator/comparison", "Quantity comparison operators" )
     REQUIRE( ( pos2 >  pos1 ) == true );
 }
 
+TEST_CASE( "quantity/hash", "Dimension and quantity hashes" )
+{
+    REQUIRE( hash_value( dimensions() ) == 0xf57262dfUL );     // FNV-1a of 17 zero bytes
+    REQUIRE( hash_value( meter().dimension() ) == hash_value( ( meter() * second() / second() ).dimension() ) );
+    REQUIRE( hash_value( meter().dimension() ) != hash_value( second().dimension() ) );
+    REQUIRE( hash_value( meter().dimension() ) != hash_value( square( meter() ).dimension() ) );
+
+    REQUIRE( hash_value( 2 * meter() ) == hash_value( 4 * meter() / 2 ) );
+    REQUIRE( hash_value( 0 * meter() ) == hash_value( -0.0 * meter() ) );
+    REQUIRE( hash_value( 2 * meter() ) != hash_value( 3 * meter() ) );
+    REQUIRE( hash_value( 2 * meter() ) != hash_value( 2 * second() ) );
+
+    REQUIRE( dimensions_hash()( meter().dimension() ) == hash_value( meter().dimension() ) );
+    REQUIRE( quantity_hash()( meter() ) == hash_value( meter() ) );
+    REQUIRE( quantity_equal()( meter(), meter() ) );
+    REQUIRE( !quantity_equal()( meter(), second() ) );
+
+#if __cplusplus >= 201103L
+    std::unordered_map<dimensions, int> count;
+    ++count[ meter().dimension() ];
+    ++count[ ( kilo() * meter() ).dimension() ];
+    ++count[ second().dimension() ];
+
+    REQUIRE( count.size() == 2 );
+    REQUIRE( count[ meter().dimension() ] == 2 );
+
+    std::unordered_set<quantity> set;
+    set.insert( meter() );
+    set.insert( meter() );
+
+    REQUIRE( set.size() == 1 );
+
+    std::unordered_set<quantity, quantity_hash, quantity_equal> mixed;
+    mixed.insert( meter() );
+    mixed.insert( second() );
+    mixed.insert( 1000 * meter() / kilo() );
+
+    REQUIRE( mixed.size() == 2 );
+    REQUIRE( std::hash<quantity>()( meter() ) == hash_value( meter() ) );
+#endif
+}
+
 /*
  * end of file
  */
@@ -0,0 +1,146 @@
+/*
+ * TestCsv.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io_csv.hpp"
+#include "phys/units/quantity.hpp"
+
+#include <sstream>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+namespace {
+
+char const * const table =
+    "time [s], speed [km/h], \"height, max\"\n"
+    "0,        36,           3 m\n"
+    "\n"
+    "1.5,      5 m/s,        310 cm\r\n"
+    "3,        ,             3.2 m\n"
+    "4.5e0,    72 km/h,      \"4 m\"";
+}
+
+TEST_CASE( "csv/unit-cache", "Unit cache" )
+{
+    unit_cache cache;
+
+    REQUIRE( b( cache.to_quantity( "12.5 km/h" ) ) == "3.472222 m s-1" );
+    REQUIRE( b( cache.to_quantity( " 25km/h " ) ) == "6.944444 m s-1" );
+    REQUIRE( b( cache.to_quantity( "-2.5e3m" ) ) == "-2500.000000 m" );
+    REQUIRE( b( cache.to_quantity( "m" ) ) == "1.000000 m" );
+    REQUIRE( b( cache.to_quantity( "2" ) ) == "2.000000" );
+
+    REQUIRE( cache.size() == 2 );
+    REQUIRE( cache.misses() == 2 );
+    REQUIRE( cache.hits() == 2 );
+
+    REQUIRE( cache.find( "km/h" ) == &cache.unit( "km/h" ) );
+    REQUIRE( cache.find( "m/s/s" ) == 0 );
+    REQUIRE( cache.error().code == errc::parse_repeated_solidus );
+
+    INFO( "Expect parser error:" );
+    REQUIRE_THROWS_AS( cache.to_quantity( "3 furlong" ), quantity_parser_error );
+
+    INFO( "Expect text that reads as part of a number to be no unit:" );
+    char const * const numeric[] = { "e", "E", "e3", ".", "+", "-" };
+
+    for ( std::size_t i = 0; i < sizeof numeric / sizeof numeric[0]; ++i )
+    {
+        REQUIRE( cache.find( numeric[i] ) == 0 );
+        REQUIRE( cache.error().code == errc::parse_expecting_unit );
+    }
+
+    REQUIRE_THROWS_AS( cache.to_quantity( "5 e3" ), quantity_parser_error );
+    REQUIRE_THROWS_AS( cache.to_quantity( "7 ." ), quantity_parser_error );
+
+    INFO( "Expect unit text that starts with a number to be no unit:" );
+    REQUIRE( cache.find( "3 m" ) == 0 );
+    REQUIRE( cache.error().code == errc::parse_expecting_unit );
+    REQUIRE_THROWS_AS( cache.to_quantity( "5 3 m" ), quantity_parser_error );
+    REQUIRE_THROWS_AS( cache.to_quantity( "5 1 m" ), quantity_parser_error );
+    REQUIRE( b( cache.to_quantity( "5 1/s" ) ) == "5.000000 s-1" );
+}
+
+TEST_CASE( "csv/read", "Unit-aware CSV reader" )
+{
+    std::istringstream is( table );
+    csv_reader reader( is, ',', 8 );
+
+    REQUIRE( reader.column_count() == 3 );
+    REQUIRE( reader.column_name( 2 ) == "height, max" );
+    REQUIRE( reader.column_unit( 1 ) == "km/h" );
+    REQUIRE( reader.column_index( "speed" ) == 1 );
+
+    std::vector<quantity_array> chunk;
+
+    REQUIRE( reader.read( chunk, 3 ) );
+    REQUIRE( chunk[0].size() == 3 );
+    REQUIRE( b( chunk[1].at( 0 ) ) == "10.000000 m s-1" );
+    REQUIRE( b( chunk[1].at( 1 ) ) == "5.000000 m s-1" );
+    REQUIRE( chunk[1].value( 2 ) != chunk[1].value( 2 ) );
+    REQUIRE( b( chunk[2].at( 1 ) ) == "3.100000 m" );
+
+    REQUIRE( reader.read( chunk, 3 ) );
+    REQUIRE( chunk[0].size() == 1 );
+    REQUIRE( b( chunk[1].at( 0 ) ) == "20.000000 m s-1" );
+    REQUIRE( b( chunk[2].at( 0 ) ) == "4.000000 m" );
+
+    REQUIRE( !reader.read( chunk ) );
+
+    std::vector<quantity_array> const all( csv_reader( table, std::strlen( table ) ).read_all() );
+    REQUIRE( all.size() == 3 );
+    REQUIRE( all[0].size() == 4 );
+    REQUIRE( all[0].dimension() == time_interval_d );
+    REQUIRE( b( all[0].at( 3 ) ) == "4.500000 s" );
+}
+
+TEST_CASE( "csv/exception", "Unit-aware CSV reader exceptions" )
+{
+    std::vector<quantity_array> chunk;
+
+    INFO( "Expect missing header:" );
+    std::istringstream empty( "\n" );
+    REQUIRE_THROWS_AS( csv_reader( empty ), csv_error );
+
+    INFO( "Expect wrong field count:" );
+    std::istringstream fields( "a [m], b [s]\n1, 2, 3\n" );
+    csv_reader r1( fields );
+    REQUIRE_THROWS_AS( r1.read( chunk ), csv_error );
+
+    INFO( "Expect incompatible unit:" );
+    std::istringstream units( "a [m]\n1 s\n" );
+    csv_reader r2( units );
+    REQUIRE_THROWS_AS( r2.read( chunk ), csv_error );
+
+    INFO( "Expect number without unit:" );
+    std::istringstream bare( "a\n1 m\n2\n" );
+    csv_reader r3( bare );
+    REQUIRE_THROWS_AS( r3.read( chunk ), csv_error );
+
+    INFO( "Expect number followed by text that is no unit:" );
+    std::istringstream numeric( "a,b\n5 e3,1\n7 .,2\n" );
+    csv_reader r4( numeric );
+    REQUIRE_THROWS_AS( r4.read( chunk ), quantity_parser_error );
+
+    INFO( "Expect unit text that starts with a number to be no unit:" );
+    std::istringstream numbers( "a\n5 3 m\n5 2 km\n" );
+    csv_reader r5( numbers );
+    REQUIRE_THROWS_AS( r5.read( chunk ), quantity_parser_error );
+}
+
+/*
+ * end of file
+ */
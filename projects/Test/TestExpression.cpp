@@ -0,0 +1,97 @@
+/*
+ * TestExpression.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+#include "phys/units/quantity_expr.hpp"
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+TEST_CASE( "expression/scalar", "Quantity expression templates, scalar" )
+{
+    quantity x1( 1 * meter() / second() );
+    quantity x2( 6 * meter() );
+    quantity x3( 2 * second() );
+
+    x1 += lazy( x2 ) / x3;
+    REQUIRE( b( x1 ) == "4.000000 m s-1" );
+
+    x1 -= x2 / lazy( x3 ) - lazy( x1 );
+    REQUIRE( b( x1 ) == "5.000000 m s-1" );
+
+    REQUIRE( b( evaluate( -lazy( x2 ) * 2 / x3 / x3 ) ) == "-3.000000 m s-2" );
+
+    quantity x4( x2 );
+    assign( x4, lazy( x2 ) + x2 * 0.5 );
+    REQUIRE( b( x4 ) == "9.000000 m" );
+
+    x4 *= lazy( x1 ) / x1;
+    REQUIRE( b( x4 ) == "9.000000 m" );
+
+    x4 /= lazy( x3 );
+    REQUIRE( b( x4 ) == "4.500000 m s-1" );
+}
+
+TEST_CASE( "expression/array", "Quantity expression templates, array" )
+{
+    quantity_array a( length_d ); a.push_back( 1 * meter() ); a.push_back( 2 * meter() ); a.push_back( 3 * meter() );
+    quantity_array t( time_interval_d, 3, 2.0 );
+
+    quantity_array v( evaluate_array( a / t ) );
+    REQUIRE( v.size() == 3 );
+    REQUIRE( b( v.at( 2 ) ) == "1.500000 m s-1" );
+
+    v += 2 * a / t + meter() / second();
+    REQUIRE( b( v.at( 0 ) ) == "2.500000 m s-1" );
+    REQUIRE( b( v.at( 1 ) ) == "4.000000 m s-1" );
+
+    quantity_array c( length_d, 3 );
+    assign( c, -a - a );
+    REQUIRE( b( c.at( 1 ) ) == "-4.000000 m" );
+
+    assign( c, 7 * meter() + lazy( a ) * 0 );
+    REQUIRE( b( c.at( 2 ) ) == "7.000000 m" );
+
+    c *= a;
+    REQUIRE( b( c.at( 2 ) ) == "21.000000 m+2" );
+}
+
+TEST_CASE( "expression/exception", "Quantity expression template exceptions" )
+{
+    quantity m( meter() );
+    quantity s( second() );
+
+    INFO( "Expect incompatible dimension error:" );
+    REQUIRE_THROWS_AS( evaluate( lazy( m ) + s ), incompatible_dimension_error );
+    REQUIRE_THROWS_AS( m += lazy( s ) * 2, incompatible_dimension_error );
+
+    INFO( "Expect unchanged operand on error:" );
+    REQUIRE_THROWS_AS( m *= lazy( s ) * ( lazy( m ) - s ), incompatible_dimension_error );
+    REQUIRE( b( m ) == "1.000000 m" );
+
+    quantity_array a( length_d, 3 );
+    quantity_array b2( length_d, 2 );
+
+    INFO( "Expect array size error:" );
+    REQUIRE_THROWS_AS( evaluate_array( a + b2 ), array_size_error );
+    REQUIRE_THROWS_AS( evaluate( lazy( a ) * m ), array_size_error );
+    REQUIRE_THROWS_AS( a.push_back( s ), incompatible_dimension_error );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,175 @@
+/*
+ * TestFormula.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/formula.hpp"
+#include "phys/units/quantity.hpp"
+
+#include <cmath>
+#include <vector>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+namespace {
+
+formula_compiler kinetic()
+{
+    formula_compiler c;
+    c.column( "m", mass_d ).column( "v", quotient( length_d, time_interval_d ) ).column( "h", length_d );
+    return c;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "formula/compile", "Formula dimensions and program" )
+{
+    formula_compiler c( kinetic() );
+
+    formula const e( c.compile( "0.5 * m * v^2" ) );
+
+    REQUIRE( e.dimension() == joule().dimension() );
+    REQUIRE( e.program().size() == 6 );
+    REQUIRE( e.column_dimensions().size() == 3 );
+
+    REQUIRE( c.compile( "m * [9.81 m/s2] * h" ).dimension() == joule().dimension() );
+    REQUIRE( c.compile( "sqrt( v^2 + [3 km/h]^2 )" ).dimension() == ( meter() / second() ).dimension() );
+    REQUIRE( c.compile( "-abs(h) / v" ).dimension() == time_interval_d );
+    REQUIRE( c.compile( "2 * 3 + 4" ).dimension() == dimensionless_d );
+
+    REQUIRE( c.compile( "h^127" ).dimension() == power( length_d, 127 ) );
+    REQUIRE( c.compile( "1.5e2 * h" ).program()[0].value == 150 );
+
+    INFO( "Expect constants to be folded:" );
+    REQUIRE( c.compile( "(2 * 3 + 4)^2 * h" ).program().size() == 3 );
+    REQUIRE( c.compile( "-[1 km]" ).program()[0].value == -1000 );
+}
+
+TEST_CASE( "formula/error", "Formula syntax and dimension errors" )
+{
+    formula_compiler c( kinetic() );
+
+    REQUIRE_THROWS_AS( c.compile( "m + v" ), formula_error );
+
+    try
+    {
+        c.compile( "m * v^2 + m * h" );
+        FAIL( "Expect incompatible dimension" );
+    }
+    catch ( formula_error const & e )
+    {
+        REQUIRE( e.code() == errc::incompatible_dimension );
+        REQUIRE( e.input_position() == 9 );
+        REQUIRE( std::string( e.what() ).find( "quantity: formula 'm * v^2 + m * h': incompatible dimension in operator+ at position 9" ) == 0 );
+    }
+
+    try
+    {
+        c.compile( "m * w" );
+        FAIL( "Expect undefined name" );
+    }
+    catch ( formula_error const & e )
+    {
+        REQUIRE( e.code() == errc::undefined_name );
+        REQUIRE( e.what() == std::string( "quantity: formula 'm * w': undefined name 'w' at position 5" ) );
+    }
+
+    REQUIRE_THROWS_AS( c.compile( "" ), quantity_parser_error );
+
+    struct { char const * text; errc::type code; int position; } const errors[] =
+    {
+        { "m *"          , errc::parse_expecting_operand  , 4 },
+        { "(m * v"       , errc::parse_expecting_character, 7 },
+        { "m h"          , errc::parse_garbage            , 3 },
+        { "v^x"          , errc::parse_expecting_operand  , 3 },
+        { "sqrt(m)"      , errc::uneven_dimension         , 6 },
+        { "[3 parsec]"   , errc::undefined_unit           , 1 },
+        { "[3 m"         , errc::parse_expecting_character, 5 },
+        { "0x10 * h"     , errc::parse_garbage            , 2 },
+        { "h^99999999999", errc::exponent_out_of_range    , 3 },
+        { "h^-128"       , errc::exponent_out_of_range    , 4 },
+        { "(h*h)^64"     , errc::exponent_out_of_range    , 7 },
+    };
+
+    for ( std::size_t i = 0; i < sizeof errors / sizeof errors[0]; ++i )
+    {
+        INFO( "Formula: " << errors[i].text );
+
+        try
+        {
+            c.compile( errors[i].text );
+            FAIL( "Expect formula error" );
+        }
+        catch ( formula_error const & e )
+        {
+            REQUIRE( e.code() == errors[i].code );
+            REQUIRE( e.input_position() == errors[i].position );
+        }
+    }
+}
+
+TEST_CASE( "formula/evaluate", "Formula evaluation over columns" )
+{
+    std::size_t const n = 1000;
+
+    std::vector<quantity_array> columns;
+    columns.push_back( quantity_array( mass_d ) );
+    columns.push_back( quantity_array( quotient( length_d, time_interval_d ) ) );
+    columns.push_back( quantity_array( length_d ) );
+
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        columns[0].push_back_value( 1 + i % 7 );
+        columns[1].push_back_value( std::sin( double( i ) ) );
+        columns[2].push_back_value( 0.5 * i );
+    }
+
+    formula_compiler c( kinetic() );
+
+    quantity_array const energy( c.compile( "0.5 * m * v^2 + m * [9.81 m/s2] * h" ).evaluate( columns ) );
+
+    REQUIRE( energy.size() == n );
+    REQUIRE( energy.dimension() == joule().dimension() );
+
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        double const m = columns[0].value( i ), v = columns[1].value( i ), h = columns[2].value( i );
+
+        REQUIRE( energy.value( i ) == Approx( 0.5 * m * v * v + m * 9.81 * h ) );
+    }
+
+    quantity_array const speed( c.compile( "-sqrt( abs(v) * v ) + h / h * [1 m/s]" ).evaluate( columns ) );
+
+    REQUIRE( speed.value( 3 ) == Approx( 1 - std::sqrt( std::sin( 3.0 ) * std::sin( 3.0 ) ) ) );
+
+    INFO( "Expect columns to be checked once per evaluation:" );
+    std::vector<quantity_array> swapped( columns );
+    swapped[0].swap( swapped[2] );
+
+    REQUIRE_THROWS_AS( c.compile( "m" ).evaluate( swapped ), incompatible_dimension_error );
+
+    {
+        unchecked_scope guard;
+        REQUIRE_THROWS_AS( c.compile( "m" ).evaluate( swapped ), incompatible_dimension_error );
+    }
+
+    columns[2].push_back_value( 1 );
+
+    REQUIRE_THROWS_AS( c.compile( "m" ).evaluate( columns ), array_size_error );
+}
+
+/*
+ * end of file
+ */
@@ -13,6 +13,9 @@
 #include "catch.hpp"
 #include "phys/units/io.hpp"
 #include "phys/units/quantity.hpp"
+#include "phys/units/quantity_array.hpp"
+
+#include <cmath>
 
 #ifdef PHYS_UNITS_IN_RT_NAMESPACE
 using namespace rt::phys::units;
@@ -71,6 +74,83 @@ TEST_CASE( "quantity/function/root", "Quantity root functions" )
     REQUIRE( b(sqrt( freq * thing ) ) == "15.000000 s-1 A" );
 }
 
+TEST_CASE( "quantity/function/integer", "Quantity integer powers and roots" )
+{
+    INFO( "Expect repeated squaring to be exact for small powers:" );
+    REQUIRE( nth_power( 2 * meter(), 31 ).value() == 2147483648.0 );
+    REQUIRE( nth_power( 2 * meter(), -10 ).value() == 1 / 1024.0 );
+    REQUIRE( nth_power( 3 * meter(), 0 ).dimension() == dimensionless_d );
+
+    INFO( "Expect negative powers as precise as pow:" );
+    for ( int i = 1; i < 100; ++i )
+    {
+        double const x = 0.001 + 0.731 * i;
+
+        REQUIRE( nth_power( x * meter(), -1 ).value() == 1 / x );
+        REQUIRE( nth_power( x * meter(), -2 ).value() == Approx( std::pow( x, -2 ) ).epsilon( 1e-15 ) );
+
+        for ( int N = -3; N >= -8; --N )
+        {
+            REQUIRE( nth_power( x * meter(), N ).value() == std::pow( x, N ) );
+        }
+    }
+
+    REQUIRE( to_quantity( "1 dm-3" ).value() == std::pow( 0.1, -3 ) );
+    REQUIRE( nth_power( 1e160 * meter(), -2 ).value() == std::pow( 1e160, -2 ) );
+    REQUIRE( nth_power( 1e160 * meter(), -2 ).value() > 0 );
+
+    INFO( "Expect large powers to fall back to pow:" );
+    REQUIRE( nth_power( 1.5 * meter(), 40 ).value() == Approx( std::pow( 1.5, 40 ) ) );
+    REQUIRE( nth_power( meter(), 40 ).dimension() == power( length_d, 40 ) );
+
+    REQUIRE( b(nth_root( 27 * meter() * meter() * meter(), 3 ) ) == "3.000000 m" );
+    REQUIRE( b(nth_root( 8 * meter() * meter() * meter(), -3 ) ) == "0.500000 m-1" );
+
+    INFO( "Expect odd roots of negative magnitudes to be negative:" );
+    REQUIRE( b(nth_root( -8 * meter() * meter() * meter(), 3 ) ) == "-2.000000 m" );
+    REQUIRE( b(nth_root( -8 * meter() * meter() * meter(), -3 ) ) == "-0.500000 m-1" );
+    REQUIRE( nth_root( quantity( dimensionless_d, -32 ), 5 ).value() == Approx( -2 ) );
+    REQUIRE( nth_root( quantity( dimensionless_d, -4 ), 2 ).value() != nth_root( quantity( dimensionless_d, -4 ), 2 ).value() );
+}
+
+TEST_CASE( "quantity/function/array", "Quantity array powers and roots" )
+{
+    quantity_array a( length_d );
+
+    for ( int i = 0; i < 100; ++i )
+    {
+        a.push_back_value( 0.25 * i - 10 );
+    }
+
+    quantity_array const a2( square( a ) );
+    quantity_array const a3( cube( a ) );
+    quantity_array const r2( nth_power( a, -2 ) );
+    quantity_array const a5( nth_power( a, 5 ) );
+    quantity_array const s2( sqrt( a2 ) );
+
+    REQUIRE( a2.dimension() == power( length_d, 2 ) );
+    REQUIRE( a3.dimension() == power( length_d, 3 ) );
+    REQUIRE( r2.dimension() == power( length_d, -2 ) );
+    REQUIRE( s2.dimension() == length_d );
+
+    for ( std::size_t i = 0; i < a.size(); ++i )
+    {
+        double const x = a.value( i );
+
+        REQUIRE( a2.value( i ) == x * x );
+        REQUIRE( a3.value( i ) == x * x * x );
+        REQUIRE( r2.value( i ) == 1 / ( x * x ) );
+        REQUIRE( a5.value( i ) == Approx( std::pow( x, 5 ) ) );
+        REQUIRE( s2.value( i ) == std::fabs( x ) );
+    }
+
+    REQUIRE( nth_root( a3, 3 ).value( 10 ) == Approx( a.value( 10 ) ) );
+
+    INFO( "Expect the dimension of an array root to be checked once:" );
+    REQUIRE_THROWS_AS( sqrt( a ), dimension_error );
+    REQUIRE_THROWS_AS( nth_root( a2, 3 ), dimension_error );
+}
+
 TEST_CASE( "quantity/function/various", "Quantity, various functions" )
 {
     quantity m( meter() );
@@ -37,6 +37,54 @@ TEST_CASE( "input/convert", "Quantity parser string to value conversions" )
     REQUIRE( !!(                to_unit( "45 km/h" )   == kilo() * meter() / hour() ) );
 }
 
+TEST_CASE( "input/prefix", "Quantity parser prefixed units" )
+{
+    REQUIRE( !!( to_quantity( "1 km"   ) == kilo() * meter() ) );
+    REQUIRE( !!( to_quantity( "1 mm"   ) == milli() * meter() ) );
+    REQUIRE( !!( to_quantity( "1 mmol" ) == milli() * mole() ) );
+    REQUIRE( !!( to_quantity( "1 daN"  ) == deka() * newton() ) );
+    REQUIRE( !!( to_quantity( "1 dam"  ) == deka() * meter() ) );
+    REQUIRE( !!( to_quantity( "1 dm"   ) == deci() * meter() ) );
+    REQUIRE( !!( to_quantity( "1 hPa"  ) == hecto() * pascal() ) );
+    REQUIRE( !!( to_quantity( "1 kOhm" ) == kilo() * ohm() ) );
+    REQUIRE( !!( to_quantity( "1 mmin" ) == milli() * minute() ) );
+    REQUIRE( !!( to_quantity( "1 MHz"  ) == mega() * hertz() ) );
+
+    // a unit rather than a prefix and a unit:
+    REQUIRE( !!( to_quantity( "1 cd"   ) == candela() ) );
+    REQUIRE( !!( to_quantity( "1 kg"   ) == kilogram() ) );
+    REQUIRE( !!( to_quantity( "1 mol"  ) == mole() ) );
+    REQUIRE( !!( to_quantity( "1 min"  ) == minute() ) );
+    REQUIRE( !!( to_quantity( "1 Pa"   ) == pascal() ) );
+    REQUIRE( !!( to_quantity( "1 Gy"   ) == gray() ) );
+    REQUIRE( !!( to_quantity( "1 h"    ) == hour() ) );
+    REQUIRE( !!( to_quantity( "1 d"    ) == day() ) );
+    REQUIRE( !!( to_quantity( "1 T"    ) == tesla() ) );
+    REQUIRE( !!( to_quantity( "1 !m"   ) == meter() ) );
+
+    REQUIRE( try_to_quantity( "1 kx" ).message() == "quantity: parsing unit '1 kx': quantity: undefined unit 'x'" );
+    REQUIRE( try_to_quantity( "1 dax" ).message() == "quantity: parsing unit '1 dax': quantity: undefined unit 'x'" );
+
+    INFO( "Expect a bare prefix to read as a unit name:" );
+    REQUIRE( try_to_quantity( "1 k" ).message() == "quantity: parsing unit '1 k': quantity: undefined unit 'k'" );
+    REQUIRE( try_to_quantity( "1 da" ).message() == "quantity: parsing unit '1 da': quantity: undefined unit 'da'" );
+    REQUIRE( try_to_quantity( "2 u m" ).message() == "quantity: parsing unit '2 u m': quantity: undefined unit 'u'" );
+
+    REQUIRE( !!( to_quantity( "1 k", extend() ) == to_quantity( "1 !k", extend() ) ) );
+    REQUIRE( to_unit_symbol( to_quantity( "1 k", extend() ) ) == "k" );
+
+    INFO( "Expect an undefined symbol after a prefix to read as prefix and unit:" );
+    REQUIRE( try_to_quantity( "1 kgm" ).message() == "quantity: parsing unit '1 kgm': quantity: undefined unit 'gm'" );
+    REQUIRE( !!( to_quantity( "1 kgm", extend() ) == kilo() * to_quantity( "1 gm", extend() ) ) );
+
+    REQUIRE( has_prefix( "da" ) );
+    REQUIRE( has_prefix( "Y" ) );
+    REQUIRE( !has_prefix( "" ) );
+    REQUIRE( !has_prefix( "D" ) );
+    REQUIRE( !has_prefix( "kk" ) );
+    REQUIRE( prefix( "da" ) == 10 );
+}
+
 TEST_CASE( "input/exception", "Quantity parser exceptions" )
 {
     REQUIRE_THROWS( to_quantity( "m/s/s" ) );
@@ -63,6 +111,42 @@ TEST_CASE( "input/exception", "Quantity parser exceptions" )
     REQUIRE_THROWS_AS( to_quantity( "(3 m"  ), quantity_parser_error );
 }
 
+TEST_CASE( "input/result", "Quantity parser non-throwing interface" )
+{
+    REQUIRE( try_to_quantity( "45 km/h" ).ok() );
+    REQUIRE( try_to_quantity( "45 km/h" ).value().value() == 12.5 );
+
+    REQUIRE( try_to_quantity( "(m)a"  ).code() == errc::parse_garbage );
+    REQUIRE( try_to_quantity( "xm"    ).code() == errc::undefined_unit );
+    REQUIRE( try_to_quantity( "m..m"  ).code() == errc::parse_consecutive_operators );
+    REQUIRE( try_to_quantity( "m/s/s" ).code() == errc::parse_repeated_solidus );
+    REQUIRE( try_to_quantity( "7 1k"  ).code() == errc::parse_expecting_reciprocal );
+    REQUIRE( try_to_quantity( "3"     ).code() == errc::parse_expecting_unit );
+    REQUIRE( try_to_quantity( "(3 m"  ).code() == errc::parse_expecting_character );
+
+    quantity_result const r( try_to_quantity( "3 m/s/s" ) );
+
+    REQUIRE( r.position() == 6 );
+    REQUIRE( r.message() == "quantity: parsing unit '3 m/s/s': repetition of solidus at position 6: use parenthesis to avoid ambiguity" );
+    REQUIRE( try_to_quantity( "xm" ).message() == "quantity: parsing unit 'xm': quantity: undefined unit 'xm'" );
+
+    try
+    {
+        to_quantity( "3 m/s/s" );
+        FAIL( "Expect repetition of solidus" );
+    }
+    catch ( quantity_parser_error const & e )
+    {
+        REQUIRE( e.code() == errc::parse_repeated_solidus );
+        REQUIRE( e.input_position() == 6 );
+        REQUIRE( e.what() == r.message() );
+    }
+
+    quantity_parser parser;
+    REQUIRE( !parser.try_parse( "m..m" ).ok() );
+    REQUIRE(  parser.try_parse( "3 mm" ).ok() );
+}
+
 /*
  * end of file
  */
@@ -0,0 +1,100 @@
+/*
+ * TestLatency.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io.hpp"
+#include "phys/units/latency.hpp"
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+/*
+ * The recorded counts are only checked when compiled with PHYS_UNITS_LATENCY;
+ * otherwise all histograms are empty.
+ */
+
+TEST_CASE( "latency/histogram", "Log-linear latency buckets" )
+{
+    typedef latency_histogram h;
+
+    REQUIRE( h::bucket(  0 ) ==  0 );
+    REQUIRE( h::bucket( 31 ) == 31 );
+    REQUIRE( h::bucket( 32 ) == 32 );
+    REQUIRE( h::bucket( 34 ) == 33 );
+    REQUIRE( h::bucket( 1e12 ) == h::bucket_count - 1 );
+
+    for ( int i = 1; i < h::bucket_count; ++i )
+    {
+        REQUIRE( h::bucket( h::lowest( i ) ) == i );
+        REQUIRE( h::bucket( h::lowest( i ) - 1 ) == i - 1 );
+    }
+
+    latency_histogram a = latency_histogram();
+
+    for ( int i = 1; i <= 100; ++i )
+    {
+        a.record( 1000 * i );
+    }
+
+    REQUIRE( a.count() == 100 );
+    REQUIRE( a.mean() == Approx( 50500 ) );
+    REQUIRE( a.percentile( 50 ) >= 50000 );
+    REQUIRE( a.percentile( 50 ) <= 50000 * 1.0625 );
+    REQUIRE( a.max() >= 100000 );
+    REQUIRE( a.max() <= 100000 * 1.0625 );
+
+    latency_histogram b( a );
+    b += a;
+    b -= a;
+
+    REQUIRE( b.count() == 100 );
+    REQUIRE( latency_histogram().percentile( 99 ) == 0 );
+}
+
+TEST_CASE( "latency/record", "Latency of parse and format, snapshot and reset" )
+{
+    latency_reset();
+
+    quantity const q( to_quantity( "3 km" ) );
+    std::string const s( io::to_string( q ) );
+    std::string const e( to_eng_string( q ) );
+    std::string const u( to_unit_symbol( q ) );
+
+    latency_histogram const parse = latency_snapshot( latency_parse );
+
+    if ( latency_enabled() )
+    {
+        REQUIRE( parse.count() == 1 );
+        REQUIRE( latency_snapshot( latency_to_string ).count() == 1 );
+        REQUIRE( latency_snapshot( latency_to_eng_string ).count() == 1 );
+        REQUIRE( latency_snapshot( latency_unit_symbol ).count() >= 1 );
+        REQUIRE( parse.max() > 0 );
+    }
+    else
+    {
+        REQUIRE( parse.count() == 0 );
+    }
+
+    latency_reset();
+
+    REQUIRE( latency_snapshot( latency_parse ).count() == 0 );
+
+    REQUIRE( latency_report().find( "to_eng_string" ) != std::string::npos );
+    REQUIRE( latency_report_json().find( "\"parse\":{\"count\":0," ) != std::string::npos );
+}
+
+/*
+ * end of file
+ */
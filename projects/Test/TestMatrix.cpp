@@ -0,0 +1,179 @@
+/*
+ * TestMatrix.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_matrix.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+namespace {
+
+/**
+ * state of position, velocity and temperature.
+ */
+quantity_vector state( double const x, double const v, double const t )
+{
+    quantity_vector s;
+    s.push_back( x * meter() );
+    s.push_back( v * meter() / second() );
+    s.push_back( t * kelvin() );
+    return s;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "matrix/vector", "Vector of quantities with a dimension per element" )
+{
+    quantity_vector const s( state( 1, 2, 300 ) );
+
+    REQUIRE( s.size() == 3 );
+    REQUIRE( !!( s.at( 1 ) == 2 * meter() / second() ) );
+    REQUIRE( s.dimension( 2 ) == thermodynamic_temperature_d );
+
+    quantity_vector const d( s + 2 * s - s );
+
+    REQUIRE( !!( d.at( 0 ) == 2 * meter() ) );
+    REQUIRE( !!( d.at( 2 ) == 600 * kelvin() ) );
+
+    quantity_vector r( s );
+    r.push_back( meter() );
+
+    REQUIRE_THROWS_AS( s + r, array_size_error );
+
+    quantity_vector::dimensions_type dims( s.element_dimensions() );
+    dims[2] = time_interval_d;
+
+    REQUIRE_THROWS_AS( s + quantity_vector( dims ), incompatible_dimension_error );
+}
+
+TEST_CASE( "matrix/product", "Matrix products with dimensions per row and column" )
+{
+    quantity_vector const s( state( 1, 2, 300 ) );
+
+    // state transition over dt = 0.5 s; element (0, 1) is in seconds:
+    quantity_matrix f( s.element_dimensions(), s.element_dimensions() );
+
+    f.set( 0, 0, quantity( dimensionless_d, 1 ) );
+    f.set( 0, 1, 0.5 * second() );
+    f.set( 1, 1, quantity( dimensionless_d, 1 ) );
+    f.set( 2, 2, quantity( dimensionless_d, 1 ) );
+
+    REQUIRE( f.dimension( 0, 1 ) == time_interval_d );
+    REQUIRE( !!( f.at( 0, 1 ) == 0.5 * second() ) );
+    REQUIRE_THROWS_AS( f.set( 0, 1, meter() ), incompatible_dimension_error );
+
+    {
+        unchecked_scope guard;
+
+        INFO( "Expect input to be checked without arithmetic checks:" );
+        REQUIRE_THROWS_AS( f.set( 0, 1, meter() ), incompatible_dimension_error );
+    }
+
+    quantity_vector const next( f * s );
+
+    REQUIRE( !!( next.at( 0 ) == 2 * meter() ) );
+    REQUIRE( !!( next.at( 1 ) == 2 * meter() / second() ) );
+    REQUIRE( !!( next.at( 2 ) == 300 * kelvin() ) );
+
+    quantity_matrix const f2( f * f );
+
+    REQUIRE( f2.row_dimensions() == s.element_dimensions() );
+    REQUIRE( f2.column_dimensions() == s.element_dimensions() );
+    REQUIRE( !!( f2.at( 0, 1 ) == second() ) );
+
+    INFO( "Expect the rows of the result scaled by the common ratio:" );
+    quantity_vector v;
+    v.push_back( 2 * meter() / second() );
+    v.push_back( 3 * second() / second() );
+
+    quantity_matrix::dimensions_type rows( 1, force_d );
+    quantity_matrix::dimensions_type cols;
+    cols.push_back( length_d );
+    cols.push_back( time_interval_d );
+
+    quantity_matrix a( rows, cols );
+    a.set( 0, 0, 5 * newton() / meter() );
+    a.set( 0, 1, 7 * newton() / second() );
+
+    REQUIRE( !!( ( a * v ).at( 0 ) == 31 * newton() / second() ) );
+
+    INFO( "Expect inconsistent dimensions to be rejected once per product:" );
+    REQUIRE_THROWS_AS( a * s, array_size_error );
+    REQUIRE_THROWS_AS( f * quantity_vector( cols ), array_size_error );
+    REQUIRE_THROWS_AS( a * quantity_vector( rows ), array_size_error );
+
+    quantity_vector w;
+    w.push_back( meter() );
+    w.push_back( meter() );
+
+    REQUIRE_THROWS_AS( a * w, incompatible_dimension_error );
+    REQUIRE_THROWS_AS( a * f, array_size_error );
+
+    quantity_matrix const t( transpose( a ) );
+
+    REQUIRE( t.rows() == 2 );
+    REQUIRE( t.dimension( 1, 0 ) == a.dimension( 0, 1 ) );
+    REQUIRE( t.value( 1, 0 ) == 7 );
+}
+
+TEST_CASE( "matrix/blocked", "Blocked matrix product equals the plain product" )
+{
+    std::size_t const m = 100, k = 70, n = 90;
+
+    quantity_matrix a( quantity_matrix::dimensions_type( m, length_d ), quantity_matrix::dimensions_type( k, dimensionless_d ) );
+    quantity_matrix b( quantity_matrix::dimensions_type( k, dimensionless_d ), quantity_matrix::dimensions_type( n, time_interval_d ) );
+
+    for ( std::size_t i = 0; i < m * k; ++i )
+    {
+        a.data()[i] = std::sin( double( i ) );
+    }
+
+    for ( std::size_t i = 0; i < k * n; ++i )
+    {
+        b.data()[i] = std::cos( double( i ) );
+    }
+
+    quantity_matrix const c( a * b );
+
+    REQUIRE( c.dimension( 0, 0 ) == quotient( length_d, time_interval_d ) );
+
+    double error = 0;
+
+    for ( std::size_t i = 0; i < m; ++i )
+    {
+        for ( std::size_t j = 0; j < n; ++j )
+        {
+            double expected = 0;
+
+            for ( std::size_t p = 0; p < k; ++p )
+            {
+                expected += a.value( i, p ) * b.value( p, j );
+            }
+
+            error = std::max( error, std::fabs( c.value( i, j ) - expected ) );
+        }
+    }
+
+    REQUIRE( error < 1e-12 );
+}
+
+/*
+ * end of file
+ */
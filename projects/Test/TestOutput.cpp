@@ -12,6 +12,10 @@
 #include "phys/units/io.hpp"
 #include "phys/units/quantity.hpp"
 
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
 #ifdef PHYS_UNITS_IN_RT_NAMESPACE
 using namespace rt::phys::units;
 using namespace rt::phys::units::io;
@@ -24,6 +28,175 @@ TEST_CASE( "output/convert", "Quantity output conversions" )
 {
 }
 
+TEST_CASE( "output/format", "Quantity formatting into caller buffer" )
+{
+    char buf[ 64 ];
+
+    REQUIRE( format_to( buf, sizeof buf, 4.5 * meter() / second() ) == 7 );
+    REQUIRE( std::string( buf ) == "4.5 m/s" );
+
+    format_to( buf, sizeof buf, meter() / 3.0 );
+    REQUIRE( std::string( buf ) == "0.3333333333333333 m" );
+
+    format_to( buf, sizeof buf, meter() / 3.0, format_options( 6 ) );
+    REQUIRE( std::string( buf ) == to_string( meter() / 3.0 ) );
+
+    format_to( buf, sizeof buf, 2 * newton(), format_options( 0, base_symbols() ) );
+    REQUIRE( std::string( buf ) == "2 m kg s-2" );
+
+    INFO( "Expect truncation as snprintf():" );
+    REQUIRE( format_to( buf, 4, 12.5 * meter() ) == 6 );
+    REQUIRE( std::string( buf ) == "12." );
+
+    std::string text;
+    format_to( std::back_inserter( text ), 0.1 * meter() );
+    REQUIRE( text == "0.1 m" );
+
+    INFO( "Expect cached symbol to follow unit name definition:" );
+    quantity const q( dimensions( 1, 1, 1 ), 1 );
+    REQUIRE( to_string( q ) == "1 m kg s" );
+    detail::define_unit_name( q, "mks" );
+    REQUIRE( to_string( q ) == "1 mks" );
+}
+
+TEST_CASE( "output/eng", "Quantity engineering notation" )
+{
+    REQUIRE( to_eng_string( 4.7 * kilo() * ohm() ) == "4.7 kOhm" );
+    REQUIRE( to_eng_string( 0.0047 * meter() ) == "4.7 mm" );
+    REQUIRE( to_eng_string( -999.9999999 * volt(), 6, true ) == "-1 kV" );
+    REQUIRE( to_eng_string( 1234.5 * meter(), 6, true ) == "+1.2345 km" );
+    REQUIRE( to_eng_string( 4.7e3 * kilogram() ) == "4.7e3 kg" );
+    REQUIRE( to_eng_string( 2e30 * meter() ) == "2e30 m" );
+    REQUIRE( to_eng_string( 0 * meter() ) == "0 m" );
+    REQUIRE( to_eng_magnitude( 0.0047 * meter() ) == "4.7" );
+    REQUIRE( to_eng_unit( 0.0047 * meter() ) == "mm" );
+
+    char buf[ 16 ];
+    REQUIRE( io::eng::format_to( buf, sizeof buf, 12.5e-6 * second() ) == 6 + std::strlen( PHYS_UNITS_MICRO_GLYPH ) );
+    REQUIRE( std::string( buf ) == "12.5 " PHYS_UNITS_MICRO_GLYPH "s" );
+
+    quantity_array a( length_d );
+    a.push_back( 1500 * meter() );
+    a.push_back( 0.25 * meter() );
+
+    std::string text;
+    io::eng::format_to( std::back_inserter( text ), a, ';' );
+    REQUIRE( text == "1.5 km;250 mm;" );
+}
+
+namespace {
+
+/**
+ * deterministic pseudo-random doubles over the full finite range.
+ */
+class random_doubles
+{
+public:
+    random_doubles() : state( 12345u ) {}
+
+    double operator()()
+    {
+        double const mantissa = 0.5 + ( next() * 67108864.0 + next() ) / 9007199254740992.0 / 2;
+        int const exponent = static_cast<int>( next() % 2040 ) - 1020;
+        double const value = std::ldexp( mantissa, exponent );
+        return next() & 1 ? -value : value;
+    }
+
+private:
+    unsigned long next()
+    {
+        state = ( state * 1103515245u + 12345u ) & 0xffffffffu;
+        return state >> 6;
+    }
+
+    unsigned long state;
+};
+
+/**
+ * number of values that do not read back exactly when written in round-trip mode.
+ */
+int roundtrip_failures( dimensions const & d, name_symbol use, int const count )
+{
+    random_doubles random;
+    int failures = 0;
+
+    for ( int i = 0; i < count; ++i )
+    {
+        quantity const q( d, i < 3 ? i : random() );
+
+        std::ostringstream os;
+        os << std::setprecision( 3 ) << roundtrip << q;
+
+        std::string text( os.str() );
+
+        if ( ! use )
+        {
+            text.clear();
+            format_to( std::back_inserter( text ), q, format_options( 0, base_symbols() ) );
+        }
+
+        quantity const r( to_quantity( text, no_extend(), dimensionless() ) );
+
+        if ( r.value() != q.value() || r.dimension() != q.dimension() )
+        {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+}
+
+TEST_CASE( "output/roundtrip", "Quantity round-trip output" )
+{
+    std::ostringstream os;
+    os << roundtrip << meter() / 3.0 << ", " << noroundtrip << meter() / 3.0;
+    REQUIRE( os.str() == "0.3333333333333333 m, 0.333333 m" );
+
+    int const base_end = PHYS_UNITS_QUANTITY_UNIT_BASE_COUNT;
+    int const ext_end  = PHYS_UNITS_QUANTITY_UNIT_BASE_COUNT + PHYS_UNITS_QUANTITY_UNIT_EXT_COUNT;
+
+    detail::unitnamemap const names( detail::predefined_unit_names() );
+
+    for ( detail::unitnamemap::const_iterator pos = names.begin(); pos != names.end(); ++pos )
+    {
+        if ( ! dimensions( pos->first, base_end, ext_end ).is_all_zero() )
+        {
+            continue;
+        }
+
+        INFO( "Unit: " << pos->second );
+        REQUIRE( roundtrip_failures( pos->first, name_symbol(), 500 ) == 0 );
+        REQUIRE( roundtrip_failures( pos->first, base_symbols(), 100 ) == 0 );
+    }
+
+    REQUIRE( roundtrip_failures( dimensions(), name_symbol(), 100 ) == 0 );
+}
+
+TEST_CASE( "output/unit-table", "Perfect hash table of predefined units" )
+{
+    detail::unit_table const & t = detail::get_unit_table();
+
+    REQUIRE( t.complete );
+
+    for ( detail::unitmap::const_iterator pos = detail::get_umap().begin(); pos != detail::get_umap().end(); ++pos )
+    {
+        detail::unit_slot const * const e = detail::find_predefined_unit( pos->first );
+
+        REQUIRE( e != 0 );
+        REQUIRE( e->name == pos->first );
+        REQUIRE( e->func == pos->second );
+        REQUIRE( !!( e->unit == pos->second() ) );
+        REQUIRE( !!( unit( pos->first ) == pos->second() ) );
+    }
+
+    REQUIRE( detail::find_predefined_unit( ""     ) == 0 );
+    REQUIRE( detail::find_predefined_unit( "km"   ) == 0 );
+    REQUIRE( detail::find_predefined_unit( "M"    ) == 0 );
+    REQUIRE( detail::find_predefined_unit( "gram" ) == 0 );
+    REQUIRE( detail::find_predefined_unit( "Ohm" )->name == "Ohm" );
+}
+
 TEST_CASE( "output/exception", "Quantity output exceptions" )
 {
     REQUIRE_THROWS_AS( prefix( "x" ), prefix_error );
@@ -0,0 +1,117 @@
+/*
+ * TestReduce.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/quantity.hpp"
+#include "phys/units/quantity_reduce.hpp"
+
+#include <cmath>
+#include <limits>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+TEST_CASE( "reduce/statistics", "Sum, mean, min, max and variance of a quantity array" )
+{
+    quantity_array a( length_d );
+    a.push_back( 2 * meter() );
+    a.push_back( 4 * meter() );
+    a.push_back( 4 * meter() );
+    a.push_back( 4 * meter() );
+    a.push_back( 5 * meter() );
+    a.push_back( 5 * meter() );
+    a.push_back( 7 * meter() );
+    a.push_back( 9 * meter() );
+
+    REQUIRE( !!( sum( a ) == 40 * meter() ) );
+    REQUIRE( !!( mean( a ) == 5 * meter() ) );
+    REQUIRE( !!( min( a ) == 2 * meter() ) );
+    REQUIRE( !!( max( a ) == 9 * meter() ) );
+    REQUIRE( !!( variance( a ) == 4 * square( meter() ) ) );
+
+    REQUIRE( !!( sum( quantity_array( time_interval_d ) ) == 0 * second() ) );
+
+    REQUIRE_THROWS_AS( mean( quantity_array( time_interval_d ) ), array_size_error );
+    REQUIRE_THROWS_AS( min( quantity_array( time_interval_d ) ), array_size_error );
+    REQUIRE_THROWS_AS( max( quantity_array( time_interval_d ) ), array_size_error );
+    REQUIRE_THROWS_AS( variance( quantity_array( time_interval_d ) ), array_size_error );
+
+    INFO( "Expect NaN to be skipped by min and max:" );
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+
+    quantity_array b( length_d, 11, nan );
+    b.value( 9 ) = 3;
+    b.value( 3 ) = -1;
+
+    REQUIRE( magnitude( min( b ) ) == -1 );
+    REQUIRE( magnitude( max( b ) ) ==  3 );
+    REQUIRE( magnitude( max( quantity_array( length_d, 3, nan ) ) ) != magnitude( max( quantity_array( length_d, 3, nan ) ) ) );
+}
+
+TEST_CASE( "reduce/norm-dot", "Norm and dot product of quantity arrays" )
+{
+    quantity_array s( length_d );
+    s.push_back( 3 * meter() );
+    s.push_back( 4 * meter() );
+
+    quantity_array f( force_d );
+    f.push_back( 2 * newton() );
+    f.push_back( 5 * newton() );
+
+    REQUIRE( !!( norm( s ) == 5 * meter() ) );
+    REQUIRE( !!( dot( s, f ) == 26 * joule() ) );
+
+    REQUIRE( !!( norm( quantity_array( length_d ) ) == 0 * meter() ) );
+    REQUIRE( !!( norm( quantity_array( length_d, 4, 0 ) ) == 0 * meter() ) );
+    REQUIRE( 1 / magnitude( norm( quantity_array( length_d, 4, 0 ) ) ) > 0 );
+    REQUIRE( 1 / magnitude( norm( quantity_array( length_d, 4, -0.0 ) ) ) > 0 );
+
+    INFO( "Expect no overflow or underflow of the squares:" );
+    REQUIRE( magnitude( norm( quantity_array( length_d, 4, 1e300 ) ) ) == Approx( 2e300 ) );
+    REQUIRE( magnitude( norm( quantity_array( length_d, 4, 1e-300 ) ) ) == Approx( 2e-300 ) );
+
+    quantity_array r( length_d );
+    r.push_back( meter() );
+
+    REQUIRE_THROWS_AS( dot( s, r ), array_size_error );
+}
+
+TEST_CASE( "reduce/accuracy", "Pairwise summation, independent of the number of threads" )
+{
+    INFO( "Expect small terms not to vanish against a large first term:" );
+    quantity_array a( length_d, 1000001, 1e-16 );
+    a.value( 0 ) = 1;
+
+    REQUIRE( std::fabs( magnitude( sum( a ) ) - ( 1 + 1e-10 ) ) < 1e-14 );
+
+    INFO( "Expect the same result for any number of threads:" );
+    quantity_array b( length_d );
+
+    for ( int i = 0; i < 300000; ++i )
+    {
+        b.push_back( std::sin( double( i ) ) * meter() );
+    }
+
+    REQUIRE( magnitude( sum( b, 0 ) ) == magnitude( sum( b ) ) );
+    REQUIRE( magnitude( sum( b, 3 ) ) == magnitude( sum( b ) ) );
+    REQUIRE( magnitude( variance( b, 0 ) ) == magnitude( variance( b ) ) );
+    REQUIRE( magnitude( dot( b, b, 0 ) ) == magnitude( dot( b, b ) ) );
+    REQUIRE( magnitude( min( b, 0 ) ) == magnitude( min( b ) ) );
+    REQUIRE( magnitude( max( b, 0 ) ) == magnitude( max( b ) ) );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,103 @@
+/*
+ * TestStats.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io.hpp"
+#include "phys/units/quantity.hpp"
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+/*
+ * The counts are only checked when compiled with PHYS_UNITS_STATS;
+ * otherwise all counts are zero.
+ */
+
+TEST_CASE( "stats/counters", "Operation and allocation counters" )
+{
+    quantity const a( 3 * meter() );
+    quantity const b( 2 * meter() );
+    quantity const c( 4 * second() );
+
+    stats_counters const before = thread_stats();
+
+    quantity d( a );                    // one dimensions copy
+    d += b;                             // one check
+    bool const less = a < b;            // one check
+    quantity_result const r( try_add( a, c ) );  // one check, one mismatch
+
+    stats_counters const n = thread_stats() - before;
+
+    REQUIRE( !less );
+    REQUIRE( !r.ok() );
+
+    if ( stats_enabled() )
+    {
+        REQUIRE( n.dimension_checks == 3 );
+        REQUIRE( n.dimension_mismatches == 1 );
+        REQUIRE( n.dimensions >= 1 );
+        REQUIRE( n.allocations >= n.dimensions );
+        REQUIRE( n.parses == 0 );
+    }
+    else
+    {
+        REQUIRE( n.dimension_checks == 0 );
+        REQUIRE( n.allocations == 0 );
+    }
+
+    stats_counters const before_io = thread_stats();
+
+    quantity const q( to_quantity( "3 km" ) );
+    std::string const text( io::to_string( q ) );
+
+    stats_counters const m = thread_stats() - before_io;
+
+    if ( stats_enabled() )
+    {
+        REQUIRE( m.parses == 1 );
+        REQUIRE( m.lookups >= 2 );
+        REQUIRE( m.formats == 1 );
+    }
+    else
+    {
+        REQUIRE( m.parses == 0 );
+        REQUIRE( m.formats == 0 );
+    }
+}
+
+TEST_CASE( "stats/aggregate", "Counters of all threads and reset" )
+{
+    quantity const a( 3 * meter() );
+    bool const same = a == a;
+    REQUIRE( same );
+
+    stats_counters const all = stats();
+    stats_counters const mine = thread_stats();
+
+    REQUIRE( all.dimension_checks >= mine.dimension_checks );
+    REQUIRE( all.allocations >= mine.allocations );
+
+    reset_thread_stats();
+
+    REQUIRE( thread_stats().dimension_checks == 0 );
+    REQUIRE( thread_stats().allocations == 0 );
+
+    REQUIRE( to_string( stats_counters() ) ==
+        "allocations: 0, dimensions: 0, dimension checks: 0, dimension mismatches: 0, parses: 0, lookups: 0, formats: 0" );
+}
+
+/*
+ * end of file
+ */
@@ -0,0 +1,126 @@
+/*
+ * TestTrace.cpp
+ *
+ * Created by Martin on 18 October 2026.
+ * Copyright 2012 Universiteit Leiden. All rights reserved.
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See accompanying
+ * file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "TestUtil.hpp"
+
+#include "catch.hpp"
+#include "phys/units/io.hpp"
+#include "phys/units/quantity.hpp"
+
+#include <vector>
+
+#ifdef PHYS_UNITS_IN_RT_NAMESPACE
+using namespace rt::phys::units;
+#else
+using namespace phys::units;
+#endif
+
+namespace {
+
+struct traced
+{
+    trace_op::type op;
+    std::string text;
+    dimensions lhs;
+    dimensions rhs;
+    bool has_error;
+};
+
+std::vector<traced> & events()
+{
+    static std::vector<traced> v;
+    return v;
+}
+
+void record( trace_event const & e )
+{
+    traced const t = { e.op, e.text, detail::from_raw( e.lhs ), detail::from_raw( e.rhs ), 0 != e.error };
+
+    REQUIRE( e.timestamp > 0 );
+
+    events().push_back( t );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "trace/dimension", "Trace dimension mismatches and thrown errors" )
+{
+    events().clear();
+
+    trace_hook const previous = set_trace_hook( record );
+
+    quantity_result const r( try_add( meter(), second() ) );
+
+    REQUIRE( !r.ok() );
+    REQUIRE( events().size() == 1 );
+    REQUIRE( events()[0].op == trace_op::dimension_mismatch );
+    REQUIRE( events()[0].text == "operator+" );
+    REQUIRE( events()[0].lhs == meter().dimension() );
+    REQUIRE( events()[0].rhs == second().dimension() );
+
+    events().clear();
+
+    REQUIRE_THROWS_AS( meter() + second(), incompatible_dimension_error );
+
+    REQUIRE( events().size() == 2 );
+    REQUIRE( events()[0].op == trace_op::dimension_mismatch );
+    REQUIRE( events()[1].op == trace_op::error );
+    REQUIRE( events()[1].text == "operator+" );
+    REQUIRE( events()[1].has_error );
+    REQUIRE( events()[1].rhs == second().dimension() );
+
+    events().clear();
+
+    REQUIRE_THROWS_AS( to_quantity( "3 m +" ), quantity_parser_error );
+
+    REQUIRE( events().size() == 1 );
+    REQUIRE( events()[0].op == trace_op::error );
+
+    REQUIRE( set_trace_hook( previous ) == record );
+
+    events().clear();
+
+    REQUIRE_THROWS_AS( meter() + second(), incompatible_dimension_error );
+    REQUIRE( events().empty() );
+}
+
+TEST_CASE( "trace/registry", "Trace unit definitions and unit cache misses" )
+{
+    events().clear();
+
+    trace_hook const previous = set_trace_hook( record );
+
+    detail::define_unit_name( newton(), "N" );  // as predefined
+
+    REQUIRE( events().size() == 1 );
+    REQUIRE( events()[0].op == trace_op::define_unit_name );
+    REQUIRE( events()[0].text == "N" );
+    REQUIRE( events()[0].lhs == newton().dimension() );
+
+    events().clear();
+
+    unit_cache cache;
+    cache.find( "km/h" );
+    cache.find( "km/h" );
+    cache.find( "parsec" );
+
+    REQUIRE( events().size() == 2 );
+    REQUIRE( events()[0].op == trace_op::cache_miss );
+    REQUIRE( events()[0].text == "km/h" );
+    REQUIRE( events()[0].lhs == ( meter() / second() ).dimension() );
+    REQUIRE( events()[1].text == "parsec" );
+    REQUIRE( events()[1].lhs == dimensionless_d );
+
+    set_trace_hook( previous );
+}
+
+/*
+ * end of file
+ */
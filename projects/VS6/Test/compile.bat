@@ -40,7 +40,7 @@ goto :EOF
 :COMPILE
 setlocal
 set OPT=%*
-cl -nologo -W3 -EHsc -GR %G_OPT% %OPT% -D_CRT_SECURE_NO_WARNINGS -I../../../ -I%CATCH_INCLUDE% -FeTest.exe ../../Test/Test.cpp ../../Test/TestArithmetic.cpp ../../Test/TestComparison.cpp ../../Test/TestCompile.cpp ../../Test/TestFunction.cpp ../../Test/TestInput.cpp ../../Test/TestOutput.cpp ../../Test/TestPrefix.cpp ../../Test/TestUnit.cpp && Test
+cl -nologo -W3 -EHsc -GR %G_OPT% %OPT% -D_CRT_SECURE_NO_WARNINGS -I../../../ -I%CATCH_INCLUDE% -FeTest.exe ../../Test/Test.cpp ../../Test/TestArithmetic.cpp ../../Test/TestComparison.cpp ../../Test/TestCompile.cpp ../../Test/TestFunction.cpp ../../Test/TestInput.cpp ../../Test/TestOutput.cpp ../../Test/TestPrefix.cpp ../../Test/TestUnit.cpp ../../Test/TestExpression.cpp ../../Test/TestBinary.cpp ../../Test/TestColumnar.cpp ../../Test/TestCsv.cpp ../../Test/TestBulk.cpp ../../Test/TestStats.cpp ../../Test/TestLatency.cpp ../../Test/TestTrace.cpp ../../Test/TestReduce.cpp ../../Test/TestMatrix.cpp ../../Test/TestFormula.cpp && Test
 endlocal & goto :EOF
 
 :CATCH_ERROR
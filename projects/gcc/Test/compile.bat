@@ -40,7 +40,7 @@ goto :EOF
 :COMPILE
 setlocal
 set OPT=%*
-g++ -Wall %G_OPT% %OPT% -I../../../ -I%CATCH_INCLUDE% -o Test.exe ../../Test/Test.cpp ../../Test/TestArithmetic.cpp ../../Test/TestComparison.cpp ../../Test/TestCompile.cpp ../../Test/TestFunction.cpp ../../Test/TestInput.cpp ../../Test/TestOutput.cpp ../../Test/TestPrefix.cpp ../../Test/TestUnit.cpp && Test
+g++ -Wall %G_OPT% %OPT% -I../../../ -I%CATCH_INCLUDE% -o Test.exe ../../Test/Test.cpp ../../Test/TestArithmetic.cpp ../../Test/TestComparison.cpp ../../Test/TestCompile.cpp ../../Test/TestFunction.cpp ../../Test/TestInput.cpp ../../Test/TestOutput.cpp ../../Test/TestPrefix.cpp ../../Test/TestUnit.cpp ../../Test/TestExpression.cpp ../../Test/TestBinary.cpp ../../Test/TestColumnar.cpp ../../Test/TestCsv.cpp ../../Test/TestBulk.cpp ../../Test/TestStats.cpp ../../Test/TestLatency.cpp ../../Test/TestTrace.cpp ../../Test/TestReduce.cpp ../../Test/TestMatrix.cpp ../../Test/TestFormula.cpp && Test
 endlocal & goto :EOF
 
 :CATCH_ERROR